@@ -0,0 +1,95 @@
+#ifndef ACCESSORY_COMPLETION_HPP
+#define ACCESSORY_COMPLETION_HPP
+
+#include <DeviceExecutor.hpp>
+#include <DeviceTask.hpp>
+#include <TimerWheel.hpp>
+#include <coroutine>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @class AccessoryCompletion
+ * @brief Auto-reset signal a DeviceTask awaits until the accessory reports back.
+ *
+ * The device signals it from the accessory report callback, from any task. A signal with no
+ * task waiting is kept and consumed by the next wait, so a report that arrives before the
+ * task suspends is not lost. Only one task may wait at a time.
+ */
+class AccessoryCompletion {
+ public:
+  /**
+   * @class Awaiter
+   * @brief Suspends the task until the signal or the timeout.
+   */
+  class Awaiter {
+   public:
+    Awaiter(AccessoryCompletion &completion, uint32_t timeoutMs);
+
+    /**
+     * @brief Destructor, stops waiting for a cancelled task.
+     */
+    ~Awaiter();
+
+    Awaiter(const Awaiter &) = delete;
+    Awaiter &operator=(const Awaiter &) = delete;
+
+    bool await_ready();
+    bool await_suspend(DeviceTask::Handle handle);
+
+    /**
+     * @return bool true if the accessory signalled, false on timeout.
+     */
+    bool await_resume() const noexcept { return signalled; }
+
+   private:
+    friend class AccessoryCompletion;
+
+    static void onTimeout(void *self);
+
+    /**
+     * @brief Resume the task. Called with the completion mutex held.
+     *
+     * @param isSignalled Whether the accessory signalled.
+     */
+    void wake(bool isSignalled);
+
+    AccessoryCompletion &completion; /**< Awaited signal. */
+    uint32_t timeoutMs;              /**< Timeout, 0 to wait forever. */
+    bool signalled;                  /**< Whether the accessory signalled. */
+    DeviceExecutor *executor;        /**< Executor of the waiting task. */
+    uint32_t taskId;                 /**< Waiting task. */
+    std::coroutine_handle<> handle;  /**< Frame to resume. */
+    TimerWheel::Timer timer;         /**< Timeout timer. */
+  };
+
+  AccessoryCompletion();
+
+  AccessoryCompletion(const AccessoryCompletion &) = delete;
+  AccessoryCompletion &operator=(const AccessoryCompletion &) = delete;
+
+  /**
+   * @brief Signal the waiting task, or keep the signal for the next wait.
+   */
+  void signal();
+
+  /**
+   * @brief Drop a kept signal, so the next wait only returns on a fresh report.
+   */
+  void reset();
+
+  /**
+   * @brief Wait for the signal.
+   *
+   * @param timeoutMs Timeout in milliseconds, 0 to wait forever.
+   * @return Awaiter Awaitable of the signal, resuming with true if signalled.
+   */
+  Awaiter wait(uint32_t timeoutMs = 0) { return Awaiter(*this, timeoutMs); }
+
+ private:
+  std::mutex mutex; /**< Protects the signal and the waiter. */
+  bool pending;     /**< Signal kept for the next wait. */
+  Awaiter *waiter;  /**< Suspended waiter, nullptr if none. */
+};
+
+#endif  // ACCESSORY_COMPLETION_HPP
@@ -2,6 +2,14 @@
 #define BASE_DEVICE_HPP
 
 #include <esp_err.h>
+#include <esp_matter.h>
+
+#include <DeviceSnapshot.hpp>
+#include <HealthProbeInterface.hpp>
+#include <ReportScheduler.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 
 /**
  * @class BaseDevice
@@ -10,15 +18,32 @@
  * The BaseDevice class defines the interface that all device classes must implement.
  * It provides pure virtual methods for updating the accessory state, reporting the
  * endpoint state, and identifying the device.
+ * Every concrete device registers itself in the DeviceRegistry as the last step of its
+ * constructor and unregisters as the first step of its destructor, so registry sweeps never
+ * see a partially built or partially destroyed device.
+ * Devices with a HealthProbeInterface track reachability; while a device is unreachable,
+ * updateAccessory() returns ESP_ERR_INVALID_STATE without touching the accessory.
+ * Accessory changes made on behalf of a Matter write are tagged with a write generation, so
+ * the report callback they trigger can be recognised as an echo and skipped.
  */
 class BaseDevice {
  public:
+  static constexpr size_t kMaxEndpoints = 32; /**< Most endpoints owned by a single device. */
+
+  /**
+   * @brief Constructor for BaseDevice.
+   */
+  BaseDevice();
+
   /**
    * @brief Virtual destructor for BaseDevice.
    *
    * Ensures derived class destructors are called correctly.
    */
-  virtual ~BaseDevice() = default;
+  virtual ~BaseDevice();
+
+  BaseDevice(const BaseDevice &) = delete;
+  BaseDevice &operator=(const BaseDevice &) = delete;
 
   /**
    * @brief Update the accessory state.
@@ -49,6 +74,201 @@ class BaseDevice {
    * @return esp_err_t Error code indicating success or failure.
    */
   virtual esp_err_t identify() = 0;
+
+  /**
+   * @brief Write the cached state of the device into one snapshot row.
+   *
+   * Called by DeviceRegistry::snapshot() after the row has been cleared. Implementations
+   * must only read cached state: no attribute lookups and no stack lock.
+   *
+   * @param snapshot Snapshot buffers to fill.
+   * @param index Row of this device.
+   */
+  virtual void fillSnapshot(DeviceSnapshot &snapshot, size_t index) const;
+
+  /**
+   * @brief Report the endpoint again if reports were deferred for lack of subscribers.
+   *
+   * Called by the SubscriptionTracker when a subscription arrives.
+   */
+  void flushDeferredReports();
+
+  /**
+   * @brief Check whether a report was deferred since the last flush.
+   *
+   * @return bool true if flushDeferredReports() would report the endpoint.
+   */
+  bool isReportDeferred() const;
+
+  /**
+   * @brief Write the endpoint ids owned by the device.
+   *
+   * @param endpointIds Buffer receiving the endpoint ids.
+   * @param capacity Number of ids the buffer can hold.
+   * @return size_t Number of ids written.
+   */
+  virtual size_t getEndpointIds(uint16_t *endpointIds, size_t capacity) const;
+
+  /**
+   * @brief Set the probe used by the HealthSweep to check the accessory.
+   *
+   * Devices without a probe are never probed and always reachable.
+   *
+   * @param probe Health probe, nullptr to disable probing.
+   */
+  void setHealthProbe(HealthProbeInterface *probe);
+
+  /**
+   * @brief Check whether the accessory is considered reachable.
+   *
+   * @return bool false after enough consecutive failed probes.
+   */
+  bool isReachable() const;
+
+  /**
+   * @brief Probe the accessory once and update reachability with hysteresis.
+   *
+   * Called by the HealthSweep with the registry lock held, so nothing is reported here. The
+   * state flips after failThreshold consecutive failures or recoverThreshold consecutive
+   * successes, and the caller reports the flip with reportReachable() once the registry lock
+   * is released.
+   *
+   * @param failThreshold Consecutive failed probes before the device becomes unreachable.
+   * @param recoverThreshold Consecutive successful probes before it becomes reachable again.
+   * @return bool true if the reachability changed.
+   */
+  bool probeHealth(uint8_t failThreshold, uint8_t recoverThreshold);
+
+  /**
+   * @brief Report the current reachability on the bridged endpoints.
+   *
+   * Takes the stack lock, so it must not be called with the registry lock held unless the
+   * stack lock was taken first.
+   */
+  void reportReachable();
+
+  /**
+   * @enum ReportError
+   * @brief Report error counted on the device.
+   */
+  enum class ReportError : uint8_t {
+    Failed,  /**< The stack rejected a report. */
+    Retried, /**< A rejected report was sent again. */
+    Dropped, /**< A rejected report was given up. */
+  };
+
+  /**
+   * @struct ReportErrorStats
+   * @brief Report error counters of the device.
+   */
+  struct ReportErrorStats {
+    uint32_t failed;  /**< Reports the stack rejected. */
+    uint32_t retried; /**< Retries sent by the ReportRetryQueue. */
+    uint32_t dropped; /**< Reports given up after the last retry or because the retry queue was full. */
+  };
+
+  /**
+   * @brief Get the report error counters of the device.
+   *
+   * @return ReportErrorStats Copy of the counters.
+   */
+  ReportErrorStats getReportErrorStats() const;
+
+  /**
+   * @brief Reset the report error counters of the device.
+   */
+  void resetReportErrorStats();
+
+  /**
+   * @brief Count a report error of one of the endpoints of the device.
+   *
+   * Called by the ReportRetryQueue.
+   *
+   * @param error Error to count.
+   */
+  void countReportError(ReportError error);
+
+ protected:
+  /**
+   * @brief Add the device to the DeviceRegistry, called at the end of the concrete constructor.
+   */
+  void registerDevice();
+
+  /**
+   * @brief Remove the device from the DeviceRegistry, called first in the concrete destructor.
+   *
+   * Returns once no registry sweep can reach the device anymore.
+   */
+  void unregisterDevice();
+
+  /**
+   * @brief Report an attribute change through the Matter reporting engine.
+   *
+   * When the SubscriptionTracker knows that nobody subscribed to the endpoint/cluster, only
+   * the attribute store is updated and the device is marked for a flush once a
+   * subscription arrives. Otherwise the report is queued on the given lane of the
+   * ReportScheduler. A pending retry of the attribute is cancelled either way, the new value
+   * supersedes it.
+   *
+   * @param endpointId Endpoint of the attribute.
+   * @param clusterId Cluster of the attribute.
+   * @param attributeId Attribute id.
+   * @param val New attribute value.
+   * @param lane Priority lane of the report.
+   * @return esp_err_t ESP_OK once queued, or the error of the synchronous report or store
+   * update. A rejected report is retried by the ReportRetryQueue.
+   */
+  esp_err_t reportAttribute(uint16_t endpointId, uint32_t clusterId, uint32_t attributeId,
+                            esp_matter_attr_val_t *val, ReportLane lane = ReportLane::State);
+
+  /**
+   * @brief Report several attribute changes under a single stack lock.
+   *
+   * Paths nobody subscribed to only update the attribute store, as in reportAttribute(). The
+   * others are sent together through ReportScheduler::reportAttributes().
+   *
+   * @param reports Reports to make, reordered in place.
+   * @param count Number of reports.
+   * @param lane Priority lane of the reports.
+   * @return esp_err_t The first error of a report or store update.
+   */
+  esp_err_t reportAttributes(ReportScheduler::AttributeReport *reports, size_t count,
+                             ReportLane lane = ReportLane::State);
+
+  /**
+   * @brief Tag the next accessory change as caused by a Matter write.
+   *
+   * Call right before driving the accessory from the endpoint state, after the state shadow
+   * holds the written value. Starts a new write generation.
+   */
+  void markAccessoryWrite();
+
+  /**
+   * @brief Check in the accessory report callback whether the report echoes a Matter write.
+   *
+   * Only the first report after markAccessoryWrite() can be an echo, and only if the
+   * accessory shows the written state, so a physical change racing the write still reports.
+   * The write generation is consumed either way.
+   *
+   * @param matchesWrite Whether the accessory state equals the state shadow.
+   * @return bool true if the report repeats the write and can be skipped.
+   */
+  bool isWriteEcho(bool matchesWrite);
+
+ private:
+  friend class DeviceRegistry;
+
+
+  BaseDevice *nextDevice;                          /**< Next device in the DeviceRegistry list. */
+  std::atomic<bool> hasDeferredReports;            /**< Whether a report was deferred since the flush. */
+  std::atomic<HealthProbeInterface *> healthProbe; /**< Probe of the accessory, nullptr if none. */
+  std::atomic<bool> reachable;                     /**< Whether the accessory is considered reachable. */
+  uint8_t probeStreak;                             /**< Consecutive probes contradicting reachable. */
+  std::atomic<uint32_t> failedReports;             /**< Reports the stack rejected. */
+  std::atomic<uint32_t> retriedReports;            /**< Retries sent. */
+  std::atomic<uint32_t> droppedReports;            /**< Reports given up. */
+  std::atomic<uint32_t> writeGeneration;           /**< Accessory changes made for Matter writes. */
+  std::atomic<uint32_t> echoGeneration;            /**< Write generation seen by the last report callback. */
 };
 
 #endif  // BASE_DEVICE_HPP
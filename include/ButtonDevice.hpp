@@ -6,7 +6,9 @@
 #include <hal/gpio_types.h>
 
 #include <BaseDevice.hpp>
+#include <DeviceName.hpp>
 #include <StatelessButtonAccessoryInterface.hpp>
+#include <atomic>
 #include <cstdint>
 
 /**
@@ -23,7 +25,7 @@ class ButtonDevice : public BaseDevice {
    *
    * This constructor initializes the ButtonDevice with specified parameters.
    *
-   * @param device_name The name of the device.
+   * @param device_name The name of the device, copied unless passed as a BorrowedName.
    * @param button_pin The GPIO pin connected to the button. Default is GPIO_NUM_NC.
    * @param aggregator The endpoint aggregator. Default is nullptr.
    *
@@ -33,13 +35,13 @@ class ButtonDevice : public BaseDevice {
    * If no name is provided, it creates a bridged node endpoint with a default name.
    * If no aggregator is provided, it creates a standalone ButtonDevice.
    */
-  ButtonDevice(const char *device_name = nullptr, StatelessButtonAccessoryInterface *buttonAccessory = nullptr,
+  ButtonDevice(DeviceName device_name = nullptr, StatelessButtonAccessoryInterface *buttonAccessory = nullptr,
                esp_matter::endpoint_t *aggregator = nullptr);
 
   /**
-   * @brief Default destructor for ButtonDevice.
+   * @brief Destructor for ButtonDevice, unregisters the device.
    */
-  ~ButtonDevice() = default;
+  ~ButtonDevice();
 
   /**
    * @brief Update the accessory state.
@@ -66,16 +68,35 @@ class ButtonDevice : public BaseDevice {
    */
   esp_err_t identify() override;
 
+  /**
+   * @brief Write the cached state of the device into one snapshot row.
+   *
+   * @param snapshot Snapshot buffers to fill.
+   * @param index Row of this device.
+   */
+  void fillSnapshot(DeviceSnapshot &snapshot, size_t index) const override;
+
+  /**
+   * @brief Write the endpoint ids owned by the device.
+   *
+   * @param endpointIds Buffer receiving the endpoint ids.
+   * @param capacity Number of ids the buffer can hold.
+   * @return size_t Number of ids written.
+   */
+  size_t getEndpointIds(uint16_t *endpointIds, size_t capacity) const override;
+
  private:
   // bool getAccessoryPowerState();
   // void setAccessoryPowerState(bool powerState);
   // bool getEndpointPowerState();
-  void setEndpointSwitchPressEvent(StatelessButtonAccessoryInterface::PressType pressType);
+  esp_err_t setEndpointSwitchPressEvent(StatelessButtonAccessoryInterface::PressType pressType);
+  static void sendSwitchPressEvent(uint16_t endpointId, uint32_t pressType);
 
   esp_matter::endpoint_t *endpoint; /**< Pointer to the esp_matter endpoint. */
   StatelessButtonAccessoryInterface
       *switchButtonAccessory; /**< Pointer to the SwitchButtonAccessory instance. */
-  char name[64];              /**< Name of the device, TODO: change to a define. */
+  DeviceName name;                      /**< Name of the device, copied or borrowed. */
+  std::atomic<uint8_t> cachedLastPress; /**< Last reported press type, read by snapshots. */
 };
 
 #endif  // BUTTON_DEVICE_HPP
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef DEVICE_CONFIG_HPP
+#define DEVICE_CONFIG_HPP
+
+#include <SensorFilter.hpp>
+#include <cstdint>
+
+/**
+ * @brief Compile-time cluster and feature configuration of every device type.
+ *
+ * The constructors read these tables instead of deciding the features inline, so a feature
+ * that is switched off here costs neither the attributes it would allocate nor its code.
+ * Every attribute of a feature is a heap allocation in esp_matter, see HeapAudit for the
+ * measured cost of each device type.
+ */
+namespace DeviceConfig {
+
+/**
+ * @struct WindowCovering
+ * @brief Window covering features of WindowDevice.
+ */
+struct WindowCovering {
+  bool absolutePosition;             /**< Add the absolute position feature and its limit attributes. */
+  uint8_t initialLiftPercent;        /**< Initial current lift position in percent. */
+  uint16_t initialLiftPercent100ths; /**< Initial current and target lift position in 1/100 %. */
+};
+
+/**
+ * @struct Switch
+ * @brief Switch features of ButtonDevice.
+ */
+struct Switch {
+  bool release;          /**< Add the momentary switch release feature. */
+  bool longPress;        /**< Add the momentary switch long press feature. */
+  bool multiPress;       /**< Add the momentary switch multi press feature. */
+  uint8_t multiPressMax; /**< Maximum number of presses of a multi press. */
+};
+
+/**
+ * @struct PowerMetering
+ * @brief Metering clusters of a PlugInDevice with a power meter.
+ */
+struct PowerMetering {
+  bool powerTopology;    /**< Add the power topology cluster. */
+  bool cumulativeEnergy; /**< Add the cumulative imported energy feature. */
+};
+
+/**
+ * WindowDevice keeps the absolute position feature it always had, controllers may rely on its
+ * installed and physical limit attributes. Set absolutePosition to false to save them.
+ */
+inline constexpr WindowCovering kWindow = {true, 0, 0};
+
+/**
+ * ButtonDevice reports single, double and long presses.
+ */
+inline constexpr Switch kButton = {true, true, true, 2};
+
+/**
+ * PlugInDevice reports active power and cumulative imported energy.
+ */
+inline constexpr PowerMetering kPlugIn = {true, true};
+
+/**
+ * SensorDevice temperature filter in 1/100 degree Celsius: 0.05 degree of noise is ignored and
+ * 0.2 degree is reported, at most every 10 s.
+ */
+inline constexpr SensorFilter::Config kTemperatureFilter = {4, 8, 5, 20, 10000, 300000};
+
+/**
+ * SensorDevice humidity filter in 1/100 percent: 0.2 % of noise is ignored and 1 % is reported,
+ * at most every 10 s.
+ */
+inline constexpr SensorFilter::Config kHumidityFilter = {4, 8, 20, 100, 10000, 300000};
+
+/**
+ * SensorDevice occupancy filter: every change is reported immediately.
+ */
+inline constexpr SensorFilter::Config kOccupancyFilter = {1, 1, 0, 1, 0, 300000};
+
+}  // namespace DeviceConfig
+
+#endif  // DEVICE_CONFIG_HPP
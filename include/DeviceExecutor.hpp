@@ -0,0 +1,226 @@
+#ifndef DEVICE_EXECUTOR_HPP
+#define DEVICE_EXECUTOR_HPP
+
+#include <esp_err.h>
+
+#include <DeviceTask.hpp>
+#include <ReportScheduler.hpp>
+#include <TimerWheel.hpp>
+#include <coroutine>
+#include <cstddef>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+/**
+ * @class DeviceExecutor
+ * @brief Single executor of the DeviceTask coroutines of the device layer, run on a TimerWheel.
+ *
+ * Tasks are only resumed from the wheel context, so a coroutine never runs concurrently with
+ * itself and needs no locking of its own; cancel() destroys the frame before it returns.
+ * Awaitables wake a task from any context with post(); it then resumes on the next wheel
+ * tick, or right away when the wake-up comes from a wheel timer. The task table bounds the
+ * concurrent tasks to kMaxTasks. On the host, construct an executor on a wheel driven by a
+ * HostTickSource, or call runReady() directly, to run tasks deterministically.
+ */
+class DeviceExecutor {
+ public:
+  static constexpr size_t kMaxTasks = DeviceTask::kMaxFrames; /**< Number of concurrent tasks. */
+  static constexpr uint32_t kNoTask = 0;                      /**< Id never given to a task. */
+
+  /**
+   * @class DelayAwaiter
+   * @brief Suspends the task for a duration on the executor wheel.
+   */
+  class DelayAwaiter {
+   public:
+    explicit DelayAwaiter(uint32_t ms);
+
+    /**
+     * @brief Destructor, cancels the timer of a cancelled task and waits for a running expiry.
+     */
+    ~DelayAwaiter();
+
+    DelayAwaiter(const DelayAwaiter &) = delete;
+    DelayAwaiter &operator=(const DelayAwaiter &) = delete;
+
+    bool await_ready() const noexcept { return ms == 0; }
+    void await_suspend(DeviceTask::Handle handle);
+    void await_resume() const noexcept {}
+
+   private:
+    static void onTimer(void *self);
+
+    uint32_t ms;                    /**< Duration of the delay. */
+    DeviceExecutor *executor;       /**< Executor of the waiting task. */
+    uint32_t taskId;                /**< Waiting task. */
+    std::coroutine_handle<> handle; /**< Frame to resume. */
+    TimerWheel::Timer timer;        /**< Delay timer. */
+  };
+
+  /**
+   * @class FlushAwaiter
+   * @brief Suspends the task until every report queued so far has been sent.
+   */
+  class FlushAwaiter {
+   public:
+    FlushAwaiter();
+
+    /**
+     * @brief Destructor, stops waiting for a cancelled task.
+     */
+    ~FlushAwaiter();
+
+    FlushAwaiter(const FlushAwaiter &) = delete;
+    FlushAwaiter &operator=(const FlushAwaiter &) = delete;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(DeviceTask::Handle handle);
+    void await_resume() const noexcept {}
+
+   private:
+    static void onFlushed(void *self);
+
+    DeviceExecutor *executor;            /**< Executor of the waiting task. */
+    uint32_t taskId;                     /**< Waiting task. */
+    std::coroutine_handle<> handle;      /**< Frame to resume. */
+    ReportScheduler::FlushWaiter waiter; /**< Registration with the ReportScheduler. */
+  };
+
+  /**
+   * @brief Constructor for DeviceExecutor.
+   *
+   * @param wheel Wheel the tasks run on. Default is the device wheel.
+   */
+  explicit DeviceExecutor(TimerWheel &wheel = TimerWheel::device());
+
+  /**
+   * @brief Destructor for DeviceExecutor, destroys the remaining tasks without resuming them.
+   */
+  ~DeviceExecutor();
+
+  DeviceExecutor(const DeviceExecutor &) = delete;
+  DeviceExecutor &operator=(const DeviceExecutor &) = delete;
+
+  /**
+   * @brief Get the executor shared by the device layer, running on the device wheel.
+   *
+   * @return DeviceExecutor& The executor instance.
+   */
+  static DeviceExecutor &device();
+
+  /**
+   * @brief Start a task. It first runs on the next wheel tick.
+   *
+   * @param task Task to start, consumed.
+   * @param taskId Receives the id of the task, kNoTask on failure. May be nullptr.
+   * @return esp_err_t ESP_ERR_NO_MEM if the frame could not be allocated or the task table is
+   * full.
+   */
+  esp_err_t spawn(DeviceTask task, uint32_t *taskId = nullptr);
+
+  /**
+   * @brief Cancel a task.
+   *
+   * The task is destroyed without being resumed again, which runs the destructors of its
+   * locals and awaiters, so its owner may be destroyed once this returns. A suspended task is
+   * destroyed on the calling task; a task being resumed on another task is waited for. A task
+   * cancelling itself is destroyed as soon as it suspends. Unknown or finished ids are ignored.
+   *
+   * @param taskId Id returned by spawn().
+   */
+  void cancel(uint32_t taskId);
+
+  /**
+   * @brief Check whether a task has neither finished nor been destroyed.
+   *
+   * @param taskId Id returned by spawn().
+   * @return bool true while the task exists.
+   */
+  bool isActive(uint32_t taskId);
+
+  /**
+   * @brief Get the number of tasks.
+   *
+   * @return size_t Number of tasks that have neither finished nor been destroyed.
+   */
+  size_t activeTasks();
+
+  /**
+   * @brief Wake a suspended task from any task.
+   *
+   * Used by awaitables. Wake-ups of unknown ids are ignored.
+   *
+   * @param taskId Task to wake.
+   * @param handle Frame to resume, the innermost awaiting frame of the task.
+   */
+  void post(uint32_t taskId, std::coroutine_handle<> handle);
+
+  /**
+   * @brief Resume every task that was woken on the calling task, destroying the finished ones.
+   *
+   * Used by the executor timer, and directly on the host to run the tasks deterministically.
+   *
+   * @return size_t Number of tasks resumed.
+   */
+  size_t runReady();
+
+  /**
+   * @brief Get the wheel the tasks run on.
+   *
+   * @return TimerWheel& The wheel.
+   */
+  TimerWheel &getWheel();
+
+  /**
+   * @brief Suspend the calling task.
+   *
+   * @param ms Duration in milliseconds, rounded up to wheel ticks. 0 does not suspend.
+   * @return DelayAwaiter Awaitable of the delay.
+   */
+  static DelayAwaiter delay(uint32_t ms) { return DelayAwaiter(ms); }
+
+  /**
+   * @brief Suspend the calling task until the ReportScheduler sent every report queued so far.
+   *
+   * Does not suspend when nothing is queued.
+   *
+   * @return FlushAwaiter Awaitable of the flush.
+   */
+  static FlushAwaiter reportsFlushed() { return FlushAwaiter(); }
+
+ private:
+  struct Slot {
+    DeviceTask::Handle root;        /**< Frame of the spawned task, empty when the slot is free. */
+    std::coroutine_handle<> resume; /**< Frame to resume on the next run. */
+    uint32_t id;                    /**< Task id, kNoTask when the slot is free. */
+    bool ready;                     /**< Whether the task was woken. */
+    bool cancelled;                 /**< Whether the task must be destroyed once it suspends. */
+    bool running;                   /**< Whether the task is being resumed or destroyed. */
+    std::thread::id runner;         /**< Task resuming the frame while running. */
+  };
+
+  /**
+   * @brief Schedule the run timer on the next tick. Called with the mutex held.
+   */
+  void arm();
+
+  Slot *find(uint32_t taskId);
+
+  /**
+   * @brief Free the slot of a destroyed task and wake the cancellers. Called with the mutex held.
+   *
+   * @param slot Slot of the task.
+   */
+  void release(Slot &slot);
+
+  TimerWheel &wheel;            /**< Wheel the tasks run on. */
+  std::mutex mutex;             /**< Protects the slots. */
+  std::condition_variable idle; /**< Signalled when a task is released. */
+  Slot slots[kMaxTasks];        /**< Task table. */
+  uint32_t nextId;              /**< Id of the next spawned task. */
+  TimerWheel::Timer runTimer;   /**< One-shot timer running the woken tasks. */
+};
+
+#endif  // DEVICE_EXECUTOR_HPP
@@ -0,0 +1,167 @@
+#ifndef DEVICE_MANIFEST_HPP
+#define DEVICE_MANIFEST_HPP
+
+#include <esp_err.h>
+#include <esp_matter.h>
+#include <esp_partition.h>
+
+#include <BaseDevice.hpp>
+#include <DeviceSnapshot.hpp>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @struct DeviceManifestHeader
+ * @brief Header at offset 0 of a device manifest blob. All fields are little endian.
+ */
+struct DeviceManifestHeader {
+  uint32_t magic;         /**< DeviceManifest::kMagic. */
+  uint16_t version;       /**< DeviceManifest::kVersion. */
+  uint16_t deviceCount;   /**< Number of entries. */
+  uint32_t entriesOffset; /**< Offset of the entry table, 4-byte aligned. */
+  uint32_t stringsOffset; /**< Offset of the string table. */
+  uint32_t stringsSize;   /**< Size of the string table, whose last byte is NUL. */
+  uint32_t totalSize;     /**< Size of the whole blob. */
+};
+
+/**
+ * @struct DeviceManifestEntry
+ * @brief One device of a device manifest.
+ */
+struct DeviceManifestEntry {
+  uint8_t type;         /**< DeviceType of the device. */
+  uint8_t flags;        /**< DeviceManifest::kFlag* bits. */
+  uint16_t accessoryId; /**< Application-defined accessory id, passed to the resolver. */
+  uint32_t nameOffset;  /**< Offset of the name in the string table, DeviceManifest::kNoName if none. */
+  uint32_t option;      /**< Type-specific option, the ChannelType of a MultiChannel device. */
+};
+
+static_assert(sizeof(DeviceManifestHeader) == 24, "DeviceManifestHeader layout changed");
+static_assert(sizeof(DeviceManifestEntry) == 12, "DeviceManifestEntry layout changed");
+
+/**
+ * @class DeviceManifest
+ * @brief Versioned binary description of the devices of a bridge, and the loader that
+ * instantiates them.
+ *
+ * The blob is used in place: entries are read straight from it and the devices borrow their
+ * names from its string table (see BorrowedName), so the blob must stay mapped for as long as
+ * the devices live. Devices created in code keep copying their name. Validation
+ * only checks the header and the entry table, so it does not depend on the string sizes.
+ * Blobs are produced from JSON by tools/make_device_manifest.py.
+ */
+class DeviceManifest {
+ public:
+  static constexpr uint32_t kMagic = 0x4D44484D;  /**< "MHDM" in little endian. */
+  static constexpr uint16_t kVersion = 1;         /**< Supported format version. */
+  static constexpr uint32_t kNoName = 0xFFFFFFFF; /**< nameOffset of a device without a name. */
+  static constexpr uint8_t kFlagBridged = 0x01;   /**< Create the device under the aggregator. */
+
+  /**
+   * @brief Resolve the accessory of a manifest entry.
+   *
+   * Must return a pointer to the accessory interface of the type: LightAccessoryInterface for
+   * Light, PluginAccessoryInterface for PlugIn, FanAccessoryInterface for Fan,
+   * BlindAccessoryInterface for Window, StatelessButtonAccessoryInterface for Button,
+   * DimmableLightAccessoryInterface for DimmableLight, MultiChannelAccessoryInterface for
+   * MultiChannel and SensorAccessoryInterface for the sensor types.
+   *
+   * @param context Context passed to instantiate().
+   * @param type Device type of the entry.
+   * @param accessoryId Accessory id of the entry.
+   * @return void* The accessory, nullptr to skip the entry.
+   */
+  typedef void *(*AccessoryResolver)(void *context, DeviceType type, uint16_t accessoryId);
+
+  /**
+   * @brief Constructor for DeviceManifest.
+   */
+  DeviceManifest();
+
+  /**
+   * @brief Destructor for DeviceManifest, unmaps or frees the blob.
+   *
+   * Devices instantiated from the manifest must be destroyed first.
+   */
+  ~DeviceManifest();
+
+  DeviceManifest(const DeviceManifest &) = delete;
+  DeviceManifest &operator=(const DeviceManifest &) = delete;
+
+  /**
+   * @brief Use a blob that is already in memory.
+   *
+   * @param blob Start of the blob, 4-byte aligned. Not copied.
+   * @param size Size of the blob.
+   * @return esp_err_t ESP_ERR_INVALID_VERSION or ESP_ERR_INVALID_SIZE if the blob is malformed.
+   */
+  esp_err_t parse(const void *blob, size_t size);
+
+  /**
+   * @brief Memory-map the blob from a data partition and parse it.
+   *
+   * @param label Label of the partition.
+   * @return esp_err_t ESP_ERR_NOT_FOUND if there is no such partition, or the parse error.
+   */
+  esp_err_t mapPartition(const char *label);
+
+  /**
+   * @brief Read the blob from a file and parse it, e.g. on the host.
+   *
+   * @param path Path of the file.
+   * @return esp_err_t ESP_ERR_NOT_FOUND if the file cannot be read, or the parse error.
+   */
+  esp_err_t loadFile(const char *path);
+
+  /**
+   * @brief Get the number of devices in the manifest.
+   *
+   * @return uint16_t Number of entries.
+   */
+  uint16_t deviceCount() const;
+
+  /**
+   * @brief Get one entry of the manifest.
+   *
+   * @param index Entry index.
+   * @return const DeviceManifestEntry* The entry, nullptr if out of range.
+   */
+  const DeviceManifestEntry *entry(uint16_t index) const;
+
+  /**
+   * @brief Get the name of an entry, pointing into the blob.
+   *
+   * @param index Entry index.
+   * @return const char* The name, nullptr if the entry has none.
+   */
+  const char *name(uint16_t index) const;
+
+  /**
+   * @brief Create every device of the manifest.
+   *
+   * The devices reference their names in the blob instead of copying them.
+   *
+   * @param resolver Resolver of the accessories.
+   * @param context Context passed to the resolver.
+   * @param aggregator Aggregator of the bridged entries, nullptr creates them standalone.
+   * @param devices Array receiving the created devices, owned by the caller.
+   * @param capacity Size of the devices array.
+   * @return size_t Number of devices created.
+   */
+  size_t instantiate(AccessoryResolver resolver, void *context, esp_matter::endpoint_t *aggregator,
+                     BaseDevice **devices, size_t capacity) const;
+
+ private:
+  esp_err_t validate(const void *data, size_t size);
+  void release();
+
+  const uint8_t *blob;                   /**< Start of the parsed blob, nullptr if none. */
+  const DeviceManifestHeader *header;    /**< Header of the blob. */
+  const DeviceManifestEntry *entries;    /**< Entry table of the blob. */
+  const char *strings;                   /**< String table of the blob. */
+  esp_partition_mmap_handle_t mapHandle; /**< Partition mmap handle, valid if mapped. */
+  bool mapped;                           /**< Whether the blob is a mapped partition. */
+  uint8_t *fileBuffer;                   /**< Buffer owned by loadFile(), nullptr if none. */
+};
+
+#endif  // DEVICE_MANIFEST_HPP
@@ -0,0 +1,85 @@
+#ifndef DEVICE_NAME_HPP
+#define DEVICE_NAME_HPP
+
+#include <cstddef>
+
+/**
+ * @struct BorrowedName
+ * @brief Device name that the device references in place instead of copying.
+ *
+ * The string must outlive the device, e.g. a name in the string table of a mapped
+ * DeviceManifest blob.
+ */
+struct BorrowedName {
+  const char *text; /**< Name, not copied. */
+};
+
+/**
+ * @class DeviceName
+ * @brief Name of a device, copied by default or borrowed on request.
+ *
+ * Built implicitly from a C string, the name is copied to the heap with its exact length, so
+ * callers may pass a temporary buffer. Built from a BorrowedName, the string is referenced in
+ * place and costs nothing. Names that are empty or longer than kMaxLength are ignored, as the
+ * device constructors always did.
+ */
+class DeviceName {
+ public:
+  static constexpr size_t kMaxLength = 63; /**< Longest name kept, the size of a node label. */
+
+  /**
+   * @brief Copy a name.
+   *
+   * @param name Name to copy, nullptr for no name.
+   */
+  DeviceName(const char *name = nullptr);
+
+  /**
+   * @brief Reference a name in place.
+   *
+   * @param name Name to reference, must outlive the DeviceName.
+   */
+  DeviceName(BorrowedName name);
+
+  /**
+   * @brief Take over the name of another DeviceName, which is left empty.
+   *
+   * @param other Name to move.
+   */
+  DeviceName(DeviceName &&other);
+
+  /**
+   * @brief Destructor for DeviceName, frees a copied name.
+   */
+  ~DeviceName();
+
+  DeviceName(const DeviceName &) = delete;
+  DeviceName &operator=(const DeviceName &) = delete;
+
+  /**
+   * @brief Get the name.
+   *
+   * @return const char* The name, an empty string if there is none.
+   */
+  const char *get() const;
+
+  /**
+   * @brief Get the length of the name.
+   *
+   * @return size_t Number of characters, 0 if there is no name.
+   */
+  size_t length() const;
+
+  /**
+   * @brief Check whether the name is referenced in place.
+   *
+   * @return bool true if built from a BorrowedName.
+   */
+  bool isBorrowed() const;
+
+ private:
+  const char *text; /**< Name, "" if there is none. */
+  bool owned;       /**< Whether text was copied and must be freed. */
+};
+
+#endif  // DEVICE_NAME_HPP
@@ -0,0 +1,86 @@
+#ifndef DEVICE_REGISTRY_HPP
+#define DEVICE_REGISTRY_HPP
+
+#include <BaseDevice.hpp>
+#include <DeviceSnapshot.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @class DeviceRegistry
+ * @brief Intrusive list of every live BaseDevice.
+ *
+ * Concrete devices register themselves once fully constructed and unregister before their
+ * teardown starts, so the registry never allocates and sweeps only see complete devices.
+ * Appending is O(1) through a tail pointer. The list lock is taken once per sweep,
+ * never per device, and the CHIP stack lock is not taken at all. The lock is recursive: a
+ * callback that reports an attribute may end up in forEndpoint() when the report fails.
+ */
+class DeviceRegistry {
+ public:
+  /**
+   * @brief Fill the snapshot buffers with the cached state of every device in one pass.
+   *
+   * @param snapshot Caller-provided column buffers.
+   * @return size_t Number of rows written (at most snapshot.capacity).
+   */
+  static size_t snapshot(DeviceSnapshot &snapshot);
+
+  /**
+   * @brief Get the number of registered devices.
+   *
+   * @return size_t Number of devices.
+   */
+  static size_t count();
+
+  /**
+   * @brief Call a function for every registered device while holding the list lock.
+   *
+   * @param callback Function called with each device and the user context.
+   * @param context User context passed to the callback.
+   */
+  static void forEach(void (*callback)(BaseDevice *device, void *context), void *context);
+
+  /**
+   * @brief Call a function for the next devices in round-robin order while holding the list lock.
+   *
+   * A shared cursor continues where the previous call stopped, so a caller visiting a fixed
+   * number of devices per call covers the whole list at a flat cost per call.
+   *
+   * @param maxDevices Maximum number of devices to visit, never more than the list size.
+   * @param callback Function called with each device and the user context.
+   * @param context User context passed to the callback.
+   * @return size_t Number of devices visited.
+   */
+  static size_t forNext(size_t maxDevices, void (*callback)(BaseDevice *device, void *context),
+                        void *context);
+
+  /**
+   * @brief Call a function for the device that owns an endpoint while holding the list lock.
+   *
+   * Walks every device and its endpoint ids, meant for rare events such as report errors.
+   *
+   * @param endpointId Endpoint to look up.
+   * @param callback Function called with the owning device and the user context.
+   * @param context User context passed to the callback.
+   * @return bool true if a device owns the endpoint.
+   */
+  static bool forEndpoint(uint16_t endpointId, void (*callback)(BaseDevice *device, void *context),
+                          void *context);
+
+ private:
+  friend class BaseDevice;
+
+  static void add(BaseDevice *device);
+  static void remove(BaseDevice *device);
+
+  static std::recursive_mutex &listMutex();
+
+  static BaseDevice *head;   /**< First device of the intrusive list. */
+  static BaseDevice *tail;   /**< Last device of the intrusive list. */
+  static size_t size;        /**< Number of devices in the list. */
+  static BaseDevice *cursor; /**< Next device visited by forNext(), nullptr to restart at head. */
+};
+
+#endif  // DEVICE_REGISTRY_HPP
@@ -0,0 +1,65 @@
+#ifndef DEVICE_SNAPSHOT_HPP
+#define DEVICE_SNAPSHOT_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @enum DeviceType
+ * @brief Type tag stored in a DeviceSnapshot for every device.
+ */
+enum class DeviceType : uint8_t {
+  Unknown = 0,       /**< Device type that does not publish snapshot state. */
+  Light,             /**< LightDevice. */
+  PlugIn,            /**< PlugInDevice. */
+  Fan,               /**< FanDevice. */
+  Window,            /**< WindowDevice. */
+  Button,            /**< ButtonDevice. */
+  DimmableLight,     /**< DimmableLightDevice. */
+  MultiChannel,      /**< MultiChannelDevice, one row for all channels. */
+  TemperatureSensor, /**< SensorDevice measuring temperature. */
+  HumiditySensor,    /**< SensorDevice measuring relative humidity. */
+  OccupancySensor,   /**< SensorDevice sensing occupancy. */
+};
+
+/**
+ * @struct DeviceSnapshot
+ * @brief Caller-provided structure-of-arrays buffers filled by DeviceRegistry::snapshot().
+ *
+ * Every column is indexed by the device row. Columns that are not needed may be left
+ * as nullptr and are skipped. Columns that do not apply to a device type are written as 0
+ * (or kNoPress for buttonLastPress).
+ */
+struct DeviceSnapshot {
+  static constexpr uint8_t kNoPress = 0xFF; /**< buttonLastPress value when no press was seen. */
+
+  uint16_t *endpointIds = nullptr;           /**< Endpoint id per row. */
+  DeviceType *types = nullptr;               /**< Device type tag per row. */
+  uint8_t *powerBits = nullptr;              /**< Power bitset, row i is bit (i % 8) of byte (i / 8). */
+  uint8_t *fanPercent = nullptr;             /**< Fan percent current per row. */
+  uint16_t *windowCurrentPosition = nullptr; /**< Window current position (0-100) per row. */
+  uint16_t *windowTargetPosition = nullptr;  /**< Window target position (0-100) per row. */
+  uint8_t *buttonLastPress = nullptr;        /**< Last StatelessButtonAccessoryInterface::PressType per row. */
+  uint8_t *lightLevel = nullptr;             /**< Dimmable light level per row. */
+  uint32_t *channelMask = nullptr;           /**< Multi-channel power mask per row. */
+  int32_t *sensorValue = nullptr;            /**< Filtered sensor value per row, in the attribute unit. */
+  size_t capacity = 0;                       /**< Number of rows every non-null column can hold. */
+
+  /**
+   * @brief Set or clear the power bit of a row.
+   *
+   * @param index Row index.
+   * @param powerState Power state to store.
+   */
+  void setPower(size_t index, bool powerState) {
+    if (powerBits == nullptr) return;
+    uint8_t mask = static_cast<uint8_t>(1u << (index % 8));
+    if (powerState) {
+      powerBits[index / 8] |= mask;
+    } else {
+      powerBits[index / 8] &= static_cast<uint8_t>(~mask);
+    }
+  }
+};
+
+#endif  // DEVICE_SNAPSHOT_HPP
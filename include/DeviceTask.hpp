@@ -0,0 +1,128 @@
+#ifndef DEVICE_TASK_HPP
+#define DEVICE_TASK_HPP
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+
+class DeviceExecutor;
+
+/**
+ * @class DeviceTask
+ * @brief Coroutine type of the asynchronous device actions run by the DeviceExecutor.
+ *
+ * A function returning DeviceTask is a coroutine that starts suspended. It runs once it is
+ * handed to DeviceExecutor::spawn(), or when another DeviceTask awaits it, in which case it
+ * runs as part of the awaiting task and resumes it on return. Frames come from a fixed pool
+ * of kMaxFrames slots of kFrameSize bytes, so a sequence costs a frame instead of a task
+ * stack. When the pool is exhausted, or a frame does not fit a slot, the coroutine returns
+ * an invalid task. Exceptions are not supported, an escaping exception aborts.
+ */
+class DeviceTask {
+ public:
+  static constexpr size_t kMaxFrames = 16;  /**< Number of frames in the pool. */
+  static constexpr size_t kFrameSize = 512; /**< Size of a frame slot in bytes. */
+
+  struct promise_type;
+  typedef std::coroutine_handle<promise_type> Handle;
+
+  /**
+   * @struct FinalAwaiter
+   * @brief Resumes the awaiting task when an awaited task returns.
+   */
+  struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(Handle handle) noexcept;
+    void await_resume() const noexcept {}
+  };
+
+  /**
+   * @struct promise_type
+   * @brief Coroutine promise, holds the executor bookkeeping of the frame.
+   */
+  struct promise_type {
+    DeviceExecutor *executor;             /**< Executor running the task, set when it starts. */
+    uint32_t taskId;                      /**< Id of the spawned task this frame runs in. */
+    std::coroutine_handle<> continuation; /**< Awaiting task, empty for a spawned task. */
+
+    promise_type() : executor(nullptr), taskId(0), continuation() {}
+
+    static void *operator new(size_t size) noexcept;
+    static void operator delete(void *frame) noexcept;
+    static DeviceTask get_return_object_on_allocation_failure() noexcept { return DeviceTask(); }
+
+    DeviceTask get_return_object() noexcept { return DeviceTask(Handle::from_promise(*this)); }
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    void unhandled_exception() const noexcept;
+  };
+
+  /**
+   * @struct Awaiter
+   * @brief Runs an awaited task inside the awaiting one.
+   */
+  struct Awaiter {
+    Handle handle; /**< Frame of the awaited task. */
+
+    bool await_ready() const noexcept { return !handle; }
+    std::coroutine_handle<> await_suspend(Handle awaiting) noexcept;
+
+    /**
+     * @return bool false if the awaited task could not be allocated and did not run.
+     */
+    bool await_resume() const noexcept { return static_cast<bool>(handle); }
+  };
+
+  /**
+   * @brief Constructor for an invalid DeviceTask.
+   */
+  DeviceTask() : handle() {}
+
+  /**
+   * @brief Destructor for DeviceTask, destroys a frame that was not spawned.
+   */
+  ~DeviceTask();
+
+  DeviceTask(DeviceTask &&other) noexcept;
+  DeviceTask &operator=(DeviceTask &&other) noexcept;
+  DeviceTask(const DeviceTask &) = delete;
+  DeviceTask &operator=(const DeviceTask &) = delete;
+
+  /**
+   * @brief Check whether the coroutine frame could be allocated.
+   *
+   * @return bool false if the frame pool was exhausted.
+   */
+  bool isValid() const;
+
+  /**
+   * @brief Run the task inside the awaiting task.
+   *
+   * @return Awaiter Awaiter of the task.
+   */
+  Awaiter operator co_await() const noexcept { return Awaiter{handle}; }
+
+  /**
+   * @brief Get the number of frames in use.
+   *
+   * @return size_t Number of allocated frames.
+   */
+  static size_t framesInUse();
+
+ private:
+  friend class DeviceExecutor;
+
+  explicit DeviceTask(Handle handle) : handle(handle) {}
+
+  /**
+   * @brief Hand the frame over to the caller.
+   *
+   * @return Handle Frame of the task, now owned by the caller.
+   */
+  Handle release();
+
+  Handle handle; /**< Frame of the task, owned until spawned. */
+};
+
+#endif  // DEVICE_TASK_HPP
@@ -0,0 +1,33 @@
+#ifndef DIMMABLE_LIGHT_ACCESSORY_INTERFACE_HPP
+#define DIMMABLE_LIGHT_ACCESSORY_INTERFACE_HPP
+
+#include <LightAccessoryInterface.hpp>
+#include <cstdint>
+
+/**
+ * @class DimmableLightAccessoryInterface
+ * @brief Interface for a light accessory that also supports a brightness level.
+ */
+class DimmableLightAccessoryInterface : public LightAccessoryInterface {
+ public:
+  /**
+   * @brief Virtual destructor for DimmableLightAccessoryInterface.
+   */
+  virtual ~DimmableLightAccessoryInterface() = default;
+
+  /**
+   * @brief Set the brightness level of the light.
+   *
+   * @param level Level to set (1-254, as the Matter CurrentLevel attribute).
+   */
+  virtual void setLevel(uint8_t level) = 0;
+
+  /**
+   * @brief Get the brightness level of the light.
+   *
+   * @return uint8_t Current level.
+   */
+  virtual uint8_t getLevel() = 0;
+};
+
+#endif  // DIMMABLE_LIGHT_ACCESSORY_INTERFACE_HPP
@@ -0,0 +1,150 @@
+#ifndef DIMMABLE_LIGHT_DEVICE_HPP
+#define DIMMABLE_LIGHT_DEVICE_HPP
+
+#include <esp_err.h>
+#include <esp_matter.h>
+
+#include <BaseDevice.hpp>
+#include <DeviceName.hpp>
+#include <DimmableLightAccessoryInterface.hpp>
+#include <SeqLock.hpp>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @class DimmableLightDevice
+ * @brief This class represents a Dimmable Light Device, inheriting from the BaseDevice class.
+ *
+ * The DimmableLightDevice registers a dimmable_light endpoint (OnOff and Level Control).
+ * The Level Control server owns the transition of a command and CurrentLevel: it steps the
+ * attribute over the command's TransitionTime and rate-limits its reports. The device follows
+ * those steps, fading the accessory between two steps of a transition with the shared
+ * FadeEngine, and never reports CurrentLevel while a transition runs.
+ */
+class DimmableLightDevice : public BaseDevice {
+ public:
+  /**
+   * @struct State
+   * @brief Endpoint state mirrored in the state shadow.
+   */
+  struct State {
+    bool powerState;     /**< Power state of the endpoint. */
+    uint8_t level;       /**< Level currently output by the accessory, moves during a fade. */
+    uint8_t targetLevel; /**< CurrentLevel last written by the stack. */
+  };
+
+  /**
+   * @brief Constructor for DimmableLightDevice.
+   *
+   * @param device_name The name of the device, copied unless passed as a BorrowedName.
+   * @param lightAccessory The dimmable light accessory. Default is nullptr.
+   * @param aggregator The endpoint aggregator. Default is nullptr.
+   *
+   * @details If an aggregator is provided, it creates a bridged node endpoint with the specified name.
+   * If no name is provided, it creates a bridged node endpoint with a default name.
+   * If no aggregator is provided, it creates a standalone DimmableLightDevice.
+   */
+  DimmableLightDevice(DeviceName device_name = nullptr, DimmableLightAccessoryInterface *lightAccessory = nullptr,
+                      esp_matter::endpoint_t *aggregator = nullptr);
+
+  /**
+   * @brief Destructor for DimmableLightDevice, cancels a running fade.
+   */
+  ~DimmableLightDevice();
+
+  /**
+   * @brief Update the accessory state.
+   *
+   * Switches the light and brings it to the endpoint's CurrentLevel, faded over the interval
+   * since the previous step when the Level Control server is stepping a transition.
+   *
+   * @return esp_err_t Error code indicating success or failure.
+   */
+  esp_err_t updateAccessory() override;
+
+  /**
+   * @brief Report the endpoint state.
+   *
+   * This method reports the current power state and level of the accessory.
+   *
+   * @return esp_err_t Error code indicating success or failure.
+   */
+  esp_err_t reportEndpoint() override;
+
+  /**
+   * @brief Identify the DimmableLightDevice.
+   *
+   * @return esp_err_t Error code indicating success or failure.
+   */
+  esp_err_t identify() override;
+
+  /**
+   * @brief Write the cached state of the device into one snapshot row.
+   *
+   * @param snapshot Snapshot buffers to fill.
+   * @param index Row of this device.
+   */
+  void fillSnapshot(DeviceSnapshot &snapshot, size_t index) const override;
+
+  /**
+   * @brief Write the endpoint ids owned by the device.
+   *
+   * @param endpointIds Buffer receiving the endpoint ids.
+   * @param capacity Number of ids the buffer can hold.
+   * @return size_t Number of ids written.
+   */
+  size_t getEndpointIds(uint16_t *endpointIds, size_t capacity) const override;
+
+  /**
+   * @brief Read the endpoint state from any task without the stack lock.
+   *
+   * @return State Consistent copy of the state shadow.
+   */
+  State getState() const;
+
+ private:
+  /**
+   * @brief Report callback of the accessory.
+   *
+   * Reports the endpoint unless the change only echoes a Matter write or a fade step, and
+   * only the power state while the stack is stepping a transition.
+   */
+  void onAccessoryReport();
+
+  void setAccessoryPowerState(bool powerState);
+  void setAccessoryLevel(uint8_t level);
+  bool getEndpointPowerState();
+  uint8_t getEndpointLevel();
+  uint16_t getEndpointRemainingTime();
+  esp_err_t setEndpointPowerState(bool powerState);
+  esp_err_t setEndpointLevel(uint8_t level);
+
+  /**
+   * @brief Apply one fade step to the accessory.
+   *
+   * @param level Level of this step.
+   * @param finished true on the last step of the fade.
+   */
+  void onFadeStep(uint8_t level, bool finished);
+
+  /**
+   * @brief Load power state and target level from the attribute store into the state shadow.
+   *
+   * Only called from the constructor and updateAccessory(), which run in the stack context.
+   *
+   * @return esp_err_t ESP_ERR_NOT_FOUND if an attribute does not exist, or the error of a read.
+   */
+  esp_err_t loadShadow();
+
+  void cachePowerState(bool powerState);
+  void cacheLevel(uint8_t level);
+
+  esp_matter::endpoint_t *endpoint;                /**< Pointer to the esp_matter endpoint. */
+  DimmableLightAccessoryInterface *lightAccessory; /**< Pointer to the dimmable light accessory. */
+  DeviceName name;                                 /**< Name of the device, copied or borrowed. */
+  SeqLock<State> shadow;                           /**< Endpoint state readable from any task. */
+  std::atomic<bool> transitioning;                 /**< Whether the stack is stepping a transition. */
+  uint32_t lastStackStepMs;                        /**< Wheel time of the last CurrentLevel step of the stack. */
+};
+
+#endif  // DIMMABLE_LIGHT_DEVICE_HPP
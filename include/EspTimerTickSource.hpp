@@ -0,0 +1,63 @@
+#ifndef ESP_TIMER_TICK_SOURCE_HPP
+#define ESP_TIMER_TICK_SOURCE_HPP
+
+#include <esp_err.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <TickSource.hpp>
+#include <TimerWheel.hpp>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @class EspTimerTickSource
+ * @brief Tick source backed by a single periodic esp_timer and a dedicated device task.
+ *
+ * The esp_timer callback only notifies the device task, which advances the wheel, so wheel
+ * callbacks never run on the esp_timer task and cannot delay the other esp_timer users. The
+ * wheel is advanced by the elapsed time measured with esp_timer_get_time(), so a late
+ * notification catches up instead of drifting.
+ */
+class EspTimerTickSource : public TickSource {
+ public:
+  static constexpr uint32_t kDefaultStackSize = 4096; /**< Default stack of the device task in bytes. */
+  static constexpr UBaseType_t kDefaultPriority = 5;  /**< Default priority of the device task. */
+
+  /**
+   * @brief Constructor for EspTimerTickSource.
+   *
+   * @param wheel Wheel to drive. Default is the device wheel.
+   * @param stackSize Stack of the device task in bytes, it runs every wheel callback.
+   * @param priority Priority of the device task.
+   */
+  explicit EspTimerTickSource(TimerWheel &wheel = TimerWheel::device(), uint32_t stackSize = kDefaultStackSize,
+                              UBaseType_t priority = kDefaultPriority);
+
+  /**
+   * @brief Destructor for EspTimerTickSource, stops the timer and ends the device task.
+   */
+  ~EspTimerTickSource();
+
+  esp_err_t start() override;
+  void stop() override;
+
+ private:
+  /**
+   * @brief Body of the device task: advance the wheel on every notification.
+   */
+  void run();
+
+  TimerWheel &wheel;           /**< Driven wheel. */
+  uint32_t stackSize;          /**< Stack of the device task in bytes. */
+  UBaseType_t priority;        /**< Priority of the device task. */
+  esp_timer_handle_t timer;    /**< Periodic esp_timer, created by start(). */
+  TaskHandle_t task;           /**< Device task, created by start(). */
+  std::atomic<bool> exiting;   /**< Set by the destructor to end the device task. */
+  std::atomic<bool> exited;    /**< Set by the device task once it no longer touches this object. */
+  std::atomic<bool> restarted; /**< Set by start() so the task restarts counting from now. */
+  int64_t lastTickUs;          /**< Time of the last wheel tick in microseconds. */
+};
+
+#endif  // ESP_TIMER_TICK_SOURCE_HPP
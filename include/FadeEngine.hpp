@@ -0,0 +1,124 @@
+#ifndef FADE_ENGINE_HPP
+#define FADE_ENGINE_HPP
+
+#include <esp_err.h>
+
+#include <TimerWheel.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+/**
+ * @class FadeEngine
+ * @brief Shared fixed-point fade engine for every dimmable channel.
+ *
+ * All active transitions live in one fixed table and are advanced together from a single
+ * periodic timer on the device TimerWheel, which only runs while at least one fade is
+ * active. Levels are kept in 16.16 fixed point so slow fades over many ticks do not lose
+ * steps to rounding. Active fades are packed at the front of the table, so a tick steps
+ * only them, all under a single lock, and delivers the steps after releasing it.
+ */
+class FadeEngine {
+ public:
+  static constexpr size_t kMaxFades = 128;                     /**< Maximum number of simultaneous fades. */
+  static constexpr uint32_t kTickMs = 2 * TimerWheel::kTickMs; /**< Fade resolution in milliseconds. */
+
+  /**
+   * @brief Callback invoked for every fade step.
+   *
+   * @param context Context registered with start().
+   * @param level Level of this step.
+   * @param finished true on the last step of the fade.
+   */
+  typedef void (*StepCallback)(void *context, uint8_t level, bool finished);
+
+  /**
+   * @brief Get the shared engine.
+   *
+   * @return FadeEngine& The engine instance.
+   */
+  static FadeEngine &instance();
+
+  /**
+   * @brief Start or restart the fade of a channel.
+   *
+   * A channel is identified by its context; starting a fade for a context that already
+   * fades replaces the running fade. A zero duration steps to the target immediately.
+   *
+   * @param callback Step callback.
+   * @param context Channel context passed to the callback.
+   * @param from Start level.
+   * @param to Target level.
+   * @param durationMs Duration of the fade in milliseconds.
+   * @return esp_err_t ESP_ERR_NO_MEM if the fade table is full.
+   */
+  esp_err_t start(StepCallback callback, void *context, uint8_t from, uint8_t to, uint32_t durationMs);
+
+  /**
+   * @brief Cancel the fade of a channel, if any.
+   *
+   * Waits for a step of the channel that is being delivered, so the context may be destroyed
+   * once this returns. Called from a step callback, it does not wait for that callback.
+   *
+   * @param context Channel context.
+   */
+  void cancel(void *context);
+
+  /**
+   * @brief Get the number of active fades.
+   *
+   * @return size_t Number of active fades.
+   */
+  size_t activeFades();
+
+  /**
+   * @brief Advance every active fade by one tick.
+   *
+   * Called from the engine timer. Callbacks are invoked without the engine lock held.
+   */
+  void tick();
+
+ private:
+  struct Fade {
+    StepCallback callback; /**< Step callback. */
+    void *context;         /**< Channel context. */
+    int32_t level;         /**< Current level in 16.16 fixed point. */
+    int32_t step;          /**< Level change per tick in 16.16 fixed point. */
+    uint32_t remaining;    /**< Ticks left. */
+    uint8_t target;        /**< Exact level of the last step. */
+  };
+
+  struct Step {
+    StepCallback callback;       /**< Step callback. */
+    void *context;               /**< Channel context. */
+    uint8_t level;               /**< Level of the step. */
+    bool finished;               /**< Whether this is the last step of the fade. */
+    std::atomic<bool> cancelled; /**< Set when the fade was cancelled or replaced before delivery. */
+  };
+
+  FadeEngine();
+
+  void startTimer();
+  void stopTimer();
+
+  /**
+   * @brief Drop the undelivered steps of a channel, called with the engine lock held.
+   *
+   * @param context Channel context.
+   */
+  void dropSteps(void *context);
+
+  std::mutex fadeMutex;           /**< Protects the fade table and the step list. */
+  Fade fades[kMaxFades];          /**< Fade table, active fades packed at the front. */
+  size_t active;                  /**< Number of active fades. */
+  Step steps[kMaxFades];          /**< Steps of the tick being delivered. */
+  size_t stepCount;               /**< Number of steps of the tick being delivered. */
+  std::atomic<void *> delivering; /**< Context whose step callback is running, nullptr if none. */
+  std::thread::id tickThread;     /**< Thread that delivers the steps. */
+  TimerWheel::Timer timer;        /**< Periodic tick timer on the device wheel. */
+  bool timerRunning;              /**< Whether the tick timer is scheduled. */
+};
+
+#endif  // FADE_ENGINE_HPP
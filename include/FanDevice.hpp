@@ -6,7 +6,9 @@
 #include <hal/gpio_types.h>
 
 #include <BaseDevice.hpp>
+#include <DeviceName.hpp>
 #include <FanAccessoryInterface.hpp>
+#include <SeqLock.hpp>
 #include <cstdint>
 
 /**
@@ -18,23 +20,32 @@
  */
 class FanDevice : public BaseDevice {
  public:
+  /**
+   * @struct State
+   * @brief Endpoint state mirrored in the state shadow.
+   */
+  struct State {
+    uint8_t percentSetting; /**< PercentSetting of the endpoint, 0 or 100 for an on/off fan. */
+    uint8_t percentCurrent; /**< Last reported PercentCurrent. */
+  };
+
   /**
    * @brief Constructor for FanDevice.
    *
    * This constructor initializes the FanDevice with specified parameters.
    *
-   * @param device_name The name of the device.
+   * @param device_name The name of the device, copied unless passed as a BorrowedName.
    * @param fan_pin The GPIO pin connected to the fan. Default is GPIO_NUM_NC.
    * @param button_pin The GPIO pin connected to the button. Default is GPIO_NUM_NC.
    * @param aggregator The endpoint aggregator. Default is nullptr.
    */
-  FanDevice(const char *device_name = nullptr, FanAccessoryInterface *fanAccessory = nullptr,
+  FanDevice(DeviceName device_name = nullptr, FanAccessoryInterface *fanAccessory = nullptr,
             esp_matter::endpoint_t *aggregator = nullptr);
 
   /**
-   * @brief Default destructor for FanDevice.
+   * @brief Destructor for FanDevice, unregisters the device.
    */
-  ~FanDevice() = default;
+  ~FanDevice();
 
   /**
    * @brief Update the accessory state.
@@ -64,7 +75,38 @@ class FanDevice : public BaseDevice {
    */
   esp_err_t identify() override;
 
+  /**
+   * @brief Write the cached state of the device into one snapshot row.
+   *
+   * @param snapshot Snapshot buffers to fill.
+   * @param index Row of this device.
+   */
+  void fillSnapshot(DeviceSnapshot &snapshot, size_t index) const override;
+
+  /**
+   * @brief Write the endpoint ids owned by the device.
+   *
+   * @param endpointIds Buffer receiving the endpoint ids.
+   * @param capacity Number of ids the buffer can hold.
+   * @return size_t Number of ids written.
+   */
+  size_t getEndpointIds(uint16_t *endpointIds, size_t capacity) const override;
+
+  /**
+   * @brief Read the endpoint state from any task without the stack lock.
+   *
+   * @return State Consistent copy of the state shadow.
+   */
+  State getState() const;
+
  private:
+  /**
+   * @brief Report callback of the accessory.
+   *
+   * Reports the endpoint, or only PercentCurrent when the change echoes a Matter write.
+   */
+  void onAccessoryReport();
+
   /**
    * @brief Get the power state of the accessory.
    *
@@ -86,7 +128,7 @@ class FanDevice : public BaseDevice {
   /**
    * @brief Get the power state of the endpoint.
    *
-   * This method retrieves the current power state of the endpoint from the Matter framework.
+   * This method retrieves the current power state of the endpoint from the state shadow.
    *
    * @return bool Power state of the endpoint (true for on, false for off).
    */
@@ -98,12 +140,45 @@ class FanDevice : public BaseDevice {
    * This method sets the power state of the endpoint and reports it to the Matter framework.
    *
    * @param powerState Power state to set (true for on, false for off).
+   * @return esp_err_t First error of the reports, see BaseDevice::reportAttribute().
+   */
+  esp_err_t setEndpointPowerState(bool powerState);
+
+  /**
+   * @brief Report the speed the accessory runs at.
+   *
+   * @param percent PercentCurrent to report.
+   * @return esp_err_t Error of the report, see BaseDevice::reportAttribute().
+   */
+  esp_err_t setEndpointPercentCurrent(uint8_t percent);
+
+  /**
+   * @brief Load the state shadow from the attribute store.
+   *
+   * Only called from the constructor and updateAccessory(), which run in the stack context.
+   *
+   * @return esp_err_t ESP_ERR_NOT_FOUND if the attribute does not exist, or the error of the read.
+   */
+  esp_err_t loadShadow();
+
+  /**
+   * @brief Store the fan percent setting in the shadow.
+   *
+   * @param percent PercentSetting to cache.
+   */
+  void cachePercentSetting(uint8_t percent);
+
+  /**
+   * @brief Store the reported PercentCurrent in the shadow and publish it to the state stream if it changed.
+   *
+   * @param percent PercentCurrent to cache.
    */
-  void setEndpointPowerState(bool powerState);
+  void cachePercentCurrent(uint8_t percent);
 
   esp_matter::endpoint_t *endpoint;    /**< Pointer to the esp_matter endpoint. */
   FanAccessoryInterface *fanAccessory; /**< Pointer to the FanAccessory instance. */
-  char name[64];                       /**< Name of the device, TODO: change to a define. */
+  DeviceName name;                     /**< Name of the device, copied or borrowed. */
+  SeqLock<State> shadow;               /**< Endpoint state readable from any task. */
 };
 
 #endif  // FAN_DEVICE_HPP
@@ -0,0 +1,29 @@
+#ifndef HEALTH_PROBE_INTERFACE_HPP
+#define HEALTH_PROBE_INTERFACE_HPP
+
+/**
+ * @class HealthProbeInterface
+ * @brief Optional liveness check of an accessory, used by the HealthSweep.
+ *
+ * Typically implemented by the accessory itself, e.g. by comparing the time since the
+ * hardware last answered against a timeout.
+ */
+class HealthProbeInterface {
+ public:
+  /**
+   * @brief Virtual destructor for HealthProbeInterface.
+   */
+  virtual ~HealthProbeInterface() = default;
+
+  /**
+   * @brief Check whether the accessory is responsive.
+   *
+   * Called from the device TimerWheel with the DeviceRegistry lock held, so it must be cheap
+   * and must not block on the hardware.
+   *
+   * @return bool true if the accessory answered recently.
+   */
+  virtual bool isResponsive() = 0;
+};
+
+#endif  // HEALTH_PROBE_INTERFACE_HPP
@@ -0,0 +1,99 @@
+#ifndef HEALTH_SWEEP_HPP
+#define HEALTH_SWEEP_HPP
+
+#include <esp_err.h>
+
+#include <TimerWheel.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class HealthSweep
+ * @brief Periodic reachability check of every device that has a HealthProbeInterface.
+ *
+ * Every tick of the sweep probes a fixed number of devices from the DeviceRegistry,
+ * continuing where the previous tick stopped, so the cost of a tick does not grow with the
+ * bridge. Reachability flips only after consecutive contradicting probes (hysteresis) and
+ * only the flips are reported. The probes run under the registry lock and only record the
+ * flips; the flips are reported afterwards with the stack lock taken before the registry
+ * lock, the order of the stack context.
+ */
+class HealthSweep {
+ public:
+  static constexpr uint32_t kDefaultPeriodMs = 1000;     /**< Default period between two ticks. */
+  static constexpr size_t kDefaultDevicesPerTick = 8;    /**< Default number of devices probed per tick. */
+  static constexpr uint8_t kDefaultFailThreshold = 3;    /**< Default failed probes before unreachable. */
+  static constexpr uint8_t kDefaultRecoverThreshold = 2; /**< Default good probes before reachable. */
+  static constexpr size_t kMaxDevicesPerTick = 32;       /**< Highest number of devices probed per tick. */
+
+  /**
+   * @struct Stats
+   * @brief Counters of the sweep.
+   */
+  struct Stats {
+    uint32_t ticks;       /**< Ticks run. */
+    uint32_t probes;      /**< Devices visited. */
+    uint32_t transitions; /**< Reachability flips reported. */
+  };
+
+  /**
+   * @brief Get the sweep shared by the device layer.
+   *
+   * @return HealthSweep& The sweep instance.
+   */
+  static HealthSweep &instance();
+
+  /**
+   * @brief Start the periodic sweep on the device TimerWheel.
+   *
+   * A full pass over n devices takes ceil(n / devicesPerTick) ticks.
+   *
+   * @param periodMs Period between two ticks in milliseconds.
+   * @param devicesPerTick Number of devices probed per tick.
+   * @return esp_err_t ESP_ERR_INVALID_ARG if devicesPerTick is 0 or above kMaxDevicesPerTick.
+   */
+  esp_err_t start(uint32_t periodMs = kDefaultPeriodMs, size_t devicesPerTick = kDefaultDevicesPerTick);
+
+  /**
+   * @brief Stop the periodic sweep.
+   */
+  void stop();
+
+  /**
+   * @brief Set the hysteresis of the reachability tracking.
+   *
+   * @param failThreshold Consecutive failed probes before a device becomes unreachable.
+   * @param recoverThreshold Consecutive successful probes before it becomes reachable again.
+   */
+  void setHysteresis(uint8_t failThreshold, uint8_t recoverThreshold);
+
+  /**
+   * @brief Run one tick of the sweep on the calling task.
+   *
+   * Used by the timer, and directly on the host to drive the sweep deterministically.
+   *
+   * @return size_t Number of devices visited.
+   */
+  size_t tick();
+
+  /**
+   * @brief Get the counters of the sweep.
+   *
+   * @return Stats Copy of the counters.
+   */
+  Stats getStats() const;
+
+ private:
+  HealthSweep();
+
+  TimerWheel::Timer timer;               /**< Periodic sweep timer. */
+  std::atomic<size_t> devicesPerTick;    /**< Devices probed per tick. */
+  std::atomic<uint8_t> failThreshold;    /**< Failed probes before unreachable. */
+  std::atomic<uint8_t> recoverThreshold; /**< Good probes before reachable. */
+  std::atomic<uint32_t> ticks;           /**< Ticks run. */
+  std::atomic<uint32_t> probes;          /**< Devices visited. */
+  std::atomic<uint32_t> transitions;     /**< Reachability flips reported. */
+};
+
+#endif  // HEALTH_SWEEP_HPP
@@ -0,0 +1,120 @@
+#ifndef HEAP_AUDIT_HPP
+#define HEAP_AUDIT_HPP
+
+#include <esp_err.h>
+
+#include <DeviceSnapshot.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class HeapAudit
+ * @brief Measures the heap cost of constructing a device and checks it against a per-type budget.
+ *
+ * An audit samples the default heap when it is created, check() samples it again after the
+ * constructor returned and compares the difference in allocated blocks and bytes with the
+ * budget of the device type. Other tasks allocating in between are counted too, so audits are
+ * meant for the start-up, before the Matter stack runs. The worst cost seen per type is kept
+ * so the budgets can be tightened as devices get cheaper. Audits created while auditing is
+ * disabled do nothing.
+ *
+ * The budgets are estimates until replaced by the costs logWorst() prints on the target. Host
+ * tests sample a counting allocator under a fake esp_matter, which checks the number of
+ * allocations the device layer makes, not the heap esp_matter really uses.
+ */
+class HeapAudit {
+ public:
+  /**
+   * @struct Cost
+   * @brief Heap used by a constructor.
+   */
+  struct Cost {
+    uint32_t blocks; /**< Allocated blocks. */
+    uint32_t bytes;  /**< Allocated bytes, including the device object itself. */
+  };
+
+  /**
+   * @brief Function returning the cumulative blocks and bytes allocated so far.
+   */
+  typedef Cost (*Sampler)();
+
+  /**
+   * @brief Sample the heap before constructing a device, if auditing is enabled.
+   */
+  HeapAudit();
+
+  /**
+   * @brief Get the heap allocated since the audit was created.
+   *
+   * @return Cost Allocated blocks and bytes, 0 if the heap shrank or the audit is inactive.
+   */
+  Cost cost() const;
+
+  /**
+   * @brief Record the cost of a device type and check it against its budget.
+   *
+   * @param type Type of the device constructed since the audit was created.
+   * @return esp_err_t ESP_ERR_INVALID_SIZE if the cost exceeds the budget of the type, ESP_OK if
+   * the audit is inactive.
+   */
+  esp_err_t check(DeviceType type) const;
+
+  /**
+   * @brief Get the budget of a device type.
+   *
+   * @param type Device type.
+   * @return Cost The budget, 0 blocks for types without a budget.
+   */
+  static Cost getBudget(DeviceType type);
+
+  /**
+   * @brief Get the highest cost recorded for a device type.
+   *
+   * @param type Device type.
+   * @return Cost The highest blocks and bytes seen by check().
+   */
+  static Cost getWorst(DeviceType type);
+
+  /**
+   * @brief Log the highest cost recorded per device type, in the layout of the budget table.
+   *
+   * Run on the target after creating the devices of a manifest with auditing enabled to
+   * derive the budgets from heap_caps measurements.
+   */
+  static void logWorst();
+
+  /**
+   * @brief Enable or disable auditing, e.g. of the devices created by DeviceManifest.
+   *
+   * Sampling walks every heap, so it is off by default.
+   *
+   * @param enabled Whether to audit.
+   */
+  static void setEnabled(bool enabled);
+
+  /**
+   * @brief Check whether auditing is enabled.
+   *
+   * @return bool true if enabled.
+   */
+  static bool isEnabled();
+
+  /**
+   * @brief Replace the heap_caps sampling, e.g. by a counting allocator in host tests.
+   *
+   * The cost of a constructor is the difference of two samples, so a sampler only has to
+   * count monotonically while audits run.
+   *
+   * @param custom Sampler to use, nullptr for the default heap statistics.
+   */
+  static void setSampler(Sampler custom);
+
+ private:
+  static Cost sample();
+
+  bool active; /**< Whether auditing was enabled when the audit was created. */
+  Cost start;  /**< Heap usage when the audit was created. */
+};
+
+#endif  // HEAP_AUDIT_HPP
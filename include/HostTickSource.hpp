@@ -0,0 +1,48 @@
+#ifndef HOST_TICK_SOURCE_HPP
+#define HOST_TICK_SOURCE_HPP
+
+#include <esp_err.h>
+
+#include <TickSource.hpp>
+#include <TimerWheel.hpp>
+#include <cstdint>
+
+/**
+ * @class HostTickSource
+ * @brief Manually driven tick source for deterministic host runs.
+ *
+ * Wheel callbacks run on the thread calling advanceTicks() or advanceMs().
+ */
+class HostTickSource : public TickSource {
+ public:
+  /**
+   * @brief Constructor for HostTickSource.
+   *
+   * @param wheel Wheel to drive. Default is the device wheel.
+   */
+  explicit HostTickSource(TimerWheel &wheel = TimerWheel::device());
+
+  esp_err_t start() override;
+  void stop() override;
+
+  /**
+   * @brief Advance the wheel by a number of ticks. Ignored while stopped.
+   *
+   * @param ticks Number of ticks.
+   */
+  void advanceTicks(uint32_t ticks);
+
+  /**
+   * @brief Advance the wheel by a duration, keeping sub-tick remainders.
+   *
+   * @param ms Duration in milliseconds.
+   */
+  void advanceMs(uint32_t ms);
+
+ private:
+  TimerWheel &wheel;    /**< Driven wheel. */
+  bool running;         /**< Whether advance calls are applied. */
+  uint32_t remainderMs; /**< Milliseconds not yet turned into a tick. */
+};
+
+#endif  // HOST_TICK_SOURCE_HPP
@@ -5,7 +5,11 @@
 #include <esp_matter.h>
 
 #include <BaseDevice.hpp>
+#include <DeviceName.hpp>
+#include <DeviceTask.hpp>
 #include <LightAccessoryInterface.hpp>
+#include <SeqLock.hpp>
+#include <atomic>
 #include <cstdint>
 
 /**
@@ -14,15 +18,27 @@
  *
  * The LightDevice class encapsulates the behavior of a light accessory, providing
  * methods to interact with the hardware (light and button) and the ESP Matter framework.
+ * Identify blinks the light from a DeviceTask on the DeviceExecutor, without blocking a task.
  */
 class LightDevice : public BaseDevice {
  public:
+  static constexpr uint16_t kIdentifyDefaultSeconds = 3; /**< Identify duration without an IdentifyTime. */
+  static constexpr uint32_t kIdentifyBlinkMs = 500;      /**< Duration of each on and off phase. */
+
+  /**
+   * @struct State
+   * @brief Endpoint state mirrored in the state shadow.
+   */
+  struct State {
+    bool powerState; /**< Power state of the endpoint. */
+  };
+
   /**
    * @brief Constructor for LightDevice.
    *
    * This constructor initializes the LightDevice with specified parameters.
    *
-   * @param device_name The name of the device.
+   * @param device_name The name of the device, copied unless passed as a BorrowedName.
    * @param light_pin The GPIO pin connected to the light. Default is GPIO_NUM_NC.
    * @param button_pin The GPIO pin connected to the button. Default is GPIO_NUM_NC.
    * @param aggregator The endpoint aggregator. Default is nullptr.
@@ -33,13 +49,16 @@ class LightDevice : public BaseDevice {
    * If no name is provided, it creates a bridged node endpoint with a default name.
    * If no aggregator is provided, it creates a standalone LightDevice.
    */
-  LightDevice(const char *device_name = nullptr, LightAccessoryInterface *lightAccessory = nullptr,
+  LightDevice(DeviceName device_name = nullptr, LightAccessoryInterface *lightAccessory = nullptr,
               esp_matter::endpoint_t *aggregator = nullptr);
 
   /**
-   * @brief Default destructor for LightDevice.
+   * @brief Destructor for LightDevice, cancels a running identify sequence.
+   *
+   * The sequence is destroyed without being resumed again, so it must not be running on the
+   * wheel context at the same time.
    */
-  ~LightDevice() = default;
+  ~LightDevice();
 
   /**
    * @brief Update the accessory state.
@@ -62,14 +81,62 @@ class LightDevice : public BaseDevice {
   /**
    * @brief Identify the LightDevice.
    *
-   * This method triggers the identification process for the LightDevice, typically involving
-   * visual or audible signals from the light accessory.
+   * Blinks the light once per second for IdentifyTime seconds, then restores the endpoint
+   * power state. An IdentifyTime of 0 stops a running blink. Falls back to the accessory's own
+   * identify effect if the sequence cannot be started.
    *
    * @return esp_err_t Error code indicating success or failure.
    */
   esp_err_t identify() override;
 
+  /**
+   * @brief Write the cached state of the device into one snapshot row.
+   *
+   * @param snapshot Snapshot buffers to fill.
+   * @param index Row of this device.
+   */
+  void fillSnapshot(DeviceSnapshot &snapshot, size_t index) const override;
+
+  /**
+   * @brief Write the endpoint ids owned by the device.
+   *
+   * @param endpointIds Buffer receiving the endpoint ids.
+   * @param capacity Number of ids the buffer can hold.
+   * @return size_t Number of ids written.
+   */
+  size_t getEndpointIds(uint16_t *endpointIds, size_t capacity) const override;
+
+  /**
+   * @brief Read the endpoint state from any task without the stack lock.
+   *
+   * @return State Consistent copy of the state shadow.
+   */
+  State getState() const;
+
  private:
+  /**
+   * @brief Report callback of the accessory.
+   *
+   * Reports the endpoint unless the change only echoes a Matter write.
+   */
+  void onAccessoryReport();
+
+  /**
+   * @brief Blink the light, run on the DeviceExecutor.
+   *
+   * @param seconds Duration of the blink.
+   * @return DeviceTask The blink sequence.
+   */
+  DeviceTask blinkIdentify(uint16_t seconds);
+
+  /**
+   * @brief Read IdentifyTime from the attribute store.
+   *
+   * @return uint16_t IdentifyTime in seconds, kIdentifyDefaultSeconds if the endpoint has no
+   * Identify cluster.
+   */
+  uint16_t getEndpointIdentifyTime();
+
   /**
    * @brief Get the power state of the accessory.
    *
@@ -82,7 +149,7 @@ class LightDevice : public BaseDevice {
   /**
    * @brief Set the power state of the accessory.
    *
-   * This method sets the power state of the light accessory.
+   * This method sets the power state of the light accessory, tagged as a Matter write.
    *
    * @param powerState Power state to set (true for on, false for off).
    */
@@ -91,7 +158,7 @@ class LightDevice : public BaseDevice {
   /**
    * @brief Get the power state of the endpoint.
    *
-   * This method retrieves the current power state of the endpoint from the Matter framework.
+   * This method retrieves the current power state of the endpoint from the state shadow.
    *
    * @return bool Power state of the endpoint (true for on, false for off).
    */
@@ -103,12 +170,32 @@ class LightDevice : public BaseDevice {
    * This method sets the power state of the endpoint and reports it to the Matter framework.
    *
    * @param powerState Power state to set (true for on, false for off).
+   * @return esp_err_t Error of the report, see BaseDevice::reportAttribute().
+   */
+  esp_err_t setEndpointPowerState(bool powerState);
+
+  /**
+   * @brief Load the state shadow from the attribute store.
+   *
+   * Only called from the constructor and updateAccessory(), which run in the stack context.
+   *
+   * @return esp_err_t ESP_ERR_NOT_FOUND if the attribute does not exist, or the error of the read.
+   */
+  esp_err_t loadShadow();
+
+  /**
+   * @brief Store the power state in the shadow and publish it to the state stream if it changed.
+   *
+   * @param powerState Power state to cache.
    */
-  void setEndpointPowerState(bool powerState);
+  void cachePowerState(bool powerState);
 
   esp_matter::endpoint_t *endpoint;        /**< Pointer to the esp_matter endpoint. */
   LightAccessoryInterface *lightAccessory; /**< Pointer to the LightAccessory instance. */
-  char name[64];                           /**< Name of the device, TODO: change to a define. */
+  DeviceName name;                         /**< Name of the device, copied or borrowed. */
+  SeqLock<State> shadow;                   /**< Endpoint state readable from any task. */
+  std::atomic<bool> identifying;           /**< Whether the blink drives the accessory. */
+  uint32_t identifyTask;                   /**< DeviceExecutor id of the blink sequence. */
 };
 
 #endif  // LIGHT_DEVICE_HPP
@@ -0,0 +1,47 @@
+#ifndef MATTER_SUBSCRIPTION_EVENT_SOURCE_HPP
+#define MATTER_SUBSCRIPTION_EVENT_SOURCE_HPP
+
+#include <esp_err.h>
+
+#include <app/ReadHandler.h>
+
+#include <SubscriptionTracker.hpp>
+#include <cstddef>
+
+/**
+ * @class MatterSubscriptionEventSource
+ * @brief SubscriptionEventSource fed by the stack's read handler callbacks.
+ *
+ * Registers itself as the InteractionModelEngine read handler application callback and
+ * forwards every attribute path of established and terminated subscriptions. Only read
+ * handlers that were seen established are forwarded on termination, so the tracker counts
+ * stay balanced.
+ */
+class MatterSubscriptionEventSource : public SubscriptionEventSource,
+                                      public chip::app::ReadHandler::ApplicationCallback {
+ public:
+  static constexpr size_t kMaxSubscriptions = 16; /**< Number of concurrently tracked subscriptions. */
+
+  MatterSubscriptionEventSource();
+
+  /**
+   * @brief Register the listener and the read handler callback. Call with the stack lock held.
+   *
+   * @param listener Listener function.
+   * @param context Context passed to the listener.
+   * @return esp_err_t Error code indicating success or failure.
+   */
+  esp_err_t setListener(Listener listener, void *context) override;
+
+  void OnSubscriptionEstablished(chip::app::ReadHandler &readHandler) override;
+  void OnSubscriptionTerminated(chip::app::ReadHandler &readHandler) override;
+
+ private:
+  void forward(chip::app::ReadHandler &readHandler, bool subscribed);
+
+  Listener listener;                                      /**< Registered listener. */
+  void *listenerContext;                                  /**< Context of the listener. */
+  chip::app::ReadHandler *established[kMaxSubscriptions]; /**< Read handlers seen established. */
+};
+
+#endif  // MATTER_SUBSCRIPTION_EVENT_SOURCE_HPP
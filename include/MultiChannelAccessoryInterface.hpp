@@ -0,0 +1,56 @@
+#ifndef MULTI_CHANNEL_ACCESSORY_INTERFACE_HPP
+#define MULTI_CHANNEL_ACCESSORY_INTERFACE_HPP
+
+#include <cstdint>
+
+/**
+ * @class MultiChannelAccessoryInterface
+ * @brief Interface for an accessory that switches several on/off channels in one hardware write,
+ * such as a relay board driven by a shift register.
+ *
+ * Channel i is bit i of every mask.
+ */
+class MultiChannelAccessoryInterface {
+ public:
+  /**
+   * @brief Virtual destructor for MultiChannelAccessoryInterface.
+   */
+  virtual ~MultiChannelAccessoryInterface() = default;
+
+  /**
+   * @brief Get the number of channels of the accessory.
+   *
+   * @return uint8_t Number of channels.
+   */
+  virtual uint8_t getChannelCount() = 0;
+
+  /**
+   * @brief Get the power state of every channel.
+   *
+   * @return uint32_t Power mask, bit i set when channel i is on.
+   */
+  virtual uint32_t getChannelMask() = 0;
+
+  /**
+   * @brief Switch several channels in one hardware write.
+   *
+   * @param powerMask New power state of the channels selected by changedMask.
+   * @param changedMask Channels to write; the others keep their state.
+   */
+  virtual void setChannelMask(uint32_t powerMask, uint32_t changedMask) = 0;
+
+  /**
+   * @brief Set the callback invoked when channels change on the accessory side, once per batch.
+   *
+   * @param callback Callback function.
+   * @param context Context passed to the callback.
+   */
+  virtual void setReportAppCallback(void (*callback)(void *), void *context) = 0;
+
+  /**
+   * @brief Identify the accessory.
+   */
+  virtual void identifyYourSelf() = 0;
+};
+
+#endif  // MULTI_CHANNEL_ACCESSORY_INTERFACE_HPP
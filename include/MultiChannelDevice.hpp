@@ -0,0 +1,151 @@
+#ifndef MULTI_CHANNEL_DEVICE_HPP
+#define MULTI_CHANNEL_DEVICE_HPP
+
+#include <esp_err.h>
+#include <esp_matter.h>
+
+#include <BaseDevice.hpp>
+#include <DeviceName.hpp>
+#include <MultiChannelAccessoryInterface.hpp>
+#include <SeqLock.hpp>
+#include <cstdint>
+
+/**
+ * @class MultiChannelDevice
+ * @brief This class represents a multi-channel on/off device, such as a relay board,
+ * inheriting from the BaseDevice class.
+ *
+ * One MultiChannelDevice creates one endpoint per channel of its accessory. All channels that
+ * the stack changed are written to the accessory in one setChannelMask() call, and all
+ * channels the accessory changed are reported in one batch from a single callback.
+ */
+class MultiChannelDevice : public BaseDevice {
+ public:
+  static constexpr uint8_t kMaxChannels = 32; /**< Maximum number of channels, one mask bit each. */
+
+  /**
+   * @enum ChannelType
+   * @brief Endpoint type created for every channel.
+   */
+  enum class ChannelType : uint8_t {
+    PlugIn, /**< on_off_plugin_unit endpoints. */
+    Light,  /**< on_off_light endpoints. */
+  };
+
+  /**
+   * @struct State
+   * @brief Endpoint state mirrored in the state shadow.
+   */
+  struct State {
+    uint32_t powerMask; /**< Power state of every channel, bit i for channel i. */
+  };
+
+  /**
+   * @brief Constructor for MultiChannelDevice.
+   *
+   * @param device_name The name of the device, copied unless passed as a BorrowedName. Channel
+   * endpoints are labelled "<name> <n>".
+   * @param accessory The multi-channel accessory. Default is nullptr.
+   * @param aggregator The endpoint aggregator. Default is nullptr.
+   * @param channelType Endpoint type of the channels. Default is ChannelType::PlugIn.
+   *
+   * @details If an aggregator is provided, every channel is a bridged node endpoint.
+   * If no aggregator is provided, every channel is a standalone endpoint.
+   * Channels beyond kMaxChannels are ignored.
+   */
+  MultiChannelDevice(DeviceName device_name = nullptr, MultiChannelAccessoryInterface *accessory = nullptr,
+                     esp_matter::endpoint_t *aggregator = nullptr, ChannelType channelType = ChannelType::PlugIn);
+
+  /**
+   * @brief Destructor for MultiChannelDevice, unregisters the device.
+   */
+  ~MultiChannelDevice();
+
+  /**
+   * @brief Update the accessory state.
+   *
+   * Writes every channel whose endpoint changed in one hardware write.
+   *
+   * @return esp_err_t Error code indicating success or failure.
+   */
+  esp_err_t updateAccessory() override;
+
+  /**
+   * @brief Report the endpoint state.
+   *
+   * Reports every channel whose accessory state changed.
+   *
+   * @return esp_err_t Error code indicating success or failure.
+   */
+  esp_err_t reportEndpoint() override;
+
+  /**
+   * @brief Identify the MultiChannelDevice.
+   *
+   * @return esp_err_t Error code indicating success or failure.
+   */
+  esp_err_t identify() override;
+
+  /**
+   * @brief Write the cached state of the device into one snapshot row.
+   *
+   * The row carries the endpoint of channel 0 and the power mask of all channels.
+   *
+   * @param snapshot Snapshot buffers to fill.
+   * @param index Row of this device.
+   */
+  void fillSnapshot(DeviceSnapshot &snapshot, size_t index) const override;
+
+  /**
+   * @brief Write the endpoint ids owned by the device.
+   *
+   * @param endpointIds Buffer receiving the endpoint ids.
+   * @param capacity Number of ids the buffer can hold.
+   * @return size_t Number of ids written.
+   */
+  size_t getEndpointIds(uint16_t *endpointIds, size_t capacity) const override;
+
+  /**
+   * @brief Get the number of channels.
+   *
+   * @return uint8_t Number of channel endpoints.
+   */
+  uint8_t getChannelCount() const;
+
+  /**
+   * @brief Get the endpoint id of a channel.
+   *
+   * @param channel Channel index.
+   * @return uint16_t Endpoint id, 0xFFFF if the channel does not exist.
+   */
+  uint16_t getChannelEndpointId(uint8_t channel) const;
+
+  /**
+   * @brief Read the endpoint state from any task without the stack lock.
+   *
+   * @return State Consistent copy of the state shadow.
+   */
+  State getState() const;
+
+ private:
+  esp_matter::endpoint_t *createChannelEndpoint(uint8_t channel, esp_matter::endpoint_t *aggregator);
+  uint32_t getEndpointPowerMask();
+  uint32_t channelsMask() const;
+
+  /**
+   * @brief Store the power mask in the shadow and publish every changed channel to the state stream.
+   *
+   * @param powerMask Power mask to cache.
+   * @return uint32_t Channels that changed.
+   */
+  uint32_t cachePowerMask(uint32_t powerMask);
+
+  esp_matter::endpoint_t *endpoints[kMaxChannels]; /**< Endpoint of every channel. */
+  MultiChannelAccessoryInterface *accessory;       /**< Pointer to the multi-channel accessory. */
+  uint8_t channelCount;                            /**< Number of channels. */
+  ChannelType channelType;                         /**< Endpoint type of the channels. */
+  DeviceName name;                                 /**< Name of the device, copied or borrowed. */
+  SeqLock<State> shadow;                           /**< Endpoint state readable from any task. */
+};
+
+#endif  // MULTI_CHANNEL_DEVICE_HPP
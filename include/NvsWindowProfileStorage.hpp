@@ -0,0 +1,52 @@
+#ifndef NVS_WINDOW_PROFILE_STORAGE_HPP
+#define NVS_WINDOW_PROFILE_STORAGE_HPP
+
+#include <esp_err.h>
+
+#include <WindowProfileStorageInterface.hpp>
+
+/**
+ * @class NvsWindowProfileStorage
+ * @brief Stores window travel profiles as NVS blobs.
+ *
+ * NVS must be initialized by the application. Keys longer than the NVS limit of 15
+ * characters are truncated, so windows must differ within their first 15 characters.
+ */
+class NvsWindowProfileStorage : public WindowProfileStorageInterface {
+ public:
+  /**
+   * @brief Constructor for NvsWindowProfileStorage.
+   *
+   * @param nvsNamespace NVS namespace of the profiles, not copied. Default is "window".
+   */
+  explicit NvsWindowProfileStorage(const char *nvsNamespace = "window");
+
+  /**
+   * @brief Default destructor for NvsWindowProfileStorage.
+   */
+  ~NvsWindowProfileStorage() = default;
+
+  /**
+   * @brief Load a stored profile.
+   *
+   * @param key Key of the window.
+   * @param profile Profile to fill.
+   * @return esp_err_t ESP_ERR_NOT_FOUND if no profile was stored for the key, ESP_ERR_INVALID_SIZE
+   * if the stored blob has another layout.
+   */
+  esp_err_t load(const char *key, WindowTravelProfile &profile) override;
+
+  /**
+   * @brief Store a profile and commit it.
+   *
+   * @param key Key of the window.
+   * @param profile Profile to store.
+   * @return esp_err_t Error code indicating success or failure.
+   */
+  esp_err_t save(const char *key, const WindowTravelProfile &profile) override;
+
+ private:
+  const char *nvsNamespace; /**< NVS namespace of the profiles. */
+};
+
+#endif  // NVS_WINDOW_PROFILE_STORAGE_HPP
@@ -6,7 +6,14 @@
 #include <hal/gpio_types.h>
 
 #include <BaseDevice.hpp>
+#include <DeviceName.hpp>
+#include <PowerMeasurementDelegate.hpp>
+#include <PowerMeterAggregator.hpp>
+#include <PowerMeterInterface.hpp>
+#include <SeqLock.hpp>
+#include <TimerWheel.hpp>
 #include <cstdint>
+#include <mutex>
 #include <PluginAccessoryInterface.hpp>
 
 /**
@@ -18,29 +25,40 @@
  */
 class PlugInDevice : public BaseDevice {
  public:
+  /**
+   * @struct State
+   * @brief Endpoint state mirrored in the state shadow.
+   */
+  struct State {
+    bool powerState; /**< Power state of the endpoint. */
+  };
+
   /**
    * @brief Constructor for PlugInDevice.
    *
    * This constructor initializes the PlugInDevice with specified parameters.
    *
-   * @param device_name The name of the device.
+   * @param device_name The name of the device, copied unless passed as a BorrowedName.
    * @param relay_pin The GPIO pin connected to the relay. Default is GPIO_NUM_NC.
    * @param button_pin The GPIO pin connected to the button. Default is GPIO_NUM_NC.
    * @param aggregator The endpoint aggregator. Default is nullptr.
+   * @param powerMeter The metering chip of the plug. Default is nullptr.
    *
    * @details The constructor creates a PlugInAccessory instance with the specified relay and button pins.
    * It also sets up the callback for reporting attributes.
    * If an aggregator is provided, it creates a bridged node endpoint with the specified name.
    * If no name is provided, it creates a bridged node endpoint with a default name.
    * If no aggregator is provided, it creates a standalone PlugInDevice.
+   * If a power meter is provided, it adds the Electrical Power Measurement and Electrical Energy
+   * Measurement clusters to the endpoint.
    */
-  PlugInDevice(const char *device_name = nullptr, PluginAccessoryInterface *plugInAccessory = nullptr,
-               esp_matter::endpoint_t *aggregator = nullptr);
+  PlugInDevice(DeviceName device_name = nullptr, PluginAccessoryInterface *plugInAccessory = nullptr,
+               esp_matter::endpoint_t *aggregator = nullptr, PowerMeterInterface *powerMeter = nullptr);
 
   /**
-   * @brief Default destructor for PlugInDevice.
+   * @brief Destructor for PlugInDevice, stops metering.
    */
-  ~PlugInDevice() = default;
+  ~PlugInDevice();
 
   /**
    * @brief Update the accessory state.
@@ -69,15 +87,118 @@ class PlugInDevice : public BaseDevice {
    */
   esp_err_t identify() override;
 
+  /**
+   * @brief Write the cached state of the device into one snapshot row.
+   *
+   * @param snapshot Snapshot buffers to fill.
+   * @param index Row of this device.
+   */
+  void fillSnapshot(DeviceSnapshot &snapshot, size_t index) const override;
+
+  /**
+   * @brief Write the endpoint ids owned by the device.
+   *
+   * @param endpointIds Buffer receiving the endpoint ids.
+   * @param capacity Number of ids the buffer can hold.
+   * @return size_t Number of ids written.
+   */
+  size_t getEndpointIds(uint16_t *endpointIds, size_t capacity) const override;
+
+  /**
+   * @brief Read one sample from the power meter.
+   *
+   * The sample is aggregated on the device; the aggregate is only published to the EPM
+   * delegate when the aggregator thresholds say so. Call this at the metering rate; it never
+   * takes the stack lock.
+   *
+   * @param nowMs Current time in milliseconds.
+   * @return esp_err_t ESP_ERR_NOT_SUPPORTED without a power meter, ESP_FAIL if the read failed,
+   * or the error of a due report.
+   */
+  esp_err_t sampleMeter(uint32_t nowMs);
+
+  /**
+   * @brief Sample the power meter periodically from the device TimerWheel.
+   *
+   * @param intervalMs Sampling interval in milliseconds.
+   * @return esp_err_t ESP_ERR_NOT_SUPPORTED without a power meter.
+   */
+  esp_err_t startMetering(uint32_t intervalMs);
+
+  /**
+   * @brief Stop the periodic sampling started by startMetering(), waiting for a running sample.
+   */
+  void stopMetering();
+
+  /**
+   * @brief Set the thresholds that trigger a measurement report. Ignored without a power meter.
+   *
+   * @param thresholds Reporting thresholds.
+   */
+  void setMeterThresholds(const PowerMeterAggregator::Thresholds &thresholds);
+
+  /**
+   * @brief Get the aggregated metering values, safe from any task.
+   *
+   * @return PowerMeterAggregator::Summary Min/max/mean power and accumulated energy, all zero
+   * without a power meter.
+   */
+  PowerMeterAggregator::Summary getMeterSummary() const;
+
+  /**
+   * @brief Read the endpoint state from any task without the stack lock.
+   *
+   * @return State Consistent copy of the state shadow.
+   */
+  State getState() const;
+
  private:
+  /**
+   * @struct Metering
+   * @brief Meter state, only allocated for a plug with a power meter.
+   */
+  struct Metering {
+    PowerMeterAggregator aggregator;   /**< On-device aggregation of the meter samples. */
+    std::mutex mutex;                  /**< Guards the aggregator against readers on other tasks. */
+    PowerMeasurementDelegate delegate; /**< Serves the EPM attributes to the cluster server. */
+    TimerWheel::Timer timer;           /**< Periodic sampling timer. */
+  };
+
+  /**
+   * @brief Report callback of the accessory.
+   *
+   * Reports the endpoint unless the change only echoes a Matter write.
+   */
+  void onAccessoryReport();
+
   bool getAccessoryPowerState();
   void setAccessoryPowerState(bool powerState);
   bool getEndpointPowerState();
-  void setEndpointPowerState(bool powerState);
+  esp_err_t setEndpointPowerState(bool powerState);
+  esp_err_t setEndpointPowerMeasurement(const PowerMeterAggregator::Summary &summary);
+
+  /**
+   * @brief Load the state shadow from the attribute store.
+   *
+   * Only called from the constructor and updateAccessory(), which run in the stack context.
+   *
+   * @return esp_err_t ESP_ERR_NOT_FOUND if the attribute does not exist, or the error of the read.
+   */
+  esp_err_t loadShadow();
+
+  /**
+   * @brief Store the power state in the shadow and publish it to the state stream if it changed.
+   *
+   * @param powerState Power state to cache.
+   */
+  void cachePowerState(bool powerState);
 
   esp_matter::endpoint_t *endpoint;    /**< Pointer to the esp_matter endpoint. */
   PluginAccessoryInterface *accessory; /**< Pointer to the PlugInAccessory instance. */
-  char name[64];                       /**< Name of the device, TODO: change to a define. */
+  DeviceName name;                     /**< Name of the device, copied or borrowed. */
+  SeqLock<State> shadow;               /**< Endpoint state readable from any task. */
+  PowerMeterInterface *powerMeter;     /**< Pointer to the metering chip, nullptr if none. */
+  Metering *metering;                  /**< Meter state, nullptr without a power meter. */
 };
 
 #endif  // PLUG_IN_DEVICE_HPP
\ No newline at end of file
@@ -0,0 +1,121 @@
+#ifndef POWER_MEASUREMENT_DELEGATE_HPP
+#define POWER_MEASUREMENT_DELEGATE_HPP
+
+#include <app/clusters/electrical-power-measurement-server/electrical-power-measurement-server.h>
+
+#include <PowerMeterAggregator.hpp>
+#include <SeqLock.hpp>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @class PowerMeasurementDelegate
+ * @brief Electrical Power Measurement delegate serving the aggregated meter values.
+ *
+ * The EPM attributes are not stored in the attribute store: the cluster server reads them
+ * from this delegate on the CHIP thread. The meter task publishes each reported aggregate
+ * through a SeqLock and schedules the change notification on the CHIP thread, so neither
+ * side blocks on the other or on the stack lock. Scheduled work finds the delegate by
+ * endpoint in an intrusive list, so work still queued when the device is destroyed is dropped.
+ * Accuracy, ranges and harmonics are not provided.
+ */
+class PowerMeasurementDelegate : public chip::app::Clusters::ElectricalPowerMeasurement::Delegate {
+ public:
+  /**
+   * @brief Constructor for PowerMeasurementDelegate, all values are null until the first publish.
+   */
+  PowerMeasurementDelegate();
+
+  /**
+   * @brief Destructor for PowerMeasurementDelegate, detaches it from its endpoint.
+   */
+  ~PowerMeasurementDelegate();
+
+  /**
+   * @brief Bind the delegate to the endpoint that hosts the EPM cluster.
+   *
+   * @param endpointId Endpoint of the cluster.
+   */
+  void attach(uint16_t endpointId);
+
+  /**
+   * @brief Publish an aggregate and notify the stack, safe from any task.
+   *
+   * @param summary Aggregated meter values.
+   * @return esp_err_t ESP_ERR_INVALID_STATE if the delegate is not attached, ESP_FAIL if the
+   * notification cannot be scheduled.
+   */
+  esp_err_t publish(const PowerMeterAggregator::Summary &summary);
+
+  chip::app::Clusters::ElectricalPowerMeasurement::PowerModeEnum GetPowerMode() override;
+  uint8_t GetNumberOfMeasurementTypes() override;
+  CHIP_ERROR StartAccuracyRead() override;
+  CHIP_ERROR GetAccuracyByIndex(
+      uint8_t index,
+      chip::app::Clusters::ElectricalPowerMeasurement::Structs::MeasurementAccuracyStruct::Type &accuracy) override;
+  CHIP_ERROR EndAccuracyRead() override;
+  CHIP_ERROR StartRangesRead() override;
+  CHIP_ERROR GetRangeByIndex(
+      uint8_t index,
+      chip::app::Clusters::ElectricalPowerMeasurement::Structs::MeasurementRangeStruct::Type &range) override;
+  CHIP_ERROR EndRangesRead() override;
+  CHIP_ERROR StartHarmonicCurrentsRead() override;
+  CHIP_ERROR GetHarmonicCurrentsByIndex(
+      uint8_t index,
+      chip::app::Clusters::ElectricalPowerMeasurement::Structs::HarmonicMeasurementStruct::Type &harmonic) override;
+  CHIP_ERROR EndHarmonicCurrentsRead() override;
+  CHIP_ERROR StartHarmonicPhasesRead() override;
+  CHIP_ERROR GetHarmonicPhasesByIndex(
+      uint8_t index,
+      chip::app::Clusters::ElectricalPowerMeasurement::Structs::HarmonicMeasurementStruct::Type &harmonic) override;
+  CHIP_ERROR EndHarmonicPhasesRead() override;
+
+  chip::app::DataModel::Nullable<int64_t> GetVoltage() override;
+  chip::app::DataModel::Nullable<int64_t> GetActiveCurrent() override;
+  chip::app::DataModel::Nullable<int64_t> GetReactiveCurrent() override;
+  chip::app::DataModel::Nullable<int64_t> GetApparentCurrent() override;
+  chip::app::DataModel::Nullable<int64_t> GetActivePower() override;
+  chip::app::DataModel::Nullable<int64_t> GetReactivePower() override;
+  chip::app::DataModel::Nullable<int64_t> GetApparentPower() override;
+  chip::app::DataModel::Nullable<int64_t> GetRMSVoltage() override;
+  chip::app::DataModel::Nullable<int64_t> GetRMSCurrent() override;
+  chip::app::DataModel::Nullable<int64_t> GetRMSPower() override;
+  chip::app::DataModel::Nullable<int64_t> GetFrequency() override;
+  chip::app::DataModel::Nullable<int64_t> GetPowerFactor() override;
+  chip::app::DataModel::Nullable<int64_t> GetNeutralCurrent() override;
+
+ private:
+  /**
+   * @struct Measurement
+   * @brief Published values in the units of the EPM cluster.
+   */
+  struct Measurement {
+    bool valid;      /**< Whether a summary was published. */
+    int64_t power;   /**< Active power in mW. */
+    int64_t voltage; /**< Voltage in mV. */
+    int64_t current; /**< Active current in mA. */
+    int64_t energy;  /**< Accumulated energy in mWh. */
+  };
+
+  /**
+   * @brief Notify the stack of the published values, runs on the CHIP thread.
+   *
+   * @param endpointId Endpoint of the delegate.
+   */
+  static void notifyChanged(intptr_t endpointId);
+
+  /**
+   * @brief Lock of the delegate list, held while scheduled work uses a delegate.
+   *
+   * @return std::mutex& The list lock.
+   */
+  static std::mutex &listMutex();
+
+  static PowerMeasurementDelegate *head; /**< First attached delegate. */
+
+  SeqLock<Measurement> measurement; /**< Last published values. */
+  PowerMeasurementDelegate *next;   /**< Next attached delegate. */
+  bool attached;                    /**< Whether the delegate is in the list. */
+};
+
+#endif  // POWER_MEASUREMENT_DELEGATE_HPP
@@ -0,0 +1,111 @@
+#ifndef POWER_METER_AGGREGATOR_HPP
+#define POWER_METER_AGGREGATOR_HPP
+
+#include <PowerMeterInterface.hpp>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class PowerMeterAggregator
+ * @brief Aggregates power samples on the device and decides when they are worth reporting.
+ *
+ * Samples are kept in a fixed ring of kWindowSize entries. The aggregator keeps running
+ * sums for the window means and integrates active power into accumulated energy. A report
+ * is due when the mean power or the energy moved by more than the configured deltas, or
+ * when the maximum interval expired, but never before the minimum interval.
+ */
+class PowerMeterAggregator {
+ public:
+  static constexpr size_t kWindowSize = 32; /**< Number of samples kept for min/max/mean. */
+
+  /**
+   * @struct Thresholds
+   * @brief Reporting thresholds.
+   */
+  struct Thresholds {
+    int32_t powerDelta = 1000;      /**< Mean power change in mW that triggers a report. */
+    int64_t energyDelta = 1000;     /**< Energy change in mWh that triggers a report. */
+    uint32_t minIntervalMs = 1000;  /**< Minimum time between two reports. */
+    uint32_t maxIntervalMs = 60000; /**< Maximum time between two reports. */
+  };
+
+  /**
+   * @struct Summary
+   * @brief Aggregated values over the sample window.
+   */
+  struct Summary {
+    int32_t minPower;    /**< Minimum active power in mW. */
+    int32_t maxPower;    /**< Maximum active power in mW. */
+    int32_t meanPower;   /**< Mean active power in mW. */
+    int32_t meanVoltage; /**< Mean voltage in mV. */
+    int32_t meanCurrent; /**< Mean current in mA. */
+    int64_t energy;      /**< Accumulated energy in mWh. */
+    size_t samples;      /**< Number of samples in the window. */
+  };
+
+  /**
+   * @brief Constructor for PowerMeterAggregator with the default thresholds.
+   */
+  PowerMeterAggregator();
+
+  /**
+   * @brief Constructor for PowerMeterAggregator.
+   *
+   * @param thresholds Reporting thresholds.
+   */
+  explicit PowerMeterAggregator(const Thresholds &thresholds);
+
+  /**
+   * @brief Add one sample to the window and integrate its energy.
+   *
+   * @param sample Sample to add.
+   */
+  void addSample(const PowerSample &sample);
+
+  /**
+   * @brief Get the aggregated values over the current window.
+   *
+   * @return Summary Aggregated values.
+   */
+  Summary summary() const;
+
+  /**
+   * @brief Check whether the aggregated values should be reported.
+   *
+   * @param nowMs Current time in milliseconds.
+   * @return bool true if a report is due.
+   */
+  bool reportDue(uint32_t nowMs) const;
+
+  /**
+   * @brief Remember the values that were just reported.
+   *
+   * @param nowMs Current time in milliseconds.
+   */
+  void markReported(uint32_t nowMs);
+
+  /**
+   * @brief Replace the reporting thresholds.
+   *
+   * @param thresholds New thresholds.
+   */
+  void setThresholds(const Thresholds &thresholds);
+
+ private:
+  Thresholds thresholds;
+  PowerSample window[kWindowSize]; /**< Ring of the latest samples. */
+  size_t next;                     /**< Ring slot of the next sample. */
+  size_t count;                    /**< Number of valid samples in the ring. */
+  int64_t powerSum;                /**< Sum of activePower over the window. */
+  int64_t voltageSum;              /**< Sum of voltage over the window. */
+  int64_t currentSum;              /**< Sum of current over the window. */
+  int64_t energyMilliWattMs;       /**< Accumulated energy in mW*ms. */
+  bool hasLastSample;              /**< Whether lastSample is valid. */
+  PowerSample lastSample;          /**< Previous sample, used for the energy integration. */
+  bool hasReported;                /**< Whether a report was made yet. */
+  uint32_t lastReportMs;           /**< Time of the last report. */
+  int32_t lastReportedPower;       /**< Mean power at the last report. */
+  int64_t lastReportedEnergy;      /**< Energy at the last report. */
+};
+
+#endif  // POWER_METER_AGGREGATOR_HPP
@@ -0,0 +1,38 @@
+#ifndef POWER_METER_INTERFACE_HPP
+#define POWER_METER_INTERFACE_HPP
+
+#include <cstdint>
+
+/**
+ * @struct PowerSample
+ * @brief One reading of a metering chip.
+ */
+struct PowerSample {
+  uint32_t timestampMs; /**< Time of the reading in milliseconds, may wrap. */
+  int32_t voltage;      /**< RMS voltage in mV. */
+  int32_t current;      /**< RMS current in mA. */
+  int32_t activePower;  /**< Active power in mW. */
+};
+
+/**
+ * @class PowerMeterInterface
+ * @brief Interface for the metering chip of a plug.
+ */
+class PowerMeterInterface {
+ public:
+  /**
+   * @brief Virtual destructor for PowerMeterInterface.
+   */
+  virtual ~PowerMeterInterface() = default;
+
+  /**
+   * @brief Read one sample from the metering chip.
+   *
+   * @param nowMs Current time in milliseconds.
+   * @param sample Sample to fill.
+   * @return bool true if a sample was read.
+   */
+  virtual bool readSample(uint32_t nowMs, PowerSample &sample) = 0;
+};
+
+#endif  // POWER_METER_INTERFACE_HPP
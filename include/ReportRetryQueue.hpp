@@ -0,0 +1,133 @@
+#ifndef REPORT_RETRY_QUEUE_HPP
+#define REPORT_RETRY_QUEUE_HPP
+
+#include <esp_err.h>
+#include <esp_matter.h>
+
+#include <ReportScheduler.hpp>
+#include <TimerWheel.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @class ReportRetryQueue
+ * @brief Bounded queue of the attribute reports the stack rejected, retried with exponential
+ * backoff from the device TimerWheel.
+ *
+ * Entries coalesce per attribute path, so only the latest value of an attribute is retried,
+ * and a fresh report of the path cancels its pending retry. A retry goes back through the
+ * ReportScheduler lane of the original report with the sequence of the fresh report it came
+ * from, so the scheduler drops it if a fresher value was reported meanwhile, even one sent
+ * before the retry was due. After kMaxAttempts retries, or when the queue
+ * is full, the report is dropped. Failures, retries and drops are counted on the device that
+ * owns the endpoint, see BaseDevice::getReportErrorStats().
+ */
+class ReportRetryQueue {
+ public:
+  static constexpr size_t kCapacity = 32;       /**< Number of attribute paths that can wait for a retry. */
+  static constexpr uint8_t kMaxAttempts = 5;    /**< Retries before a report is dropped. */
+  static constexpr uint32_t kBaseDelayMs = 100; /**< Delay before the first retry. */
+  static constexpr uint32_t kMaxDelayMs = 5000; /**< Upper bound of the doubling delay. */
+
+  /**
+   * @struct Stats
+   * @brief Counters of the queue.
+   */
+  struct Stats {
+    uint32_t queued;    /**< Failed reports queued for a retry. */
+    uint32_t coalesced; /**< Failed reports merged into a pending retry of the same path. */
+    uint32_t cancelled; /**< Pending retries superseded by a fresh report. */
+    uint32_t retried;   /**< Retries sent. */
+    uint32_t dropped;   /**< Reports given up. */
+    uint32_t depth;     /**< Current number of pending retries. */
+  };
+
+  /**
+   * @brief Get the queue shared by the device layer.
+   *
+   * @return ReportRetryQueue& The queue instance.
+   */
+  static ReportRetryQueue &instance();
+
+  /**
+   * @brief Queue a rejected attribute report for a retry.
+   *
+   * @param lane Lane of the report.
+   * @param endpointId Endpoint of the attribute.
+   * @param clusterId Cluster of the attribute.
+   * @param attributeId Attribute id.
+   * @param val Value of the report, copied.
+   * @param attempt Retries already made for the report.
+   * @param sequence Sequence of the fresh report the value comes from.
+   * @param err Error returned by the stack.
+   * @return esp_err_t ESP_ERR_NO_MEM if the queue is full, ESP_ERR_TIMEOUT if the report ran
+   * out of attempts. Both drop the report.
+   */
+  esp_err_t reportFailed(ReportLane lane, uint16_t endpointId, uint32_t clusterId, uint32_t attributeId,
+                         const esp_matter_attr_val_t *val, uint8_t attempt, uint32_t sequence, esp_err_t err);
+
+  /**
+   * @brief Cancel the pending retry of an attribute, because a fresher value is being reported.
+   *
+   * Costs a single atomic load while no retry is pending.
+   *
+   * @param endpointId Endpoint of the attribute.
+   * @param clusterId Cluster of the attribute.
+   * @param attributeId Attribute id.
+   */
+  void cancel(uint16_t endpointId, uint32_t clusterId, uint32_t attributeId);
+
+  /**
+   * @brief Send every retry that is due on the calling task.
+   *
+   * Used by the timer, and directly on the host to drive the queue deterministically.
+   *
+   * @return size_t Number of retries sent.
+   */
+  size_t retryDue();
+
+  /**
+   * @brief Get the delay before a retry.
+   *
+   * @param attempt Retries already made.
+   * @return uint32_t kBaseDelayMs doubled per attempt, at most kMaxDelayMs.
+   */
+  static uint32_t backoffMs(uint8_t attempt);
+
+  /**
+   * @brief Get the counters of the queue.
+   *
+   * @return Stats Copy of the counters.
+   */
+  Stats getStats();
+
+ private:
+  struct Entry {
+    bool used;                 /**< Whether the entry holds a pending retry. */
+    ReportLane lane;           /**< Lane of the report. */
+    uint8_t attempt;           /**< Retries already made. */
+    uint16_t endpointId;       /**< Endpoint of the attribute. */
+    uint32_t clusterId;        /**< Cluster of the attribute. */
+    uint32_t attributeId;      /**< Attribute id. */
+    esp_matter_attr_val_t val; /**< Latest value of the attribute. */
+    uint32_t sequence;         /**< Sequence of the fresh report the value comes from. */
+    uint64_t dueTick;          /**< Wheel tick of the retry. */
+  };
+
+  ReportRetryQueue();
+
+  /**
+   * @brief Schedule the timer for the earliest pending retry. Called with the mutex held.
+   */
+  void armTimer();
+
+  std::mutex mutex;            /**< Protects the entries and the counters. */
+  Entry entries[kCapacity];    /**< Pending retries, at most one per attribute path. */
+  std::atomic<size_t> pending; /**< Number of used entries, read without the mutex. */
+  TimerWheel::Timer timer;     /**< One-shot timer of the earliest retry. */
+  Stats stats;                 /**< Counters. */
+};
+
+#endif  // REPORT_RETRY_QUEUE_HPP
@@ -0,0 +1,324 @@
+#ifndef REPORT_SCHEDULER_HPP
+#define REPORT_SCHEDULER_HPP
+
+#include <esp_err.h>
+#include <esp_matter.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+/**
+ * @enum ReportLane
+ * @brief Priority lane of a report, highest priority first.
+ */
+enum class ReportLane : uint8_t {
+  Interactive = 0, /**< User-facing events such as switch presses. */
+  State = 1,       /**< State changes such as power or window stop positions. */
+  Telemetry = 2,   /**< Bulk telemetry such as metering or fade steps. */
+};
+
+/**
+ * @class ReportScheduler
+ * @brief Prioritized queue between the devices and the Matter reporting engine.
+ *
+ * Every lane has its own fixed queue, so a telemetry burst can never occupy the slots of
+ * a higher lane. A single worker drains the lanes by weighted round robin, always scanning
+ * from the highest lane; a lane with weight 0 is strict priority and is drained before any
+ * other lane is served. Attribute reports to the same path coalesce within a lane (the
+ * latest value wins), events never coalesce. If a lane is full the report is made
+ * synchronously instead of being dropped. Until start() is called every report is made
+ * synchronously. Attribute reports the stack rejects are handed to the ReportRetryQueue.
+ * Every fresh attribute report is stamped with a sequence number, and the latest one of the
+ * last kTrackedPaths paths is remembered: a retry carrying an older sequence than its path is
+ * dropped, so it can neither coalesce over nor be sent after a fresher value.
+ * A queued report whose path got a fresher report in the meantime is dropped when it is popped.
+ * reportAttributes() sends a batch synchronously under a single stack lock.
+ * A FlushWaiter is called back once every report queued before it registered has been sent.
+ */
+class ReportScheduler {
+ public:
+  static constexpr size_t kLanes = 3;         /**< Number of lanes. */
+  static constexpr size_t kQueueDepth = 32;   /**< Queue depth of each lane. */
+  static constexpr size_t kTrackedPaths = 64; /**< Paths whose latest fresh sequence is remembered. */
+
+  /**
+   * @brief Callback that sends an event from the worker.
+   *
+   * @param endpointId Endpoint of the event.
+   * @param arg Event argument.
+   */
+  typedef void (*EventCallback)(uint16_t endpointId, uint32_t arg);
+
+  /**
+   * @brief Callback invoked when the reports a FlushWaiter waits for have been sent.
+   *
+   * @param context Context registered with notifyFlushed().
+   */
+  typedef void (*FlushCallback)(void *context);
+
+  /**
+   * @class FlushWaiter
+   * @brief Caller-owned registration of notifyFlushed(). Must stay alive and in place while
+   * it is registered.
+   */
+  class FlushWaiter {
+   public:
+    FlushWaiter();
+
+    FlushWaiter(const FlushWaiter &) = delete;
+    FlushWaiter &operator=(const FlushWaiter &) = delete;
+
+   private:
+    friend class ReportScheduler;
+
+    FlushWaiter *next;       /**< Next registered waiter. */
+    uint64_t target[kLanes]; /**< Reports of each lane that must be sent. */
+    FlushCallback callback;  /**< Flush callback. */
+    void *context;           /**< Callback context. */
+    bool registered;         /**< Whether the waiter is in the list. */
+  };
+
+  /**
+   * @struct AttributeReport
+   * @brief One attribute of a reportAttributes() batch.
+   */
+  struct AttributeReport {
+    uint16_t endpointId;       /**< Endpoint of the attribute. */
+    uint32_t clusterId;        /**< Cluster of the attribute. */
+    uint32_t attributeId;      /**< Attribute id. */
+    esp_matter_attr_val_t val; /**< New attribute value. */
+  };
+
+  /**
+   * @struct LaneStats
+   * @brief Counters of one lane.
+   */
+  struct LaneStats {
+    uint32_t enqueued;       /**< Reports queued. */
+    uint32_t dispatched;     /**< Reports sent to the stack. */
+    uint32_t coalesced;      /**< Reports merged into a pending report of the same path. */
+    uint32_t overflowed;     /**< Reports sent synchronously because the lane was full. */
+    uint32_t failed;         /**< Reports the stack rejected. */
+    uint32_t superseded;     /**< Retries dropped because a fresher report of the path was made. */
+    uint32_t depth;          /**< Current queue depth. */
+    uint32_t maxDepth;       /**< Highest queue depth seen. */
+    uint64_t totalLatencyUs; /**< Sum of queueing latencies of dispatched reports. */
+    uint32_t maxLatencyUs;   /**< Highest queueing latency seen. */
+  };
+
+  /**
+   * @brief Get the scheduler shared by the device layer.
+   *
+   * @return ReportScheduler& The scheduler instance.
+   */
+  static ReportScheduler &instance();
+
+  /**
+   * @brief Start the worker that drains the lanes.
+   *
+   * @return esp_err_t ESP_ERR_INVALID_STATE if already running.
+   */
+  esp_err_t start();
+
+  /**
+   * @brief Stop the worker after draining every lane.
+   *
+   * Waits for the worker, unless called from a report running on the worker itself, which
+   * then drains the lanes and ends once the report returns.
+   */
+  void stop();
+
+  /**
+   * @brief Check whether reports are queued or made synchronously.
+   *
+   * @return bool true while the worker runs.
+   */
+  bool isRunning();
+
+  /**
+   * @brief Set the weight of a lane.
+   *
+   * @param lane Lane to configure.
+   * @param weight Reports served per round, 0 for strict priority. Defaults are 0, 4 and 1.
+   */
+  void setWeight(ReportLane lane, uint8_t weight);
+
+  /**
+   * @brief Queue an attribute report.
+   *
+   * @param lane Lane of the report.
+   * @param endpointId Endpoint of the attribute.
+   * @param clusterId Cluster of the attribute.
+   * @param attributeId Attribute id.
+   * @param val New attribute value, copied. String and array values are rejected, the copy would
+   * only hold the caller's buffer.
+   * @param attempt Retries already made, 0 for a fresh report, which cancels the pending retry
+   * of the attribute.
+   * @param sequence Sequence of the fresh report a retry comes from, ignored for a fresh report,
+   * which gets a new one.
+   * @return esp_err_t ESP_OK once queued or dropped as superseded, ESP_ERR_NOT_SUPPORTED for a
+   * string or array value, or the result of the synchronous report.
+   */
+  esp_err_t reportAttribute(ReportLane lane, uint16_t endpointId, uint32_t clusterId, uint32_t attributeId,
+                            const esp_matter_attr_val_t *val, uint8_t attempt = 0, uint32_t sequence = 0);
+
+  /**
+   * @brief Report several attributes under a single stack lock.
+   *
+   * The batch is sent on the calling task, bypassing the lane queue, so every path reaches the
+   * stack together. Every report is fresh: it cancels the pending retry of its path and
+   * supersedes the reports of the path still queued. A rejected report is handed to the
+   * ReportRetryQueue and the other reports are still sent.
+   *
+   * @param lane Lane the reports are counted on and retried in.
+   * @param reports Reports to send.
+   * @param count Number of reports.
+   * @return esp_err_t ESP_ERR_NOT_SUPPORTED if a value is a string or array, nothing is sent then,
+   * or the first error of the stack.
+   */
+  esp_err_t reportAttributes(ReportLane lane, const AttributeReport *reports, size_t count);
+
+  /**
+   * @brief Compare two report sequences, wrap-around safe.
+   *
+   * @param sequence Sequence to test.
+   * @param than Sequence to compare with.
+   * @return bool true if sequence was stamped after than.
+   */
+  static bool isNewer(uint32_t sequence, uint32_t than);
+
+  /**
+   * @brief Queue an event.
+   *
+   * @param lane Lane of the event.
+   * @param callback Callback that sends the event, called with the stack lock held.
+   * @param endpointId Endpoint of the event.
+   * @param arg Event argument.
+   * @return esp_err_t ESP_OK once queued or sent.
+   */
+  esp_err_t sendEvent(ReportLane lane, EventCallback callback, uint16_t endpointId, uint32_t arg);
+
+  /**
+   * @brief Call back once every report queued so far has been sent.
+   *
+   * The callback runs on the worker, or the task calling dispatch(), and must not call back
+   * into the scheduler.
+   *
+   * @param waiter Registration, must not be registered yet.
+   * @param callback Flush callback.
+   * @param context Callback context.
+   * @return bool false if nothing is queued; the waiter is then not registered and the
+   * callback is not invoked.
+   */
+  bool notifyFlushed(FlushWaiter &waiter, FlushCallback callback, void *context);
+
+  /**
+   * @brief Remove a registration. Once this returns the callback is not running and will not
+   * be invoked. Cancelling a waiter that is not registered is a no-op.
+   *
+   * @param waiter Registration.
+   */
+  void cancelFlushed(FlushWaiter &waiter);
+
+  /**
+   * @brief Dispatch queued reports on the calling task.
+   *
+   * Used by the worker, and directly on the host to drain the lanes deterministically.
+   *
+   * @param maxReports Maximum number of reports to dispatch.
+   * @return size_t Number of reports dispatched.
+   */
+  size_t dispatch(size_t maxReports);
+
+  /**
+   * @brief Get the counters of a lane.
+   *
+   * @param lane Lane to read.
+   * @return LaneStats Copy of the counters.
+   */
+  LaneStats getStats(ReportLane lane);
+
+  /**
+   * @brief Reset the counters of every lane, except the current depths.
+   */
+  void resetStats();
+
+ private:
+  struct Report {
+    EventCallback event;       /**< Event callback, nullptr for an attribute report. */
+    uint16_t endpointId;       /**< Endpoint of the report. */
+    uint32_t clusterId;        /**< Cluster of an attribute report. */
+    uint32_t attributeId;      /**< Attribute of an attribute report, or the event argument. */
+    esp_matter_attr_val_t val; /**< Value of an attribute report. */
+    uint8_t attempt;           /**< Retries already made for an attribute report. */
+    uint32_t sequence;         /**< Sequence of the fresh report the value comes from. */
+    int64_t enqueuedUs;        /**< Time the report was queued. */
+  };
+
+  struct TrackedPath {
+    uint16_t endpointId;  /**< Endpoint of the attribute. */
+    uint32_t clusterId;   /**< Cluster of the attribute. */
+    uint32_t attributeId; /**< Attribute id. */
+    uint32_t sequence;    /**< Sequence of the latest fresh report, 0 for an unused slot. */
+  };
+
+  struct Lane {
+    Report queue[kQueueDepth]; /**< Ring of pending reports. */
+    size_t head;               /**< Index of the oldest report. */
+    size_t count;              /**< Number of pending reports. */
+    uint8_t weight;            /**< Reports per round, 0 for strict priority. */
+    uint8_t credits;           /**< Reports left in the current round. */
+    uint64_t pushed;           /**< Reports ever queued in the ring. */
+    uint64_t sent;             /**< Reports of the ring sent so far. */
+    LaneStats stats;           /**< Counters. */
+  };
+
+  ReportScheduler();
+
+  static int64_t nowUs();
+
+  esp_err_t enqueue(ReportLane lane, const Report &report);
+
+  /**
+   * @brief Stamp a fresh report and remember it as the latest of its path. Called with laneMutex held.
+   *
+   * @return uint32_t Sequence of the report.
+   */
+  uint32_t stampFresh(const Report &report);
+
+  /**
+   * @brief Check whether a fresher report of the path was made. Called with laneMutex held.
+   *
+   * @return bool true if the retry is stale. An untracked path is never stale.
+   */
+  bool isSuperseded(const Report &report) const;
+
+  /**
+   * @brief Pop the next report to send, dropping superseded attribute reports. Called with laneMutex held.
+   *
+   * @return bool false if every lane is empty.
+   */
+  bool popNext(Report &report, size_t &laneIndex);
+  esp_err_t send(Report &report, size_t laneIndex);
+  void run();
+
+  /**
+   * @brief Invoke the waiters whose reports have all been sent.
+   */
+  void completeFlushWaiters();
+
+  std::mutex flushMutex;              /**< Held while flush callbacks run, taken before laneMutex. */
+  std::mutex laneMutex;               /**< Protects the lanes and the flush waiters. */
+  FlushWaiter *flushWaiters;          /**< Registered flush waiters. */
+  std::condition_variable pending;    /**< Signalled when a report is queued or on stop. */
+  Lane lanes[kLanes];                 /**< Priority lanes. */
+  TrackedPath tracked[kTrackedPaths]; /**< Latest fresh sequence of recently reported paths. */
+  uint32_t lastSequence;              /**< Sequence of the latest fresh report. */
+  bool running;                       /**< Whether the worker runs. */
+  std::thread worker;                 /**< Worker draining the lanes. */
+};
+
+#endif  // REPORT_SCHEDULER_HPP
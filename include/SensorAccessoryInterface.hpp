@@ -0,0 +1,43 @@
+#ifndef SENSOR_ACCESSORY_INTERFACE_HPP
+#define SENSOR_ACCESSORY_INTERFACE_HPP
+
+#include <cstdint>
+
+/**
+ * @class SensorAccessoryInterface
+ * @brief Interface for a measuring accessory such as a temperature, humidity or occupancy sensor.
+ *
+ * Samples are integers in the unit of the Matter attribute: 1/100 degree Celsius for
+ * temperature, 1/100 percent for relative humidity, and 0 or 1 for occupancy.
+ */
+class SensorAccessoryInterface {
+ public:
+  /**
+   * @brief Virtual destructor for SensorAccessoryInterface.
+   */
+  virtual ~SensorAccessoryInterface() = default;
+
+  /**
+   * @brief Read one raw sample from the sensor.
+   *
+   * @param value Sample to fill.
+   * @return bool true if a sample was read.
+   */
+  virtual bool readSample(int32_t &value) = 0;
+
+  /**
+   * @brief Set the callback invoked when the sensor has a new sample outside the sampling
+   * period, e.g. on a motion interrupt.
+   *
+   * @param callback Callback function.
+   * @param context Context passed to the callback.
+   */
+  virtual void setReportAppCallback(void (*callback)(void *), void *context) = 0;
+
+  /**
+   * @brief Identify the accessory.
+   */
+  virtual void identifyYourSelf() = 0;
+};
+
+#endif  // SENSOR_ACCESSORY_INTERFACE_HPP
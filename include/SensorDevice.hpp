@@ -0,0 +1,176 @@
+#ifndef SENSOR_DEVICE_HPP
+#define SENSOR_DEVICE_HPP
+
+#include <esp_err.h>
+#include <esp_matter.h>
+
+#include <BaseDevice.hpp>
+#include <DeviceName.hpp>
+#include <SensorAccessoryInterface.hpp>
+#include <SensorFilter.hpp>
+#include <SeqLock.hpp>
+#include <TimerWheel.hpp>
+#include <cstdint>
+
+/**
+ * @class SensorDevice
+ * @brief This class represents a temperature, humidity or occupancy sensor, inheriting from the
+ * BaseDevice class.
+ *
+ * Samples read from the accessory go through a SensorFilter, and the measured value is only
+ * reported when the filtered value moved past the reporting threshold or the maximum interval
+ * expired. Sampling at the sensor rate therefore costs no reporting engine work in between.
+ * The default filter of each sensor type is taken from DeviceConfig.
+ */
+class SensorDevice : public BaseDevice {
+ public:
+  /**
+   * @enum SensorType
+   * @brief Measurement provided by the sensor.
+   */
+  enum class SensorType : uint8_t {
+    Temperature, /**< temperature_sensor endpoint, MeasuredValue in 1/100 degree Celsius. */
+    Humidity,    /**< humidity_sensor endpoint, MeasuredValue in 1/100 percent. */
+    Occupancy,   /**< occupancy_sensor endpoint, Occupancy bit 0. */
+  };
+
+  /**
+   * @struct State
+   * @brief Endpoint state mirrored in the state shadow.
+   */
+  struct State {
+    bool valid;    /**< Whether a value was reported yet. */
+    int32_t value; /**< Last reported filtered value, in the attribute unit. */
+  };
+
+  /**
+   * @brief Constructor for SensorDevice.
+   *
+   * @param device_name The name of the device, copied unless passed as a BorrowedName.
+   * @param accessory The sensor accessory. Default is nullptr.
+   * @param aggregator The endpoint aggregator. Default is nullptr.
+   * @param sensorType Measurement of the sensor. Default is SensorType::Temperature.
+   *
+   * @details If an aggregator is provided, it creates a bridged node endpoint with the specified name.
+   * If no aggregator is provided, it creates a standalone endpoint. Sampling only starts with
+   * startSampling() or when the accessory invokes its report callback.
+   */
+  SensorDevice(DeviceName device_name = nullptr, SensorAccessoryInterface *accessory = nullptr,
+               esp_matter::endpoint_t *aggregator = nullptr, SensorType sensorType = SensorType::Temperature);
+
+  /**
+   * @brief Destructor for SensorDevice, stops sampling.
+   */
+  ~SensorDevice();
+
+  /**
+   * @brief Update the accessory state.
+   *
+   * Sensors have no writable state, so this does nothing.
+   *
+   * @return esp_err_t ESP_OK.
+   */
+  esp_err_t updateAccessory() override;
+
+  /**
+   * @brief Read a sample outside the sampling period, invoked by the accessory callback.
+   *
+   * The sample is taken on the device TimerWheel, so the filter is only used from one task.
+   *
+   * @return esp_err_t ESP_OK.
+   */
+  esp_err_t reportEndpoint() override;
+
+  /**
+   * @brief Identify the accessory.
+   *
+   * @return esp_err_t Error code indicating success or failure.
+   */
+  esp_err_t identify() override;
+
+  /**
+   * @brief Write the cached state of the device into one snapshot row.
+   *
+   * @param snapshot Snapshot buffers to fill.
+   * @param index Row of this device.
+   */
+  void fillSnapshot(DeviceSnapshot &snapshot, size_t index) const override;
+
+  /**
+   * @brief Write the endpoint ids owned by the device.
+   *
+   * @param endpointIds Buffer receiving the endpoint ids.
+   * @param capacity Number of ids the buffer can hold.
+   * @return size_t Number of ids written.
+   */
+  size_t getEndpointIds(uint16_t *endpointIds, size_t capacity) const override;
+
+  /**
+   * @brief Read one sample from the accessory and run it through the filter.
+   *
+   * The measured value is only reported when the filter says so. Call this at the sensor rate.
+   *
+   * @param nowMs Current time in milliseconds.
+   * @return esp_err_t ESP_FAIL if the read failed, or the error of a due report.
+   */
+  esp_err_t sample(uint32_t nowMs);
+
+  /**
+   * @brief Sample the accessory periodically from the device TimerWheel.
+   *
+   * @param intervalMs Sampling interval in milliseconds.
+   * @return esp_err_t Error code indicating success or failure.
+   */
+  esp_err_t startSampling(uint32_t intervalMs);
+
+  /**
+   * @brief Stop the periodic sampling started by startSampling(), waiting for a running sample.
+   */
+  void stopSampling();
+
+  /**
+   * @brief Replace the filter and reporting configuration, safe from any task.
+   *
+   * The configuration is applied on the device TimerWheel before the next sample.
+   *
+   * @param config New configuration.
+   */
+  void setFilterConfig(const SensorFilter::Config &config);
+
+  /**
+   * @brief Get the measurement of the sensor.
+   *
+   * @return SensorType Sensor type given to the constructor.
+   */
+  SensorType getSensorType() const;
+
+  /**
+   * @brief Read the endpoint state from any task without the stack lock.
+   *
+   * @return State Consistent copy of the state shadow.
+   */
+  State getState() const;
+
+ private:
+  esp_err_t setEndpointMeasuredValue(int32_t value);
+
+  /**
+   * @brief Store the reported value in the shadow and publish it to the state stream.
+   *
+   * @param value Reported filtered value.
+   */
+  void cacheValue(int32_t value);
+
+  esp_matter::endpoint_t *endpoint;                  /**< Pointer to the esp_matter endpoint. */
+  SensorAccessoryInterface *accessory;               /**< Pointer to the sensor accessory. */
+  DeviceName name;                                   /**< Name of the device, copied or borrowed. */
+  SensorType sensorType;                             /**< Measurement of the sensor. */
+  SeqLock<State> shadow;                             /**< Endpoint state readable from any task. */
+  SensorFilter filter;                               /**< Filter of the raw samples, only used on the wheel. */
+  SeqLock<SensorFilter::Config> pendingFilterConfig; /**< Configuration handed to the wheel. */
+  TimerWheel::Timer sampleTimer;                     /**< Periodic sampling timer. */
+  TimerWheel::Timer wakeTimer;                       /**< One-shot timer of the samples pushed by the accessory. */
+  TimerWheel::Timer configTimer;                     /**< One-shot timer applying the pending filter configuration. */
+};
+
+#endif  // SENSOR_DEVICE_HPP
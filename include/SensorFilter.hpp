@@ -0,0 +1,110 @@
+#ifndef SENSOR_FILTER_HPP
+#define SENSOR_FILTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class SensorFilter
+ * @brief Fixed-point filter pipeline for sensor samples, and the decision when to report them.
+ *
+ * Raw samples are decimated by averaging every `decimation` of them into one, smoothed by a
+ * moving average over the last `averageLength` decimated samples, and passed through a dead
+ * band of `hysteresis` so that noise around a value does not move the output. Values are
+ * integers in the unit of the reported attribute (e.g. 1/100 degree), so no floating point
+ * is used. A report is due when the output moved by at least `reportDelta` since the last
+ * report or when the maximum interval expired, but never before the minimum interval.
+ */
+class SensorFilter {
+ public:
+  static constexpr size_t kMaxAverageLength = 16; /**< Maximum length of the moving average. */
+
+  /**
+   * @struct Config
+   * @brief Filter and reporting configuration.
+   */
+  struct Config {
+    uint8_t decimation = 4;          /**< Raw samples averaged into one decimated sample, at least 1. */
+    uint8_t averageLength = 8;       /**< Decimated samples in the moving average, 1 to kMaxAverageLength. */
+    int32_t hysteresis = 0;          /**< Change of the average that is ignored. */
+    int32_t reportDelta = 1;         /**< Change of the output since the last report that triggers one. */
+    uint32_t minIntervalMs = 1000;   /**< Minimum time between two reports. */
+    uint32_t maxIntervalMs = 300000; /**< Maximum time between two reports. */
+  };
+
+  /**
+   * @brief Constructor for SensorFilter with the default configuration.
+   */
+  SensorFilter();
+
+  /**
+   * @brief Constructor for SensorFilter.
+   *
+   * @param config Filter and reporting configuration.
+   */
+  explicit SensorFilter(const Config &config);
+
+  /**
+   * @brief Add one raw sample to the pipeline.
+   *
+   * @param raw Raw sample in the unit of the output.
+   * @return bool true if the output changed.
+   */
+  bool addSample(int32_t raw);
+
+  /**
+   * @brief Check whether the pipeline produced an output yet.
+   *
+   * @return bool true once the first decimated sample went through.
+   */
+  bool hasValue() const;
+
+  /**
+   * @brief Get the filtered output.
+   *
+   * @return int32_t Output of the pipeline, 0 before the first one.
+   */
+  int32_t value() const;
+
+  /**
+   * @brief Check whether the output should be reported.
+   *
+   * @param nowMs Current time in milliseconds.
+   * @return bool true if a report is due.
+   */
+  bool reportDue(uint32_t nowMs) const;
+
+  /**
+   * @brief Remember the output that was just reported.
+   *
+   * @param nowMs Current time in milliseconds.
+   */
+  void markReported(uint32_t nowMs);
+
+  /**
+   * @brief Replace the configuration and restart the pipeline.
+   *
+   * The last reported value is kept, so a new configuration does not force a report.
+   *
+   * @param config New configuration, out of range lengths are clamped.
+   */
+  void setConfig(const Config &config);
+
+ private:
+  void reset();
+
+  Config config;
+  int64_t decimationSum;              /**< Sum of the raw samples of the current decimation. */
+  uint8_t decimationCount;            /**< Raw samples in decimationSum. */
+  int32_t average[kMaxAverageLength]; /**< Ring of the latest decimated samples. */
+  int64_t averageSum;                 /**< Sum of the ring. */
+  uint8_t averageNext;                /**< Ring slot of the next decimated sample. */
+  uint8_t averageCount;               /**< Number of valid samples in the ring. */
+  bool hasOutput;                     /**< Whether output is valid. */
+  int32_t output;                     /**< Output after the hysteresis. */
+  bool hasReported;                   /**< Whether a report was made yet. */
+  uint32_t lastReportMs;              /**< Time of the last report. */
+  int32_t lastReportedValue;          /**< Output at the last report. */
+};
+
+#endif  // SENSOR_FILTER_HPP
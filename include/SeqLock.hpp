@@ -0,0 +1,128 @@
+#ifndef SEQ_LOCK_HPP
+#define SEQ_LOCK_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+/**
+ * @class SeqLock
+ * @brief Sequence lock around a small trivially copyable value.
+ *
+ * Readers do not block and never write shared memory: they copy the value and retry if a
+ * writer was active meanwhile. Writers serialize on a mutex, which lends its owner the
+ * priority of a waiter. A reader that keeps colliding with writers, for instance because it
+ * preempted one, falls back to that mutex after kReadSpins attempts instead of spinning. The
+ * value is held in atomic words so that a torn copy, which the retry discards, is not a data race.
+ *
+ * @tparam T Trivially copyable value type, kept small since readers copy it whole.
+ */
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value, "SeqLock requires a trivially copyable type");
+
+ public:
+  static constexpr unsigned kReadSpins = 64; /**< Lock-free read attempts before waiting for the writer. */
+
+  /**
+   * @brief Constructor for SeqLock.
+   *
+   * @param initial Initial value.
+   */
+  explicit SeqLock(const T &initial = T()) : sequence(0) { storeWords(initial); }
+
+  SeqLock(const SeqLock &) = delete;
+  SeqLock &operator=(const SeqLock &) = delete;
+
+  /**
+   * @brief Read a consistent copy of the value from any task.
+   *
+   * @return T Copy of the value.
+   */
+  T read() const {
+    T value;
+    for (unsigned spin = 0; spin < kReadSpins; spin++) {
+      uint32_t before = sequence.load(std::memory_order_acquire);
+      if (before & 1) {
+        continue;
+      }
+      loadWords(value);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence.load(std::memory_order_relaxed) == before) {
+        return value;
+      }
+    }
+
+    // The writer may be preempted by this task, wait for it on its lock instead of spinning
+    std::lock_guard<std::mutex> guard(writeMutex);
+    loadWords(value);
+    return value;
+  }
+
+  /**
+   * @brief Replace the value.
+   *
+   * @param value New value.
+   */
+  void write(const T &value) {
+    std::lock_guard<std::mutex> guard(writeMutex);
+    beginWrite();
+    storeWords(value);
+    endWrite();
+  }
+
+  /**
+   * @brief Modify the value in place, atomically with respect to other writers.
+   *
+   * @param modifier Callable taking a T& that edits the value.
+   * @return T The value before the modification.
+   */
+  template <typename Modifier>
+  T modify(Modifier modifier) {
+    std::lock_guard<std::mutex> guard(writeMutex);
+    beginWrite();
+    T previous;
+    loadWords(previous);
+    T value = previous;
+    modifier(value);
+    storeWords(value);
+    endWrite();
+    return previous;
+  }
+
+ private:
+  static constexpr size_t kWords = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+  // Called with writeMutex held, so the counter has a single writer
+  void beginWrite() {
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  void endWrite() { sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+  void loadWords(T &value) const {
+    uint32_t buffer[kWords];
+    for (size_t i = 0; i < kWords; i++) {
+      buffer[i] = words[i].load(std::memory_order_relaxed);
+    }
+    std::memcpy(&value, buffer, sizeof(T));
+  }
+
+  void storeWords(const T &value) {
+    uint32_t buffer[kWords] = {};
+    std::memcpy(buffer, &value, sizeof(T));
+    for (size_t i = 0; i < kWords; i++) {
+      words[i].store(buffer[i], std::memory_order_relaxed);
+    }
+  }
+
+  mutable std::mutex writeMutex;       /**< Serializes the writers, taken by readers that keep colliding. */
+  std::atomic<uint32_t> sequence;      /**< Odd while a writer is active. */
+  std::atomic<uint32_t> words[kWords]; /**< The value, word by word. */
+};
+
+#endif  // SEQ_LOCK_HPP
@@ -0,0 +1,172 @@
+#ifndef STATE_STREAM_HPP
+#define STATE_STREAM_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @enum StateChangeKind
+ * @brief Kind of state change carried by a state stream record.
+ */
+enum class StateChangeKind : uint8_t {
+  Power = 1,                 /**< Power flip, value is 0 or 1. */
+  FanPercent = 2,            /**< Fan percent current, value is 0-100. */
+  WindowCurrentPosition = 3, /**< Window current position, value is 0-100. */
+  WindowTargetPosition = 4,  /**< Window target position, value is 0-100. */
+  ButtonPress = 5,           /**< Button press event, value is the PressType. */
+  Level = 6,                 /**< Light level, value is 0-254. */
+  SensorValue = 7,           /**< Filtered sensor value in the attribute unit. */
+};
+
+/**
+ * @class StateStreamRing
+ * @brief Single-producer single-consumer ring of fixed-size records over a caller buffer.
+ *
+ * Every record occupies exactly kRecordSize bytes and never wraps, so a consumer can
+ * hand the pointer returned by peek() straight to a UART or socket write and release()
+ * the slot afterwards, without copying.
+ */
+class StateStreamRing {
+ public:
+  static constexpr size_t kRecordSize = 16; /**< Size of one record slot in bytes. */
+
+  /**
+   * @brief Constructor for StateStreamRing.
+   *
+   * @param buffer Caller-owned storage, must outlive the ring.
+   * @param size Size of the storage in bytes. Only whole slots are used.
+   */
+  StateStreamRing(uint8_t *buffer, size_t size);
+
+  /**
+   * @brief Get the next free slot for the producer.
+   *
+   * @return uint8_t* Slot to write, or nullptr if the ring is full.
+   */
+  uint8_t *acquire();
+
+  /**
+   * @brief Publish the slot returned by acquire().
+   */
+  void commit();
+
+  /**
+   * @brief Get the oldest unread record for the consumer.
+   *
+   * @return const uint8_t* Record of kRecordSize bytes, or nullptr if the ring is empty.
+   */
+  const uint8_t *peek() const;
+
+  /**
+   * @brief Free the record returned by peek().
+   */
+  void release();
+
+  /**
+   * @brief Get the number of records waiting for the consumer.
+   *
+   * @return size_t Number of records.
+   */
+  size_t pending() const;
+
+ private:
+  uint8_t *buffer;            /**< Caller-owned storage. */
+  size_t slots;               /**< Number of record slots in the storage. */
+  std::atomic<uint32_t> head; /**< Records written by the producer. */
+  std::atomic<uint32_t> tail; /**< Records released by the consumer. */
+};
+
+/**
+ * @class StateStreamEncoder
+ * @brief Encodes device state changes into a StateStreamRing.
+ *
+ * A record is a length byte, a kind byte and three varints: the sequence delta, the
+ * endpoint id and the zigzag value. The value is a delta against the last value written
+ * for the same endpoint and kind when that one is tracked, otherwise it is absolute and
+ * the kind byte carries kAbsoluteFlag. When the ring is full the record is dropped; the
+ * sequence delta of the next record tells the decoder how many were lost, and dropped
+ * values never become a delta base, so the decoder stays in sync.
+ *
+ * Every key is sent absolute again after kKeyframeInterval deltas, and every key after
+ * resync(), so a decoder that attached late or lost records recovers. Deltas it has no
+ * base for are skipped until then. When more keys change than are tracked, the least
+ * recently changed key is evicted and goes absolute on its next change.
+ * tools/decode_state_stream.py decodes the stream on the host.
+ */
+class StateStreamEncoder {
+ public:
+  static constexpr uint8_t kAbsoluteFlag = 0x80;   /**< Kind byte flag for absolute values. */
+  static constexpr size_t kTrackedKeys = 32;       /**< Number of endpoint/kind pairs kept for deltas. */
+  static constexpr uint8_t kKeyframeInterval = 16; /**< Deltas per key between two absolute values. */
+
+  /**
+   * @brief Constructor for StateStreamEncoder.
+   *
+   * @param ring Ring the records are written into.
+   */
+  explicit StateStreamEncoder(StateStreamRing &ring);
+
+  /**
+   * @brief Encode one state change. Safe to call from several tasks.
+   *
+   * @param endpointId Endpoint that changed.
+   * @param kind Kind of change.
+   * @param value New value.
+   * @return true if the record was written, false if the ring was full.
+   */
+  bool publish(uint16_t endpointId, StateChangeKind kind, int32_t value);
+
+  /**
+   * @brief Send the next change of every key as an absolute value.
+   *
+   * Called when a consumer attaches, to start a new epoch the decoder can sync on.
+   */
+  void resync();
+
+  /**
+   * @brief Get the number of records dropped because the ring was full.
+   *
+   * @return uint32_t Number of dropped records.
+   */
+  uint32_t droppedRecords() const;
+
+  /**
+   * @brief Install the encoder used by devices, or nullptr to disable the stream.
+   *
+   * Starts a new epoch with resync().
+   *
+   * @param encoder Encoder to install.
+   */
+  static void install(StateStreamEncoder *encoder);
+
+  /**
+   * @brief Publish a change through the installed encoder, if any.
+   *
+   * @param endpointId Endpoint that changed.
+   * @param kind Kind of change.
+   * @param value New value.
+   */
+  static void emit(uint16_t endpointId, StateChangeKind kind, int32_t value);
+
+ private:
+  struct TrackedKey {
+    uint16_t endpointId;
+    uint8_t kind;     /**< 0 when the entry is free. */
+    uint8_t deltas;   /**< Deltas sent since the last absolute value. */
+    int32_t value;    /**< Last value written, the delta base. */
+    uint32_t lastUse; /**< Sequence number of the last change, for eviction. */
+  };
+
+  StateStreamRing &ring;
+  std::mutex producerMutex;
+  TrackedKey tracked[kTrackedKeys];
+  uint32_t sequence;        /**< Sequence number of the last published change. */
+  uint32_t writtenSequence; /**< Sequence number of the last record written to the ring. */
+  std::atomic<uint32_t> dropped;
+
+  static std::atomic<StateStreamEncoder *> installed;
+};
+
+#endif  // STATE_STREAM_HPP
@@ -0,0 +1,135 @@
+#ifndef SUBSCRIPTION_TRACKER_HPP
+#define SUBSCRIPTION_TRACKER_HPP
+
+#include <esp_err.h>
+
+#include <TimerWheel.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @class SubscriptionEventSource
+ * @brief Source of subscription events, implemented on top of the stack's read handlers.
+ *
+ * Kept as an interface so the tracker can be fed by a mock on the host.
+ */
+class SubscriptionEventSource {
+ public:
+  /**
+   * @brief Listener invoked for every subscribed or unsubscribed path.
+   *
+   * @param context Context registered with setListener().
+   * @param endpointId Endpoint of the path, SubscriptionTracker::kAnyEndpoint for a wildcard.
+   * @param clusterId Cluster of the path, SubscriptionTracker::kAnyCluster for a wildcard.
+   * @param subscribed true when the subscription was established, false when it ended.
+   */
+  typedef void (*Listener)(void *context, uint16_t endpointId, uint32_t clusterId, bool subscribed);
+
+  /**
+   * @brief Virtual destructor for SubscriptionEventSource.
+   */
+  virtual ~SubscriptionEventSource() = default;
+
+  /**
+   * @brief Register the listener that receives the subscription events.
+   *
+   * @param listener Listener function.
+   * @param context Context passed to the listener.
+   * @return esp_err_t Error code indicating success or failure.
+   */
+  virtual esp_err_t setListener(Listener listener, void *context) = 0;
+};
+
+/**
+ * @class SubscriptionTracker
+ * @brief Tracks which endpoint/cluster pairs have at least one active subscriber.
+ *
+ * Until a SubscriptionEventSource is attached every path counts as watched, so devices
+ * report exactly as before. Once attached, devices skip the reporting engine for paths
+ * nobody subscribed to (the attribute store is still updated so reads stay correct) and
+ * the deferred devices are flushed from the device TimerWheel when a subscription arrives.
+ * The flush collects the deferred devices under the registry lock and reports them after
+ * releasing it, holding only the stack lock, which keeps the stack -> registry lock order.
+ * When the fixed interest table overflows, every path counts as watched again.
+ */
+class SubscriptionTracker {
+ public:
+  static constexpr uint16_t kAnyEndpoint = 0xFFFF;    /**< Wildcard endpoint id. */
+  static constexpr uint32_t kAnyCluster = 0xFFFFFFFF; /**< Wildcard cluster id. */
+  static constexpr size_t kMaxInterests = 64;         /**< Number of distinct subscribed paths. */
+  static constexpr size_t kFlushBatch = 32;           /**< Deferred devices reported per flush. */
+
+  /**
+   * @brief Get the tracker shared by the device layer.
+   *
+   * @return SubscriptionTracker& The tracker instance.
+   */
+  static SubscriptionTracker &instance();
+
+  /**
+   * @brief Start tracking the events of a source.
+   *
+   * @param source Subscription event source.
+   * @return esp_err_t Error code of SubscriptionEventSource::setListener().
+   */
+  esp_err_t attach(SubscriptionEventSource &source);
+
+  /**
+   * @brief Record a new subscriber for a path and schedule a flush of deferred reports.
+   *
+   * @param endpointId Endpoint id or kAnyEndpoint.
+   * @param clusterId Cluster id or kAnyCluster.
+   */
+  void subscribed(uint16_t endpointId, uint32_t clusterId);
+
+  /**
+   * @brief Record that a subscriber of a path went away.
+   *
+   * @param endpointId Endpoint id or kAnyEndpoint.
+   * @param clusterId Cluster id or kAnyCluster.
+   */
+  void unsubscribed(uint16_t endpointId, uint32_t clusterId);
+
+  /**
+   * @brief Check whether a path has at least one subscriber.
+   *
+   * @param endpointId Endpoint id.
+   * @param clusterId Cluster id.
+   * @return bool true if changes of the path must go through the reporting engine.
+   */
+  bool hasInterest(uint16_t endpointId, uint32_t clusterId);
+
+  /**
+   * @brief Count a report that was deferred because nobody watched its path.
+   */
+  void countDeferred();
+
+  /**
+   * @brief Get the number of reports deferred so far.
+   *
+   * @return uint32_t Number of deferred reports.
+   */
+  uint32_t deferredReports() const;
+
+ private:
+  struct Interest {
+    uint16_t endpointId; /**< Endpoint id or kAnyEndpoint. */
+    uint32_t clusterId;  /**< Cluster id or kAnyCluster. */
+    uint16_t count;      /**< Number of subscribers, 0 when the entry is free. */
+  };
+
+  SubscriptionTracker();
+
+  static void flushDeferred(void *context);
+
+  std::mutex interestMutex;          /**< Protects the interest table. */
+  Interest interests[kMaxInterests]; /**< Subscribed paths. */
+  bool attached;                     /**< Whether an event source feeds the tracker. */
+  uint32_t overflow;                 /**< Subscriptions that did not fit in the table. */
+  std::atomic<uint32_t> deferred;    /**< Number of deferred reports. */
+  TimerWheel::Timer flushTimer;      /**< One-shot timer flushing deferred devices. */
+};
+
+#endif  // SUBSCRIPTION_TRACKER_HPP
@@ -0,0 +1,32 @@
+#ifndef TICK_SOURCE_HPP
+#define TICK_SOURCE_HPP
+
+#include <esp_err.h>
+
+/**
+ * @class TickSource
+ * @brief Drives a TimerWheel. Exactly one tick source should drive a wheel.
+ *
+ * On the device use an EspTimerTickSource, on the host a HostTickSource.
+ */
+class TickSource {
+ public:
+  /**
+   * @brief Virtual destructor for TickSource.
+   */
+  virtual ~TickSource() = default;
+
+  /**
+   * @brief Start ticking the wheel.
+   *
+   * @return esp_err_t Error code indicating success or failure.
+   */
+  virtual esp_err_t start() = 0;
+
+  /**
+   * @brief Stop ticking the wheel.
+   */
+  virtual void stop() = 0;
+};
+
+#endif  // TICK_SOURCE_HPP
@@ -0,0 +1,159 @@
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+/**
+ * @class TimerWheel
+ * @brief Hierarchical timing wheel shared by all device-layer timed behaviour.
+ *
+ * Four levels of 64 slots cover 2^24 ticks; longer delays are parked in the last level
+ * and cascaded again until they fit. Timers are intrusive nodes owned by the caller, so
+ * scheduling never allocates, and both schedule() and cancel() are O(1). The wheel only
+ * moves when advance() is called by its tick source, which makes it fully deterministic
+ * when driven by a HostTickSource.
+ *
+ * The wheel is thread-safe. Callbacks run on the tick source context without the wheel
+ * lock held, so they may schedule or cancel timers, including their own. Owners that free the
+ * callback context right after stopping a timer use cancelAndWait(), which also waits for a
+ * callback of the timer that is already running.
+ */
+class TimerWheel {
+ public:
+  static constexpr uint32_t kTickMs = 10;              /**< Tick period of the device wheel in milliseconds. */
+  static constexpr unsigned kLevelBits = 6;            /**< log2 of the number of slots per level. */
+  static constexpr unsigned kLevels = 4;               /**< Number of wheel levels. */
+  static constexpr uint32_t kSlots = 1u << kLevelBits; /**< Number of slots per level. */
+
+  /**
+   * @brief Callback invoked when a timer expires.
+   *
+   * @param context Context registered with schedule().
+   */
+  typedef void (*Callback)(void *context);
+
+  /**
+   * @class Timer
+   * @brief Caller-owned timer node. Must stay alive and in place while it is pending.
+   */
+  class Timer {
+   public:
+    Timer();
+
+    /**
+     * @brief Destructor, the timer must not be pending anymore.
+     */
+    ~Timer() = default;
+
+    Timer(const Timer &) = delete;
+    Timer &operator=(const Timer &) = delete;
+
+    /**
+     * @brief Check whether the timer is scheduled.
+     *
+     * @return bool true while the timer waits in the wheel.
+     */
+    bool isPending() const;
+
+   private:
+    friend class TimerWheel;
+
+    Timer *next;       /**< Next node of the slot list. */
+    Timer *prev;       /**< Previous node of the slot list. */
+    uint64_t expiry;   /**< Absolute expiry tick. */
+    uint32_t period;   /**< Reload period in ticks, 0 for one-shot timers. */
+    Callback callback; /**< Expiry callback. */
+    void *context;     /**< Callback context. */
+  };
+
+  TimerWheel();
+
+  TimerWheel(const TimerWheel &) = delete;
+  TimerWheel &operator=(const TimerWheel &) = delete;
+
+  /**
+   * @brief Get the wheel shared by the device layer.
+   *
+   * @return TimerWheel& The device wheel, ticking every kTickMs once a tick source drives it.
+   */
+  static TimerWheel &device();
+
+  /**
+   * @brief Convert milliseconds to device wheel ticks, rounding up.
+   *
+   * @param ms Duration in milliseconds.
+   * @return uint32_t Number of ticks, at least 1 for a non-zero duration.
+   */
+  static uint32_t msToTicks(uint32_t ms);
+
+  /**
+   * @brief Schedule (or reschedule) a timer.
+   *
+   * @param timer Timer node.
+   * @param delayTicks Ticks until the first expiry. 0 expires on the next tick.
+   * @param callback Expiry callback.
+   * @param context Callback context.
+   * @param periodTicks Reload period in ticks, 0 for a one-shot timer.
+   */
+  void schedule(Timer &timer, uint32_t delayTicks, Callback callback, void *context, uint32_t periodTicks = 0);
+
+  /**
+   * @brief Cancel a timer. Cancelling a timer that is not pending is a no-op.
+   *
+   * @param timer Timer node.
+   */
+  void cancel(Timer &timer);
+
+  /**
+   * @brief Cancel a timer and wait until a running callback of it returned.
+   *
+   * Once this returns, the callback does not run and the context may be freed. Called from a
+   * wheel callback it does not wait, the calling callback is the only one that can run. Must
+   * not be called while holding a lock the callback takes.
+   *
+   * @param timer Timer node.
+   */
+  void cancelAndWait(Timer &timer);
+
+  /**
+   * @brief Advance the wheel and run every timer that expired.
+   *
+   * @param ticks Number of ticks to advance.
+   */
+  void advance(uint32_t ticks = 1);
+
+  /**
+   * @brief Get the current tick.
+   *
+   * @return uint64_t Number of ticks processed since the wheel was created.
+   */
+  uint64_t now();
+
+  /**
+   * @brief Get the number of pending timers.
+   *
+   * @return size_t Number of pending timers.
+   */
+  size_t pending();
+
+ private:
+  static void link(Timer &head, Timer &timer);
+  static void unlink(Timer &timer);
+
+  void insert(Timer &timer);
+  void cascade(unsigned level);
+
+  std::mutex wheelMutex;                /**< Protects the slots and the current tick. */
+  std::condition_variable callbackDone; /**< Signalled when a callback returned. */
+  Timer slots[kLevels][kSlots];         /**< Sentinel heads of the slot lists. */
+  uint64_t currentTick;                 /**< Next tick to process. */
+  size_t count;                         /**< Number of pending timers. */
+  const Timer *running;                 /**< Timer whose callback runs, nullptr between callbacks. */
+  std::thread::id runningThread;        /**< Tick source context running the callback. */
+};
+
+#endif  // TIMER_WHEEL_HPP
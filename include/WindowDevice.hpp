@@ -5,8 +5,14 @@
 #include <esp_matter.h>
 #include <hal/gpio_types.h>
 
+#include <AccessoryCompletion.hpp>
 #include <BaseDevice.hpp>
 #include <BlindAccessoryInterface.hpp>
+#include <DeviceName.hpp>
+#include <DeviceTask.hpp>
+#include <SeqLock.hpp>
+#include <WindowProfileStorageInterface.hpp>
+#include <atomic>
 #include <cstdint>
 
 /**
@@ -15,22 +21,43 @@
  *
  * The WindowDevice class encapsulates the behavior of a window accessory, providing
  * methods to interact with the hardware (window and button) and the ESP Matter framework.
+ *
+ * calibrate() learns the travel times and the stop latency of the blind. Moves to an
+ * intermediate position are then commanded short of the target by the distance the blind
+ * coasts after stopping, so it lands on the target without a corrective move. End positions
+ * are commanded unchanged, the end stops of the motor hold them. The delay before the motor
+ * starts does not move the point it stops at, so it is not learned.
  */
 class WindowDevice : public BaseDevice {
  public:
+  static constexpr uint32_t kDefaultTravelMs = 30000;      /**< Travel time until calibrated. */
+  static constexpr uint32_t kCalibrationStallMs = 5000;    /**< Silence after which a move has stalled. */
+  static constexpr uint32_t kCalibrationSettleMs = 1000;   /**< Silence after which the blind stopped. */
+  static constexpr uint16_t kCalibrationStopPosition = 50; /**< Position of the stop latency measurement. */
+
+  /**
+   * @struct State
+   * @brief Endpoint state mirrored in the state shadow.
+   */
+  struct State {
+    uint16_t currentPosition; /**< Current lift position in percent. */
+    uint16_t targetPosition;  /**< Target lift position in percent. */
+  };
+
   /**
    * @brief Constructor for WindowDevice.
    *
    * This constructor initializes the WindowDevice with specified parameters.
    *
-   * @param device_name The name of the device.
+   * @param device_name The name of the device, copied unless passed as a BorrowedName.
    * @param motor_open_pin The GPIO pin connected to the window open motor. Default is GPIO_NUM_NC.
    * @param motor_close_pin The GPIO pin connected to the window close motor. Default is GPIO_NUM_NC.
    * @param button__open_pin The GPIO pin connected to the open button. Default is GPIO_NUM_NC.
    * @param button_close_pin The GPIO pin connected to the close button. Default is GPIO_NUM_NC.
-   * @param time_to_open The time it takes to open the window in seconds. Default is 30.
-   * @param time_to_close The time it takes to close the window in seconds. Default is 30.
    * @param aggregator The endpoint aggregator. Default is nullptr.
+   * @param profileStorage Storage of the learned travel profile, keyed by a hash of the device
+   * name, or by the endpoint id without a name. Default is nullptr, which keeps the profile in RAM
+   * only.
    *
    * @details The constructor creates a WindowAccessory instance with the specified window and button pins.
    * It also sets up the callback for reporting attributes.
@@ -38,18 +65,20 @@ class WindowDevice : public BaseDevice {
    * If no name is provided, it creates a bridged node endpoint with a default name.
    * If no aggregator is provided, it creates a standalone WindowDevice.
    */
-  WindowDevice(const char *device_name = nullptr, BlindAccessoryInterface *blindAccessory = nullptr,
-               esp_matter::endpoint_t *aggregator = nullptr);
+  WindowDevice(DeviceName device_name = nullptr, BlindAccessoryInterface *blindAccessory = nullptr,
+               esp_matter::endpoint_t *aggregator = nullptr,
+               WindowProfileStorageInterface *profileStorage = nullptr);
 
   /**
-   * @brief Default destructor for WindowDevice.
+   * @brief Destructor for WindowDevice, cancels a running calibration.
    */
-  ~WindowDevice() = default;
+  ~WindowDevice();
 
   /**
    * @brief Update the accessory state.
    *
    * This method updates the state of the window accessory based on the endpoint's state.
+   * During a calibration the target is only stored, and the blind moves to it afterwards.
    *
    * @return esp_err_t Error code indicating success or failure.
    */
@@ -73,18 +102,177 @@ class WindowDevice : public BaseDevice {
    */
   esp_err_t identify() override;
 
+  /**
+   * @brief Write the cached state of the device into one snapshot row.
+   *
+   * @param snapshot Snapshot buffers to fill.
+   * @param index Row of this device.
+   */
+  void fillSnapshot(DeviceSnapshot &snapshot, size_t index) const override;
+
+  /**
+   * @brief Write the endpoint ids owned by the device.
+   *
+   * @param endpointIds Buffer receiving the endpoint ids.
+   * @param capacity Number of ids the buffer can hold.
+   * @return size_t Number of ids written.
+   */
+  size_t getEndpointIds(uint16_t *endpointIds, size_t capacity) const override;
+
+  /**
+   * @brief Read the endpoint state from any task without the stack lock.
+   *
+   * Current and target position always come from the same update.
+   *
+   * @return State Consistent copy of the state shadow.
+   */
+  State getState() const;
+
+  /**
+   * @brief Start learning the travel profile of the blind.
+   *
+   * Runs on the DeviceExecutor. The blind opens fully, closes fully, opens fully and is then
+   * stopped halfway through a close, after which it returns to the endpoint target. On success
+   * the profile is used for every later move and saved to the profile storage. On a stall the
+   * previous profile is kept.
+   *
+   * @return esp_err_t ESP_ERR_INVALID_STATE if a calibration is running, ESP_ERR_NO_MEM if it
+   * cannot be started.
+   */
+  esp_err_t calibrate();
+
+  /**
+   * @brief Check whether a calibration is running.
+   *
+   * @return bool true while calibrating.
+   */
+  bool isCalibrating() const;
+
+  /**
+   * @brief Get the travel profile used for moves.
+   *
+   * @return WindowTravelProfile The learned profile, or the defaults if never calibrated.
+   */
+  WindowTravelProfile getTravelProfile() const;
+
  private:
+  /**
+   * @struct CalibrationLeg
+   * @brief Timing of one calibration move.
+   */
+  struct CalibrationLeg {
+    bool arrived;       /**< Whether the blind reached the stop position. */
+    uint16_t from;      /**< Position when the move was commanded. */
+    uint16_t motionAt;  /**< Position of the first reported motion. */
+    uint16_t stoppedAt; /**< Position the blind was told to stop at. */
+    uint32_t motionMs;  /**< Time of the first reported motion. */
+    uint32_t arrivalMs; /**< Time the stop position was reported. */
+  };
+
+  /**
+   * @brief Report callback of the accessory.
+   *
+   * Reports the endpoint, or only the current position while the blind travels to the position
+   * commanded for a Matter write.
+   * While calibrating, only the current position is reported and the calibration is woken.
+   */
+  void onAccessoryReport();
+
   uint16_t getAccessoryCurrentPosition();
   uint16_t getAccessoryTargetPosition();
+
+  /**
+   * @brief Move the blind to a Matter target, compensated for the coasting of the blind.
+   *
+   * A target closer than the blind would coast past it is not moved to: the current position
+   * is reported as it is and the target stays the requested one.
+   *
+   * @param position Target position in percent.
+   */
   void setAccessoryTargetPosition(uint16_t position);
+
+  /**
+   * @brief Command the blind and remember which Matter target the command stands for.
+   *
+   * @param requested Matter target position in percent.
+   * @param commanded Position sent to the accessory in percent.
+   */
+  void commandAccessory(uint16_t requested, uint16_t commanded);
+
+  /**
+   * @brief Position to command so the blind coasts onto the target.
+   *
+   * @param position Target position in percent.
+   * @return uint16_t Position to send to the accessory.
+   */
+  uint16_t getCompensatedPosition(uint16_t position);
+
+  /**
+   * @brief Map a target read from the accessory back to the Matter target it was commanded for.
+   *
+   * @param accessoryTarget Target position of the accessory in percent.
+   * @return uint16_t Matter target position in percent.
+   */
+  uint16_t toEndpointTarget(uint16_t accessoryTarget) const;
+
+  /**
+   * @brief Report a changed current position, keeping the endpoint target.
+   *
+   * @param currentPosition Current position in percent.
+   */
+  void reportTravel(uint16_t currentPosition);
+
+  /**
+   * @brief Calibration sequence, run on the DeviceExecutor.
+   *
+   * @return DeviceTask The calibration.
+   */
+  DeviceTask runCalibration();
+
+  /**
+   * @brief Measure the travel profile.
+   *
+   * @param profile Profile receiving the measurements.
+   * @param measured Set to true if every move completed.
+   * @return DeviceTask The measurement.
+   */
+  DeviceTask measureProfile(WindowTravelProfile *profile, bool *measured);
+
+  /**
+   * @brief Move the blind towards a position and wait until it stopped.
+   *
+   * @param position Position to move towards in percent.
+   * @param stopAt Position to stop at once reached, the target itself for a full move.
+   * @param leg Timing of the move.
+   * @return DeviceTask The move.
+   */
+  DeviceTask calibrationMove(uint16_t position, uint16_t stopAt, CalibrationLeg *leg);
+
   uint16_t getEndpointTargetPosition();
-  void setEndpointTargetPosition(uint16_t position);
-  void setEndpointCurrentPosition(uint16_t position);
-
-  esp_matter::endpoint_t *endpoint; /**< Pointer to the esp_matter endpoint. */
-  BlindAccessoryInterface *BlindAccessory;  /**< Window accessory instance. */
-  uint16_t time_to_open;            /**< Time it takes to open the window in seconds. */
-  uint16_t time_to_close;           /**< Time it takes to close the window in seconds. */
-  char name[64];                    /**< Name of the device. TODO: Change to a define. */
+  esp_err_t setEndpointTargetPosition(uint16_t position);
+  esp_err_t setEndpointCurrentPosition(uint16_t position);
+
+  /**
+   * @brief Load the target position from the attribute store into the state shadow.
+   *
+   * Only called from updateAccessory(), which runs in the stack context.
+   *
+   * @return esp_err_t ESP_ERR_NOT_FOUND if the attribute does not exist, or the error of the read.
+   */
+  esp_err_t loadShadow();
+
+  void cachePositions(uint16_t currentPosition, uint16_t targetPosition);
+  void cacheTargetPosition(uint16_t position);
+
+  esp_matter::endpoint_t *endpoint;              /**< Pointer to the esp_matter endpoint. */
+  BlindAccessoryInterface *BlindAccessory;       /**< Window accessory instance. */
+  DeviceName name;                               /**< Name of the device, copied or borrowed. */
+  SeqLock<State> shadow;                         /**< Endpoint state readable from any task. */
+  WindowProfileStorageInterface *profileStorage; /**< Storage of the travel profile, may be nullptr. */
+  SeqLock<WindowTravelProfile> profile;          /**< Travel profile used for moves. */
+  std::atomic<uint32_t> commandedMove;           /**< Matter target, commanded position and write state. */
+  std::atomic<bool> calibrating;                 /**< Whether a calibration drives the blind. */
+  uint32_t calibrationTask;                      /**< DeviceExecutor id of the calibration. */
+  AccessoryCompletion moved;                     /**< Signalled on every accessory report while calibrating. */
 };
 #endif  // WINDOW_DEVICE_HPP
\ No newline at end of file
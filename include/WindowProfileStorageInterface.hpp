@@ -0,0 +1,48 @@
+#ifndef WINDOW_PROFILE_STORAGE_INTERFACE_HPP
+#define WINDOW_PROFILE_STORAGE_INTERFACE_HPP
+
+#include <esp_err.h>
+
+#include <cstdint>
+
+/**
+ * @struct WindowTravelProfile
+ * @brief Motor timing of a blind, learned by WindowDevice calibration.
+ */
+struct WindowTravelProfile {
+  uint32_t openMs;        /**< Travel time from fully closed to fully open in milliseconds. */
+  uint32_t closeMs;       /**< Travel time from fully open to fully closed in milliseconds. */
+  uint32_t stopLatencyMs; /**< Time the blind keeps moving after it was told to stop in milliseconds. */
+};
+
+/**
+ * @class WindowProfileStorageInterface
+ * @brief Interface for the persistent storage of learned window travel profiles.
+ */
+class WindowProfileStorageInterface {
+ public:
+  /**
+   * @brief Virtual destructor for WindowProfileStorageInterface.
+   */
+  virtual ~WindowProfileStorageInterface() = default;
+
+  /**
+   * @brief Load a stored profile.
+   *
+   * @param key Key of the window.
+   * @param profile Profile to fill.
+   * @return esp_err_t ESP_ERR_NOT_FOUND if no profile was stored for the key.
+   */
+  virtual esp_err_t load(const char *key, WindowTravelProfile &profile) = 0;
+
+  /**
+   * @brief Store a profile, replacing the previous one.
+   *
+   * @param key Key of the window.
+   * @param profile Profile to store.
+   * @return esp_err_t Error code indicating success or failure.
+   */
+  virtual esp_err_t save(const char *key, const WindowTravelProfile &profile) = 0;
+};
+
+#endif  // WINDOW_PROFILE_STORAGE_INTERFACE_HPP
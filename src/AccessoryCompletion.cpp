@@ -0,0 +1,90 @@
+#include "AccessoryCompletion.hpp"
+
+#include <DeviceExecutor.hpp>
+#include <DeviceTask.hpp>
+#include <TimerWheel.hpp>
+#include <coroutine>
+#include <cstdint>
+#include <mutex>
+
+AccessoryCompletion::Awaiter::Awaiter(AccessoryCompletion &completion, uint32_t timeoutMs)
+    : completion(completion),
+      timeoutMs(timeoutMs),
+      signalled(false),
+      executor(nullptr),
+      taskId(DeviceExecutor::kNoTask),
+      handle(),
+      timer() {}
+
+AccessoryCompletion::Awaiter::~Awaiter() {
+  if (executor == nullptr) {
+    return;
+  }
+  executor->getWheel().cancelAndWait(timer);
+  std::lock_guard<std::mutex> guard(completion.mutex);
+  if (completion.waiter == this) {
+    completion.waiter = nullptr;
+  }
+}
+
+bool AccessoryCompletion::Awaiter::await_ready() {
+  std::lock_guard<std::mutex> guard(completion.mutex);
+  signalled = completion.pending;
+  completion.pending = false;
+  return signalled;
+}
+
+bool AccessoryCompletion::Awaiter::await_suspend(DeviceTask::Handle handle) {
+  executor = handle.promise().executor;
+  taskId = handle.promise().taskId;
+  this->handle = handle;
+
+  std::lock_guard<std::mutex> guard(completion.mutex);
+  if (completion.pending) {
+    // Signalled since await_ready(), do not suspend
+    completion.pending = false;
+    signalled = true;
+    return false;
+  }
+  completion.waiter = this;
+  if (timeoutMs > 0) {
+    executor->getWheel().schedule(timer, TimerWheel::msToTicks(timeoutMs), onTimeout, this);
+  }
+  return true;
+}
+
+void AccessoryCompletion::Awaiter::onTimeout(void *self) {
+  Awaiter *awaiter = static_cast<Awaiter *>(self);
+  DeviceExecutor *executor = awaiter->executor;
+  {
+    std::lock_guard<std::mutex> guard(awaiter->completion.mutex);
+    if (awaiter->completion.waiter != awaiter) {
+      // The signal won the race
+      return;
+    }
+    awaiter->wake(false);
+  }
+  executor->runReady();
+}
+
+void AccessoryCompletion::Awaiter::wake(bool isSignalled) {
+  completion.waiter = nullptr;
+  signalled = isSignalled;
+  executor->post(taskId, handle);
+}
+
+AccessoryCompletion::AccessoryCompletion() : pending(false), waiter(nullptr) {}
+
+void AccessoryCompletion::signal() {
+  std::lock_guard<std::mutex> guard(mutex);
+  if (waiter != nullptr) {
+    waiter->wake(true);
+  } else {
+    pending = true;
+  }
+}
+
+void AccessoryCompletion::reset() {
+  std::lock_guard<std::mutex> guard(mutex);
+  pending = false;
+}
@@ -0,0 +1,195 @@
+#include "BaseDevice.hpp"
+
+#include <esp_err.h>
+#include <esp_log.h>
+#include <esp_matter.h>
+
+#include <DeviceRegistry.hpp>
+#include <DeviceSnapshot.hpp>
+#include <HealthProbeInterface.hpp>
+#include <ReportRetryQueue.hpp>
+#include <ReportScheduler.hpp>
+#include <SubscriptionTracker.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+BaseDevice::BaseDevice()
+    : nextDevice(nullptr),
+      hasDeferredReports(false),
+      healthProbe(nullptr),
+      reachable(true),
+      probeStreak(0),
+      failedReports(0),
+      retriedReports(0),
+      droppedReports(0),
+      writeGeneration(0),
+      echoGeneration(0) {}
+
+BaseDevice::~BaseDevice() {
+  // Only a safety net, the concrete device unregisters before its own members are destroyed
+  DeviceRegistry::remove(this);
+}
+
+void BaseDevice::registerDevice() { DeviceRegistry::add(this); }
+
+void BaseDevice::unregisterDevice() { DeviceRegistry::remove(this); }
+
+void BaseDevice::fillSnapshot(DeviceSnapshot &snapshot, size_t index) const {
+  (void)snapshot;
+  (void)index;
+}
+
+void BaseDevice::flushDeferredReports() {
+  if (hasDeferredReports.exchange(false)) {
+    reportEndpoint();
+  }
+}
+
+bool BaseDevice::isReportDeferred() const { return hasDeferredReports.load(); }
+
+size_t BaseDevice::getEndpointIds(uint16_t *endpointIds, size_t capacity) const {
+  (void)endpointIds;
+  (void)capacity;
+  return 0;
+}
+
+void BaseDevice::setHealthProbe(HealthProbeInterface *probe) { healthProbe.store(probe); }
+
+bool BaseDevice::isReachable() const { return reachable.load(std::memory_order_relaxed); }
+
+bool BaseDevice::probeHealth(uint8_t failThreshold, uint8_t recoverThreshold) {
+  HealthProbeInterface *probe = healthProbe.load();
+  if (probe == nullptr) {
+    return false;
+  }
+
+  bool isReachable = reachable.load(std::memory_order_relaxed);
+  if (probe->isResponsive() == isReachable) {
+    probeStreak = 0;
+    return false;
+  }
+  probeStreak++;
+  if (probeStreak < (isReachable ? failThreshold : recoverThreshold)) {
+    return false;
+  }
+
+  probeStreak = 0;
+  reachable.store(!isReachable, std::memory_order_relaxed);
+  return true;
+}
+
+BaseDevice::ReportErrorStats BaseDevice::getReportErrorStats() const {
+  ReportErrorStats stats;
+  stats.failed = failedReports.load(std::memory_order_relaxed);
+  stats.retried = retriedReports.load(std::memory_order_relaxed);
+  stats.dropped = droppedReports.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void BaseDevice::resetReportErrorStats() {
+  failedReports.store(0, std::memory_order_relaxed);
+  retriedReports.store(0, std::memory_order_relaxed);
+  droppedReports.store(0, std::memory_order_relaxed);
+}
+
+void BaseDevice::countReportError(ReportError error) {
+  switch (error) {
+    case ReportError::Failed:
+      failedReports.fetch_add(1, std::memory_order_relaxed);
+      break;
+    case ReportError::Retried:
+      retriedReports.fetch_add(1, std::memory_order_relaxed);
+      break;
+    case ReportError::Dropped:
+      droppedReports.fetch_add(1, std::memory_order_relaxed);
+      break;
+  }
+}
+
+void BaseDevice::reportReachable() {
+  uint16_t endpointIds[kMaxEndpoints];
+  size_t count = getEndpointIds(endpointIds, sizeof(endpointIds) / sizeof(endpointIds[0]));
+  if (count == 0) {
+    return;
+  }
+  bool isReachable = reachable.load(std::memory_order_relaxed);
+  ESP_LOGW(__FILENAME__, "Endpoint %u is now %s", endpointIds[0], isReachable ? "reachable" : "unreachable");
+
+  // Only bridged endpoints carry BridgedDeviceBasicInformation
+  esp_matter::lock::status_t lockStatus = esp_matter::lock::chip_stack_lock(portMAX_DELAY);
+  for (size_t i = 0; i < count; i++) {
+    if (esp_matter::attribute::get(endpointIds[i], chip::app::Clusters::BridgedDeviceBasicInformation::Id,
+                                   chip::app::Clusters::BridgedDeviceBasicInformation::Attributes::Reachable::Id) ==
+        nullptr) {
+      continue;
+    }
+    esp_matter_attr_val_t attr_val = esp_matter_bool(isReachable);
+    reportAttribute(endpointIds[i], chip::app::Clusters::BridgedDeviceBasicInformation::Id,
+                    chip::app::Clusters::BridgedDeviceBasicInformation::Attributes::Reachable::Id, &attr_val,
+                    ReportLane::Interactive);
+  }
+  if (lockStatus == esp_matter::lock::SUCCESS) {
+    esp_matter::lock::chip_stack_unlock();
+  }
+}
+
+void BaseDevice::markAccessoryWrite() { writeGeneration.fetch_add(1, std::memory_order_release); }
+
+bool BaseDevice::isWriteEcho(bool matchesWrite) {
+  uint32_t generation = writeGeneration.load(std::memory_order_acquire);
+  if (echoGeneration.exchange(generation, std::memory_order_acq_rel) == generation) {
+    // No write since the last report, the change came from the accessory itself
+    return false;
+  }
+  return matchesWrite;
+}
+
+esp_err_t BaseDevice::reportAttribute(uint16_t endpointId, uint32_t clusterId, uint32_t attributeId,
+                                      esp_matter_attr_val_t *val, ReportLane lane) {
+  SubscriptionTracker &tracker = SubscriptionTracker::instance();
+  if (tracker.hasInterest(endpointId, clusterId)) {
+    return ReportScheduler::instance().reportAttribute(lane, endpointId, clusterId, attributeId, val);
+  }
+
+  // Nobody watches this path: keep the store current for reads, skip the reporting engine
+  ReportRetryQueue::instance().cancel(endpointId, clusterId, attributeId);
+  hasDeferredReports.store(true);
+  tracker.countDeferred();
+  esp_matter::lock::status_t lockStatus = esp_matter::lock::chip_stack_lock(portMAX_DELAY);
+  esp_err_t err = ESP_ERR_NOT_FOUND;
+  esp_matter::attribute_t *attribute = esp_matter::attribute::get(endpointId, clusterId, attributeId);
+  if (attribute != nullptr) {
+    err = esp_matter::attribute::set_val(attribute, val);
+  }
+  if (lockStatus == esp_matter::lock::SUCCESS) {
+    esp_matter::lock::chip_stack_unlock();
+  }
+  return err;
+}
+
+esp_err_t BaseDevice::reportAttributes(ReportScheduler::AttributeReport *reports, size_t count, ReportLane lane) {
+  SubscriptionTracker &tracker = SubscriptionTracker::instance();
+  esp_err_t err = ESP_OK;
+
+  // The nested locks of the store updates and of the scheduler find it taken and keep it
+  esp_matter::lock::status_t lockStatus = esp_matter::lock::chip_stack_lock(portMAX_DELAY);
+  size_t watched = 0;
+  for (size_t i = 0; i < count; i++) {
+    ReportScheduler::AttributeReport &report = reports[i];
+    if (tracker.hasInterest(report.endpointId, report.clusterId)) {
+      reports[watched++] = report;
+      continue;
+    }
+    esp_err_t reportErr = reportAttribute(report.endpointId, report.clusterId, report.attributeId, &report.val, lane);
+    if (err == ESP_OK) err = reportErr;
+  }
+  if (watched > 0) {
+    esp_err_t batchErr = ReportScheduler::instance().reportAttributes(lane, reports, watched);
+    if (err == ESP_OK) err = batchErr;
+  }
+  if (lockStatus == esp_matter::lock::SUCCESS) {
+    esp_matter::lock::chip_stack_unlock();
+  }
+  return err;
+}
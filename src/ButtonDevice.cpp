@@ -5,12 +5,18 @@
 #include <esp_matter.h>
 #include <esp_matter_endpoint.h>
 
+#include <DeviceConfig.hpp>
+#include <DeviceName.hpp>
+#include <ReportScheduler.hpp>
+#include <StateStream.hpp>
 #include <StatelessButtonAccessoryInterface.hpp>
+#include <atomic>
 #include <cstdint>
+#include <utility>
 
-ButtonDevice::ButtonDevice(const char *device_name, StatelessButtonAccessoryInterface *buttonAccessory,
+ButtonDevice::ButtonDevice(DeviceName device_name, StatelessButtonAccessoryInterface *buttonAccessory,
                            esp_matter::endpoint_t *aggregator)
-    : BaseDevice() {
+    : BaseDevice(), name(std::move(device_name)), cachedLastPress(DeviceSnapshot::kNoPress) {
   switchButtonAccessory = buttonAccessory;
 
   // Set up the callback for reporting attributes
@@ -24,15 +30,12 @@ ButtonDevice::ButtonDevice(const char *device_name, StatelessButtonAccessoryInte
                     esp_matter::endpoint_flags::ENDPOINT_FLAG_DESTROYABLE;
     endpoint = esp_matter::endpoint::bridged_node::create(esp_matter::node::get(), &bridged_node_config,
                                                           flags, this);
-    if (device_name != nullptr && strlen(device_name) > 0 &&
-        strlen(device_name) < 64)  // TODO: change to a define
-    {
-      strncpy(this->name, device_name, sizeof(this->name));
-      ESP_LOGI(__FILENAME__, "Creating Bridged Node ButtonDevice with name: %s", name);
+    if (name.length() > 0) {
+      ESP_LOGI(__FILENAME__, "Creating Bridged Node ButtonDevice with name: %s", name.get());
       esp_matter::cluster_t *bridge_device_basic_information_cluster =
           esp_matter::cluster::get(endpoint, chip::app::Clusters::BridgedDeviceBasicInformation::Id);
       esp_matter::cluster::bridged_device_basic_information::attribute::create_node_label(
-          bridge_device_basic_information_cluster, name, strlen(name));
+          bridge_device_basic_information_cluster, name.get(), name.length());
     } else {
       ESP_LOGW(__FILENAME__, "device_name is not set");
       ESP_LOGI(__FILENAME__, "Creating Bridged Node ButtonDevice with default name");
@@ -50,17 +53,28 @@ ButtonDevice::ButtonDevice(const char *device_name, StatelessButtonAccessoryInte
   // Add single press feature to the cluster
   esp_matter::cluster_t *switch_cluster = esp_matter::cluster::get(endpoint, chip::app::Clusters::Switch::Id);
   esp_matter::cluster::switch_cluster::feature::momentary_switch::add(switch_cluster);
-  esp_matter::cluster::switch_cluster::feature::momentary_switch_release::add(switch_cluster);
+  if constexpr (DeviceConfig::kButton.release) {
+    esp_matter::cluster::switch_cluster::feature::momentary_switch_release::add(switch_cluster);
+  }
 
   // Add long press feature to the cluster
-  esp_matter::cluster::switch_cluster::feature::momentary_switch_long_press::add(switch_cluster);
+  if constexpr (DeviceConfig::kButton.longPress) {
+    esp_matter::cluster::switch_cluster::feature::momentary_switch_long_press::add(switch_cluster);
+  }
 
   // Add double press feature to the cluster
-  esp_matter::cluster::switch_cluster::feature::momentary_switch_multi_press::config_t double_press_config;
-  esp_matter::cluster::switch_cluster::feature::momentary_switch_multi_press::add(switch_cluster,
-                                                                                  &double_press_config);
+  if constexpr (DeviceConfig::kButton.multiPress) {
+    esp_matter::cluster::switch_cluster::feature::momentary_switch_multi_press::config_t double_press_config;
+    double_press_config.multi_press_max = DeviceConfig::kButton.multiPressMax;
+    esp_matter::cluster::switch_cluster::feature::momentary_switch_multi_press::add(switch_cluster,
+                                                                                    &double_press_config);
+  }
+
+  registerDevice();
 }
 
+ButtonDevice::~ButtonDevice() { unregisterDevice(); }
+
 esp_err_t ButtonDevice::updateAccessory() { return ESP_OK; }
 
 esp_err_t ButtonDevice::reportEndpoint() {
@@ -70,39 +84,58 @@ esp_err_t ButtonDevice::reportEndpoint() {
   StatelessButtonAccessoryInterface::PressType pressType = switchButtonAccessory->getLastPressType();
 
   // Report the endpoint state
-  setEndpointSwitchPressEvent(pressType);
-  return ESP_OK;
+  esp_err_t err = setEndpointSwitchPressEvent(pressType);
+  cachedLastPress.store(static_cast<uint8_t>(pressType), std::memory_order_relaxed);
+  StateStreamEncoder::emit(esp_matter::endpoint::get_id(endpoint), StateChangeKind::ButtonPress,
+                           static_cast<int32_t>(pressType));
+  return err;
 }
 
 esp_err_t ButtonDevice::identify() { return ESP_OK; }
 
-void ButtonDevice::setEndpointSwitchPressEvent(StatelessButtonAccessoryInterface::PressType pressType) {
+esp_err_t ButtonDevice::setEndpointSwitchPressEvent(StatelessButtonAccessoryInterface::PressType pressType) {
   uint16_t endpoint_id = esp_matter::endpoint::get_id(endpoint);
-  esp_matter::cluster_t *switch_cluster = esp_matter::cluster::get(endpoint, chip::app::Clusters::Switch::Id);
   esp_matter_attr_val_t attr_val = esp_matter_uint8(0);
-  esp_matter::attribute::report(endpoint_id, chip::app::Clusters::Switch::Id,
-                                chip::app::Clusters::Switch::Attributes::CurrentPosition::Id, &attr_val);
+  ReportScheduler &scheduler = ReportScheduler::instance();
+  esp_err_t err = scheduler.reportAttribute(ReportLane::Interactive, endpoint_id, chip::app::Clusters::Switch::Id,
+                                            chip::app::Clusters::Switch::Attributes::CurrentPosition::Id, &attr_val);
+  // The event is sent even if the position report failed, it carries the press itself
+  esp_err_t event_err = scheduler.sendEvent(ReportLane::Interactive, sendSwitchPressEvent, endpoint_id,
+                                            static_cast<uint32_t>(pressType));
+  return err != ESP_OK ? err : event_err;
+}
 
-  switch (pressType) {
+void ButtonDevice::sendSwitchPressEvent(uint16_t endpointId, uint32_t pressType) {
+  switch (static_cast<StatelessButtonAccessoryInterface::PressType>(pressType)) {
     case StatelessButtonAccessoryInterface::PressType::SinglePress:
       ESP_LOGW(__FILENAME__, "SinglePress");
-      esp_matter::lock::chip_stack_lock(portMAX_DELAY);
-      esp_matter::cluster::switch_cluster::event::send_multi_press_complete(endpoint_id, 0, 1);
-      esp_matter::lock::chip_stack_unlock();
+      esp_matter::cluster::switch_cluster::event::send_multi_press_complete(endpointId, 0, 1);
       break;
     case StatelessButtonAccessoryInterface::PressType::LongPress:
       ESP_LOGW(__FILENAME__, "LongPress");
-      esp_matter::lock::chip_stack_lock(portMAX_DELAY);
-      esp_matter::cluster::switch_cluster::event::send_long_press(endpoint_id, 0);
-      esp_matter::lock::chip_stack_unlock();
+      esp_matter::cluster::switch_cluster::event::send_long_press(endpointId, 0);
       break;
     case StatelessButtonAccessoryInterface::PressType::DoublePress:
       ESP_LOGW(__FILENAME__, "DoublePress");
-      esp_matter::lock::chip_stack_lock(portMAX_DELAY);
-      esp_matter::cluster::switch_cluster::event::send_multi_press_complete(endpoint_id, 0, 2);
-      esp_matter::lock::chip_stack_unlock();
+      esp_matter::cluster::switch_cluster::event::send_multi_press_complete(endpointId, 0, 2);
       break;
     default:
       break;
   }
-}
\ No newline at end of file
+}
+
+void ButtonDevice::fillSnapshot(DeviceSnapshot &snapshot, size_t index) const {
+  if (snapshot.endpointIds != nullptr) snapshot.endpointIds[index] = esp_matter::endpoint::get_id(endpoint);
+  if (snapshot.types != nullptr) snapshot.types[index] = DeviceType::Button;
+  if (snapshot.buttonLastPress != nullptr) {
+    snapshot.buttonLastPress[index] = cachedLastPress.load(std::memory_order_relaxed);
+  }
+}
+
+size_t ButtonDevice::getEndpointIds(uint16_t *endpointIds, size_t capacity) const {
+  if (capacity == 0) {
+    return 0;
+  }
+  endpointIds[0] = esp_matter::endpoint::get_id(endpoint);
+  return 1;
+}
@@ -0,0 +1,219 @@
+#include "DeviceExecutor.hpp"
+
+#include <esp_err.h>
+#include <esp_log.h>
+
+#include <DeviceTask.hpp>
+#include <ReportScheduler.hpp>
+#include <TimerWheel.hpp>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+DeviceExecutor::DelayAwaiter::DelayAwaiter(uint32_t ms)
+    : ms(ms), executor(nullptr), taskId(kNoTask), handle(), timer() {}
+
+DeviceExecutor::DelayAwaiter::~DelayAwaiter() {
+  if (executor != nullptr) {
+    executor->getWheel().cancelAndWait(timer);
+  }
+}
+
+void DeviceExecutor::DelayAwaiter::await_suspend(DeviceTask::Handle handle) {
+  executor = handle.promise().executor;
+  taskId = handle.promise().taskId;
+  this->handle = handle;
+  executor->getWheel().schedule(timer, TimerWheel::msToTicks(ms), onTimer, this);
+}
+
+void DeviceExecutor::DelayAwaiter::onTimer(void *self) {
+  // Already on the wheel context, resume without waiting for the next tick
+  DelayAwaiter *awaiter = static_cast<DelayAwaiter *>(self);
+  DeviceExecutor *executor = awaiter->executor;
+  executor->post(awaiter->taskId, awaiter->handle);
+  executor->runReady();
+}
+
+DeviceExecutor::FlushAwaiter::FlushAwaiter() : executor(nullptr), taskId(kNoTask), handle(), waiter() {}
+
+DeviceExecutor::FlushAwaiter::~FlushAwaiter() { ReportScheduler::instance().cancelFlushed(waiter); }
+
+bool DeviceExecutor::FlushAwaiter::await_suspend(DeviceTask::Handle handle) {
+  executor = handle.promise().executor;
+  taskId = handle.promise().taskId;
+  this->handle = handle;
+  return ReportScheduler::instance().notifyFlushed(waiter, onFlushed, this);
+}
+
+void DeviceExecutor::FlushAwaiter::onFlushed(void *self) {
+  FlushAwaiter *awaiter = static_cast<FlushAwaiter *>(self);
+  awaiter->executor->post(awaiter->taskId, awaiter->handle);
+}
+
+DeviceExecutor::DeviceExecutor(TimerWheel &wheel) : wheel(wheel), slots(), nextId(kNoTask + 1) {}
+
+DeviceExecutor::~DeviceExecutor() {
+  wheel.cancelAndWait(runTimer);
+  for (Slot &slot : slots) {
+    if (slot.root) {
+      slot.root.destroy();
+    }
+  }
+}
+
+DeviceExecutor &DeviceExecutor::device() {
+  static DeviceExecutor executor;
+  return executor;
+}
+
+TimerWheel &DeviceExecutor::getWheel() { return wheel; }
+
+esp_err_t DeviceExecutor::spawn(DeviceTask task, uint32_t *taskId) {
+  if (taskId != nullptr) {
+    *taskId = kNoTask;
+  }
+  if (!task.isValid()) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  std::lock_guard<std::mutex> guard(mutex);
+  for (Slot &slot : slots) {
+    if (slot.id != kNoTask) {
+      continue;
+    }
+    slot.root = task.release();
+    slot.resume = slot.root;
+    slot.id = nextId++;
+    if (nextId == kNoTask) {
+      nextId++;
+    }
+    slot.ready = true;
+    slot.cancelled = false;
+    slot.running = false;
+    slot.root.promise().executor = this;
+    slot.root.promise().taskId = slot.id;
+    if (taskId != nullptr) {
+      *taskId = slot.id;
+    }
+    arm();
+    return ESP_OK;
+  }
+  ESP_LOGW(__FILENAME__, "DeviceExecutor task table full");
+  return ESP_ERR_NO_MEM;
+}
+
+void DeviceExecutor::cancel(uint32_t taskId) {
+  std::unique_lock<std::mutex> lock(mutex);
+  Slot *slot = find(taskId);
+  if (slot == nullptr) {
+    return;
+  }
+  slot->cancelled = true;
+  if (slot->running) {
+    if (slot->runner == std::this_thread::get_id()) {
+      // Cancelled from the task itself, runReady() destroys it once it suspends
+      return;
+    }
+    // runReady() destroys it once it suspends, its owner must not go away before that
+    idle.wait(lock, [slot, taskId]() { return slot->id != taskId; });
+    return;
+  }
+
+  // Suspended, destroy it here so its awaiters are gone before the caller continues
+  slot->running = true;
+  slot->runner = std::this_thread::get_id();
+  DeviceTask::Handle root = slot->root;
+  lock.unlock();
+  root.destroy();
+  lock.lock();
+  release(*slot);
+}
+
+bool DeviceExecutor::isActive(uint32_t taskId) {
+  std::lock_guard<std::mutex> guard(mutex);
+  return find(taskId) != nullptr;
+}
+
+size_t DeviceExecutor::activeTasks() {
+  std::lock_guard<std::mutex> guard(mutex);
+  size_t count = 0;
+  for (const Slot &slot : slots) {
+    if (slot.id != kNoTask) {
+      count++;
+    }
+  }
+  return count;
+}
+
+void DeviceExecutor::post(uint32_t taskId, std::coroutine_handle<> handle) {
+  std::lock_guard<std::mutex> guard(mutex);
+  Slot *slot = find(taskId);
+  if (slot == nullptr) {
+    return;
+  }
+  slot->resume = handle;
+  slot->ready = true;
+  arm();
+}
+
+size_t DeviceExecutor::runReady() {
+  size_t count = 0;
+  std::unique_lock<std::mutex> lock(mutex);
+  for (Slot &slot : slots) {
+    if (slot.id == kNoTask || !slot.ready || slot.running) {
+      continue;
+    }
+    slot.ready = false;
+    slot.running = true;
+    slot.runner = std::this_thread::get_id();
+    std::coroutine_handle<> resume = slot.resume;
+
+    // Frames are touched without the mutex, awaiter destructors may call back into post()
+    lock.unlock();
+    resume.resume();
+    lock.lock();
+
+    // A task cancelled while it ran is destroyed as soon as it suspends
+    if (slot.cancelled || slot.root.done()) {
+      DeviceTask::Handle root = slot.root;
+      lock.unlock();
+      root.destroy();
+      lock.lock();
+      release(slot);
+    } else {
+      slot.running = false;
+    }
+    count++;
+  }
+  return count;
+}
+
+void DeviceExecutor::arm() {
+  // Rescheduling a pending run timer keeps it on the next tick
+  wheel.schedule(runTimer, 0, [](void *self) { static_cast<DeviceExecutor *>(self)->runReady(); }, this);
+}
+
+void DeviceExecutor::release(Slot &slot) {
+  slot.root = DeviceTask::Handle();
+  slot.resume = std::coroutine_handle<>();
+  slot.id = kNoTask;
+  slot.ready = false;
+  slot.cancelled = false;
+  slot.running = false;
+  idle.notify_all();
+}
+
+DeviceExecutor::Slot *DeviceExecutor::find(uint32_t taskId) {
+  if (taskId == kNoTask) {
+    return nullptr;
+  }
+  for (Slot &slot : slots) {
+    if (slot.id == taskId) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
@@ -0,0 +1,229 @@
+#include "DeviceManifest.hpp"
+
+#include <esp_err.h>
+#include <esp_log.h>
+#include <esp_matter.h>
+#include <esp_partition.h>
+
+#include <BaseDevice.hpp>
+#include <ButtonDevice.hpp>
+#include <DeviceName.hpp>
+#include <DeviceSnapshot.hpp>
+#include <DimmableLightDevice.hpp>
+#include <FanDevice.hpp>
+#include <HeapAudit.hpp>
+#include <LightDevice.hpp>
+#include <MultiChannelDevice.hpp>
+#include <PlugInDevice.hpp>
+#include <SensorDevice.hpp>
+#include <WindowDevice.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+DeviceManifest::DeviceManifest()
+    : blob(nullptr),
+      header(nullptr),
+      entries(nullptr),
+      strings(nullptr),
+      mapHandle(),
+      mapped(false),
+      fileBuffer(nullptr) {}
+
+DeviceManifest::~DeviceManifest() { release(); }
+
+esp_err_t DeviceManifest::parse(const void *data, size_t size) {
+  release();
+  return validate(data, size);
+}
+
+esp_err_t DeviceManifest::validate(const void *data, size_t size) {
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  blob = nullptr;
+  if (bytes == nullptr || size < sizeof(DeviceManifestHeader) ||
+      reinterpret_cast<uintptr_t>(bytes) % alignof(DeviceManifestHeader) != 0) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  const DeviceManifestHeader *candidate = reinterpret_cast<const DeviceManifestHeader *>(bytes);
+  if (candidate->magic != kMagic || candidate->version != kVersion) {
+    ESP_LOGE(__FILENAME__, "Unsupported device manifest, magic 0x%08lx version %u",
+             static_cast<unsigned long>(candidate->magic), candidate->version);
+    return ESP_ERR_INVALID_VERSION;
+  }
+
+  // Bounds of the tables only, the strings themselves are never scanned. The tables must not
+  // overlap the header or each other.
+  uint64_t entriesEnd =
+      static_cast<uint64_t>(candidate->entriesOffset) + candidate->deviceCount * sizeof(DeviceManifestEntry);
+  uint64_t stringsEnd = static_cast<uint64_t>(candidate->stringsOffset) + candidate->stringsSize;
+  bool disjoint = entriesEnd <= candidate->stringsOffset || stringsEnd <= candidate->entriesOffset;
+  if (candidate->totalSize > size || candidate->entriesOffset % alignof(DeviceManifestEntry) != 0 ||
+      candidate->entriesOffset < sizeof(DeviceManifestHeader) ||
+      candidate->stringsOffset < sizeof(DeviceManifestHeader) || !disjoint || entriesEnd > candidate->totalSize ||
+      stringsEnd > candidate->totalSize || (candidate->stringsSize > 0 && bytes[stringsEnd - 1] != '\0')) {
+    ESP_LOGE(__FILENAME__, "Malformed device manifest");
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  blob = bytes;
+  header = candidate;
+  entries = reinterpret_cast<const DeviceManifestEntry *>(bytes + candidate->entriesOffset);
+  strings = reinterpret_cast<const char *>(bytes + candidate->stringsOffset);
+  ESP_LOGI(__FILENAME__, "Device manifest with %u devices", header->deviceCount);
+  return ESP_OK;
+}
+
+esp_err_t DeviceManifest::mapPartition(const char *label) {
+  release();
+  const esp_partition_t *partition =
+      esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+  if (partition == nullptr) {
+    ESP_LOGE(__FILENAME__, "Device manifest partition %s not found", label);
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  const void *data = nullptr;
+  esp_err_t err = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA, &data, &mapHandle);
+  if (err != ESP_OK) {
+    return err;
+  }
+  mapped = true;
+
+  err = validate(data, partition->size);
+  if (err != ESP_OK) {
+    release();
+  }
+  return err;
+}
+
+esp_err_t DeviceManifest::loadFile(const char *path) {
+  release();
+  FILE *file = fopen(path, "rb");
+  if (file == nullptr) {
+    ESP_LOGE(__FILENAME__, "Cannot open device manifest %s", path);
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  esp_err_t err = ESP_ERR_NOT_FOUND;
+  long size = 0;
+  if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) > 0 && fseek(file, 0, SEEK_SET) == 0) {
+    fileBuffer = static_cast<uint8_t *>(malloc(static_cast<size_t>(size)));
+    if (fileBuffer == nullptr) {
+      err = ESP_ERR_NO_MEM;
+    } else if (fread(fileBuffer, 1, static_cast<size_t>(size), file) == static_cast<size_t>(size)) {
+      err = validate(fileBuffer, static_cast<size_t>(size));
+    }
+  }
+  fclose(file);
+
+  if (err != ESP_OK) {
+    release();
+  }
+  return err;
+}
+
+uint16_t DeviceManifest::deviceCount() const { return blob != nullptr ? header->deviceCount : 0; }
+
+const DeviceManifestEntry *DeviceManifest::entry(uint16_t index) const {
+  if (index >= deviceCount()) {
+    return nullptr;
+  }
+  return &entries[index];
+}
+
+const char *DeviceManifest::name(uint16_t index) const {
+  const DeviceManifestEntry *device = entry(index);
+  if (device == nullptr || device->nameOffset == kNoName || device->nameOffset >= header->stringsSize) {
+    return nullptr;
+  }
+  return strings + device->nameOffset;
+}
+
+size_t DeviceManifest::instantiate(AccessoryResolver resolver, void *context, esp_matter::endpoint_t *aggregator,
+                                   BaseDevice **devices, size_t capacity) const {
+  size_t created = 0;
+  for (uint16_t index = 0; index < deviceCount() && created < capacity; index++) {
+    const DeviceManifestEntry &device = entries[index];
+    DeviceType type = static_cast<DeviceType>(device.type);
+    void *accessory = resolver(context, type, device.accessoryId);
+    if (accessory == nullptr) {
+      ESP_LOGW(__FILENAME__, "No accessory %u for manifest entry %u, skipping", device.accessoryId, index);
+      continue;
+    }
+
+    BorrowedName deviceName = {name(index)};
+    esp_matter::endpoint_t *parent = (device.flags & kFlagBridged) ? aggregator : nullptr;
+    BaseDevice *instance = nullptr;
+    HeapAudit audit;
+    switch (type) {
+      case DeviceType::Light:
+        instance = new (std::nothrow)
+            LightDevice(deviceName, static_cast<LightAccessoryInterface *>(accessory), parent);
+        break;
+      case DeviceType::PlugIn:
+        instance = new (std::nothrow)
+            PlugInDevice(deviceName, static_cast<PluginAccessoryInterface *>(accessory), parent);
+        break;
+      case DeviceType::Fan:
+        instance =
+            new (std::nothrow) FanDevice(deviceName, static_cast<FanAccessoryInterface *>(accessory), parent);
+        break;
+      case DeviceType::Window:
+        instance = new (std::nothrow)
+            WindowDevice(deviceName, static_cast<BlindAccessoryInterface *>(accessory), parent);
+        break;
+      case DeviceType::Button:
+        instance = new (std::nothrow)
+            ButtonDevice(deviceName, static_cast<StatelessButtonAccessoryInterface *>(accessory), parent);
+        break;
+      case DeviceType::DimmableLight:
+        instance = new (std::nothrow)
+            DimmableLightDevice(deviceName, static_cast<DimmableLightAccessoryInterface *>(accessory), parent);
+        break;
+      case DeviceType::MultiChannel:
+        instance = new (std::nothrow)
+            MultiChannelDevice(deviceName, static_cast<MultiChannelAccessoryInterface *>(accessory), parent,
+                               static_cast<MultiChannelDevice::ChannelType>(device.option));
+        break;
+      case DeviceType::TemperatureSensor:
+        instance = new (std::nothrow) SensorDevice(deviceName, static_cast<SensorAccessoryInterface *>(accessory),
+                                                   parent, SensorDevice::SensorType::Temperature);
+        break;
+      case DeviceType::HumiditySensor:
+        instance = new (std::nothrow) SensorDevice(deviceName, static_cast<SensorAccessoryInterface *>(accessory),
+                                                   parent, SensorDevice::SensorType::Humidity);
+        break;
+      case DeviceType::OccupancySensor:
+        instance = new (std::nothrow) SensorDevice(deviceName, static_cast<SensorAccessoryInterface *>(accessory),
+                                                   parent, SensorDevice::SensorType::Occupancy);
+        break;
+      default:
+        ESP_LOGW(__FILENAME__, "Unknown device type %u in manifest entry %u, skipping", device.type, index);
+        continue;
+    }
+
+    if (instance == nullptr) {
+      ESP_LOGE(__FILENAME__, "Out of memory at manifest entry %u", index);
+      break;
+    }
+    audit.check(type);
+    devices[created++] = instance;
+  }
+  return created;
+}
+
+void DeviceManifest::release() {
+  if (mapped) {
+    esp_partition_munmap(mapHandle);
+    mapped = false;
+  }
+  free(fileBuffer);
+  fileBuffer = nullptr;
+  blob = nullptr;
+  header = nullptr;
+  entries = nullptr;
+  strings = nullptr;
+}
@@ -0,0 +1,47 @@
+#include "DeviceName.hpp"
+
+#include <esp_log.h>
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+namespace {
+
+bool isValid(const char *name) { return name != nullptr && name[0] != '\0' && strlen(name) <= DeviceName::kMaxLength; }
+
+}  // namespace
+
+DeviceName::DeviceName(const char *name) : text(""), owned(false) {
+  if (!isValid(name)) {
+    return;
+  }
+  size_t size = strlen(name) + 1;
+  char *copy = new (std::nothrow) char[size];
+  if (copy == nullptr) {
+    ESP_LOGE(__FILENAME__, "Out of memory copying device name %s", name);
+    return;
+  }
+  memcpy(copy, name, size);
+  text = copy;
+  owned = true;
+}
+
+DeviceName::DeviceName(BorrowedName name) : text(isValid(name.text) ? name.text : ""), owned(false) {}
+
+DeviceName::DeviceName(DeviceName &&other) : text(other.text), owned(other.owned) {
+  other.text = "";
+  other.owned = false;
+}
+
+DeviceName::~DeviceName() {
+  if (owned) {
+    delete[] text;
+  }
+}
+
+const char *DeviceName::get() const { return text; }
+
+size_t DeviceName::length() const { return strlen(text); }
+
+bool DeviceName::isBorrowed() const { return !owned && text[0] != '\0'; }
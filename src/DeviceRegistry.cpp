@@ -0,0 +1,115 @@
+#include "DeviceRegistry.hpp"
+
+#include <BaseDevice.hpp>
+#include <DeviceSnapshot.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+BaseDevice *DeviceRegistry::head = nullptr;
+BaseDevice *DeviceRegistry::tail = nullptr;
+size_t DeviceRegistry::size = 0;
+BaseDevice *DeviceRegistry::cursor = nullptr;
+
+std::recursive_mutex &DeviceRegistry::listMutex() {
+  static std::recursive_mutex mutex;
+  return mutex;
+}
+
+void DeviceRegistry::add(BaseDevice *device) {
+  std::lock_guard<std::recursive_mutex> guard(listMutex());
+  // Append so that snapshot rows follow construction order
+  device->nextDevice = nullptr;
+  if (tail == nullptr) {
+    head = device;
+  } else {
+    tail->nextDevice = device;
+  }
+  tail = device;
+  size++;
+}
+
+void DeviceRegistry::remove(BaseDevice *device) {
+  std::lock_guard<std::recursive_mutex> guard(listMutex());
+  BaseDevice *previous = nullptr;
+  for (BaseDevice **link = &head; *link != nullptr; previous = *link, link = &(*link)->nextDevice) {
+    if (*link == device) {
+      if (cursor == device) {
+        cursor = device->nextDevice;
+      }
+      if (tail == device) {
+        tail = previous;
+      }
+      *link = device->nextDevice;
+      device->nextDevice = nullptr;
+      size--;
+      return;
+    }
+  }
+}
+
+size_t DeviceRegistry::count() {
+  std::lock_guard<std::recursive_mutex> guard(listMutex());
+  return size;
+}
+
+void DeviceRegistry::forEach(void (*callback)(BaseDevice *device, void *context), void *context) {
+  std::lock_guard<std::recursive_mutex> guard(listMutex());
+  for (BaseDevice *device = head; device != nullptr; device = device->nextDevice) {
+    callback(device, context);
+  }
+}
+
+size_t DeviceRegistry::forNext(size_t maxDevices, void (*callback)(BaseDevice *device, void *context),
+                               void *context) {
+  std::lock_guard<std::recursive_mutex> guard(listMutex());
+  size_t visited = 0;
+  while (visited < maxDevices && visited < size) {
+    if (cursor == nullptr) {
+      cursor = head;
+    }
+    BaseDevice *device = cursor;
+    cursor = device->nextDevice;
+    callback(device, context);
+    visited++;
+  }
+  return visited;
+}
+
+bool DeviceRegistry::forEndpoint(uint16_t endpointId, void (*callback)(BaseDevice *device, void *context),
+                                 void *context) {
+  std::lock_guard<std::recursive_mutex> guard(listMutex());
+  uint16_t endpointIds[BaseDevice::kMaxEndpoints];
+  for (BaseDevice *device = head; device != nullptr; device = device->nextDevice) {
+    size_t count = device->getEndpointIds(endpointIds, BaseDevice::kMaxEndpoints);
+    for (size_t i = 0; i < count; i++) {
+      if (endpointIds[i] == endpointId) {
+        callback(device, context);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+size_t DeviceRegistry::snapshot(DeviceSnapshot &snapshot) {
+  std::lock_guard<std::recursive_mutex> guard(listMutex());
+  size_t index = 0;
+  for (BaseDevice *device = head; device != nullptr && index < snapshot.capacity; device = device->nextDevice) {
+    // Clear the row so devices only write the columns they own
+    if (snapshot.endpointIds != nullptr) snapshot.endpointIds[index] = 0;
+    if (snapshot.types != nullptr) snapshot.types[index] = DeviceType::Unknown;
+    if (snapshot.fanPercent != nullptr) snapshot.fanPercent[index] = 0;
+    if (snapshot.windowCurrentPosition != nullptr) snapshot.windowCurrentPosition[index] = 0;
+    if (snapshot.windowTargetPosition != nullptr) snapshot.windowTargetPosition[index] = 0;
+    if (snapshot.buttonLastPress != nullptr) snapshot.buttonLastPress[index] = DeviceSnapshot::kNoPress;
+    if (snapshot.lightLevel != nullptr) snapshot.lightLevel[index] = 0;
+    if (snapshot.channelMask != nullptr) snapshot.channelMask[index] = 0;
+    if (snapshot.sensorValue != nullptr) snapshot.sensorValue[index] = 0;
+    snapshot.setPower(index, false);
+
+    device->fillSnapshot(snapshot, index);
+    index++;
+  }
+  return index;
+}
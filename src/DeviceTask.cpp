@@ -0,0 +1,94 @@
+#include "DeviceTask.hpp"
+
+#include <esp_log.h>
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+
+namespace {
+
+static_assert(DeviceTask::kMaxFrames <= 32, "The frame pool is tracked in a 32 bit mask");
+
+// Fixed frame pool, a set bit marks a slot in use
+alignas(std::max_align_t) unsigned char framePool[DeviceTask::kMaxFrames][DeviceTask::kFrameSize];
+uint32_t usedFrames = 0;
+std::mutex poolMutex;
+
+}  // namespace
+
+void *DeviceTask::promise_type::operator new(size_t size) noexcept {
+  if (size > kFrameSize) {
+    ESP_LOGE(__FILENAME__, "Coroutine frame of %u bytes exceeds the %u byte slot", static_cast<unsigned>(size),
+             static_cast<unsigned>(kFrameSize));
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> guard(poolMutex);
+  for (size_t slot = 0; slot < kMaxFrames; slot++) {
+    if ((usedFrames & (1u << slot)) == 0) {
+      usedFrames |= 1u << slot;
+      return framePool[slot];
+    }
+  }
+  ESP_LOGW(__FILENAME__, "Coroutine frame pool exhausted");
+  return nullptr;
+}
+
+void DeviceTask::promise_type::operator delete(void *frame) noexcept {
+  size_t slot = static_cast<size_t>(static_cast<unsigned char *>(frame) - framePool[0]) / kFrameSize;
+  std::lock_guard<std::mutex> guard(poolMutex);
+  usedFrames &= ~(1u << slot);
+}
+
+void DeviceTask::promise_type::unhandled_exception() const noexcept { abort(); }
+
+std::coroutine_handle<> DeviceTask::FinalAwaiter::await_suspend(Handle handle) noexcept {
+  // A spawned task stays suspended for the executor to destroy, an awaited one resumes its caller
+  std::coroutine_handle<> continuation = handle.promise().continuation;
+  if (continuation) {
+    return continuation;
+  }
+  return std::noop_coroutine();
+}
+
+std::coroutine_handle<> DeviceTask::Awaiter::await_suspend(Handle awaiting) noexcept {
+  promise_type &promise = handle.promise();
+  promise.executor = awaiting.promise().executor;
+  promise.taskId = awaiting.promise().taskId;
+  promise.continuation = awaiting;
+  return handle;
+}
+
+DeviceTask::~DeviceTask() {
+  if (handle) {
+    handle.destroy();
+  }
+}
+
+DeviceTask::DeviceTask(DeviceTask &&other) noexcept : handle(other.release()) {}
+
+DeviceTask &DeviceTask::operator=(DeviceTask &&other) noexcept {
+  if (this != &other) {
+    if (handle) {
+      handle.destroy();
+    }
+    handle = other.release();
+  }
+  return *this;
+}
+
+bool DeviceTask::isValid() const { return static_cast<bool>(handle); }
+
+size_t DeviceTask::framesInUse() {
+  std::lock_guard<std::mutex> guard(poolMutex);
+  return static_cast<size_t>(__builtin_popcount(usedFrames));
+}
+
+DeviceTask::Handle DeviceTask::release() {
+  Handle released = handle;
+  handle = Handle();
+  return released;
+}
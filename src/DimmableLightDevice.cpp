@@ -0,0 +1,271 @@
+#include "DimmableLightDevice.hpp"
+
+#include <esp_err.h>
+#include <esp_log.h>
+#include <esp_matter.h>
+#include <esp_matter_endpoint.h>
+
+#include <DeviceName.hpp>
+#include <FadeEngine.hpp>
+#include <SeqLock.hpp>
+#include <StateStream.hpp>
+#include <TimerWheel.hpp>
+#include <cstdint>
+#include <utility>
+
+namespace {
+
+// Stack steps further apart than this belong to different transitions and are not smoothed
+constexpr uint32_t kMaxStepFadeMs = 1000;
+
+uint32_t wheelNowMs() { return static_cast<uint32_t>(TimerWheel::device().now() * TimerWheel::kTickMs); }
+
+}  // namespace
+
+DimmableLightDevice::DimmableLightDevice(DeviceName device_name, DimmableLightAccessoryInterface *lightAccessory,
+                                         esp_matter::endpoint_t *aggregator)
+    : BaseDevice(),
+      lightAccessory(lightAccessory),
+      name(std::move(device_name)),
+      shadow(State{false, 0, 0}),
+      transitioning(false),
+      lastStackStepMs(0) {
+  // Set up the callback for reporting attributes
+  if (lightAccessory != nullptr) {
+    lightAccessory->setReportAppCallback(
+        [](void *self) { static_cast<DimmableLightDevice *>(self)->onAccessoryReport(); }, this);
+  }
+
+  // Check if an aggregator is provided
+  if (aggregator != nullptr) {
+    esp_matter::endpoint::bridged_node::config_t bridged_node_config;
+    uint8_t flags = esp_matter::endpoint_flags::ENDPOINT_FLAG_BRIDGE |
+                    esp_matter::endpoint_flags::ENDPOINT_FLAG_DESTROYABLE;
+    endpoint = esp_matter::endpoint::bridged_node::create(esp_matter::node::get(), &bridged_node_config,
+                                                          flags, this);
+    if (name.length() > 0) {
+      ESP_LOGI(__FILENAME__, "Creating Bridged Node DimmableLightDevice with name: %s", name.get());
+      esp_matter::cluster_t *bridge_device_basic_information_cluster =
+          esp_matter::cluster::get(endpoint, chip::app::Clusters::BridgedDeviceBasicInformation::Id);
+      esp_matter::cluster::bridged_device_basic_information::attribute::create_node_label(
+          bridge_device_basic_information_cluster, name.get(), name.length());
+    } else {
+      ESP_LOGW(__FILENAME__, "device_name is not set");
+      ESP_LOGI(__FILENAME__, "Creating Bridged Node DimmableLightDevice with default name");
+    }
+    esp_matter::endpoint::set_parent_endpoint(endpoint, aggregator);
+  } else {
+    ESP_LOGI(__FILENAME__, "Creating DimmableLightDevice standalone endpoint");
+    uint8_t flags = esp_matter::endpoint_flags::ENDPOINT_FLAG_NONE;
+    endpoint = esp_matter::endpoint::create(esp_matter::node::get(), flags, this);
+  }
+
+  esp_matter::endpoint::dimmable_light::config_t light_config;
+  esp_matter::endpoint::dimmable_light::add(endpoint, &light_config);
+
+  // Bring the accessory to the stored state without a fade
+  loadShadow();
+  uint8_t level = getEndpointLevel();
+  cacheLevel(level);
+  setAccessoryPowerState(getEndpointPowerState());
+  setAccessoryLevel(level);
+
+  registerDevice();
+}
+
+DimmableLightDevice::~DimmableLightDevice() {
+  unregisterDevice();
+  FadeEngine::instance().cancel(this);
+}
+
+esp_err_t DimmableLightDevice::updateAccessory() {
+  if (!isReachable()) {
+    ESP_LOGW(__FILENAME__, "Rejecting update, accessory unreachable");
+    return ESP_ERR_INVALID_STATE;
+  }
+  esp_err_t err = loadShadow();
+  if (err != ESP_OK) {
+    ESP_LOGE(__FILENAME__, "Cannot read DimmableLightDevice endpoint state: %s", esp_err_to_name(err));
+    return err;
+  }
+  bool powerState = getEndpointPowerState();
+  uint8_t level = getEndpointLevel();
+
+  // The Level Control server runs the transition of the command and steps CurrentLevel itself.
+  // A step that follows another step of the same transition is faded over the time between them.
+  uint32_t nowMs = wheelNowMs();
+  uint32_t fadeMs = 0;
+  if (transitioning.load() && nowMs - lastStackStepMs <= kMaxStepFadeMs) {
+    fadeMs = nowMs - lastStackStepMs;
+  }
+  transitioning.store(getEndpointRemainingTime() > 0);
+  lastStackStepMs = nowMs;
+  ESP_LOGD(__FILENAME__, "Updating DimmableLightDevice Accessory with powerState: %d, level: %d, fade: %lu ms",
+           powerState, level, static_cast<unsigned long>(fadeMs));
+
+  setAccessoryPowerState(powerState);
+  if (!powerState) {
+    FadeEngine::instance().cancel(this);
+    return ESP_OK;
+  }
+
+  return FadeEngine::instance().start(
+      [](void *self, uint8_t stepLevel, bool finished) {
+        static_cast<DimmableLightDevice *>(self)->onFadeStep(stepLevel, finished);
+      },
+      this, shadow.read().level, level, fadeMs);
+}
+
+esp_err_t DimmableLightDevice::reportEndpoint() {
+  if (lightAccessory == nullptr) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  bool powerState = lightAccessory->getPower();
+  uint8_t level = lightAccessory->getLevel();
+  ESP_LOGI(__FILENAME__, "Reporting DimmableLightDevice Endpoint with powerState: %d, level: %d", powerState, level);
+
+  esp_err_t err = setEndpointPowerState(powerState);
+  esp_err_t level_err = setEndpointLevel(level);
+  cachePowerState(powerState);
+  cacheLevel(level);
+  return err != ESP_OK ? err : level_err;
+}
+
+esp_err_t DimmableLightDevice::identify() {
+  ESP_LOGI(__FILENAME__, "Identifying DimmableLightDevice");
+  if (lightAccessory == nullptr) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  lightAccessory->identifyYourSelf();
+  return ESP_OK;
+}
+
+void DimmableLightDevice::fillSnapshot(DeviceSnapshot &snapshot, size_t index) const {
+  if (snapshot.endpointIds != nullptr) snapshot.endpointIds[index] = esp_matter::endpoint::get_id(endpoint);
+  if (snapshot.types != nullptr) snapshot.types[index] = DeviceType::DimmableLight;
+  State state = shadow.read();
+  if (snapshot.lightLevel != nullptr) snapshot.lightLevel[index] = state.level;
+  snapshot.setPower(index, state.powerState);
+}
+
+size_t DimmableLightDevice::getEndpointIds(uint16_t *endpointIds, size_t capacity) const {
+  if (capacity == 0) {
+    return 0;
+  }
+  endpointIds[0] = esp_matter::endpoint::get_id(endpoint);
+  return 1;
+}
+
+DimmableLightDevice::State DimmableLightDevice::getState() const { return shadow.read(); }
+
+void DimmableLightDevice::onFadeStep(uint8_t level, bool) {
+  // Cache first, so the report callback of the step compares against this level. CurrentLevel
+  // belongs to the Level Control server, fade steps are never reported.
+  cacheLevel(level);
+  setAccessoryLevel(level);
+}
+
+bool DimmableLightDevice::getEndpointPowerState() { return shadow.read().powerState; }
+
+void DimmableLightDevice::onAccessoryReport() {
+  State state = shadow.read();
+  if (isWriteEcho(lightAccessory->getPower() == state.powerState && lightAccessory->getLevel() == state.level)) {
+    return;
+  }
+  if (transitioning.load()) {
+    // The stack owns CurrentLevel until its transition ends, only the power state is reported
+    bool powerState = lightAccessory->getPower();
+    setEndpointPowerState(powerState);
+    cachePowerState(powerState);
+    return;
+  }
+  reportEndpoint();
+}
+
+void DimmableLightDevice::setAccessoryPowerState(bool powerState) {
+  if (lightAccessory == nullptr) {
+    return;
+  }
+  markAccessoryWrite();
+  lightAccessory->setPower(powerState);
+}
+
+void DimmableLightDevice::setAccessoryLevel(uint8_t level) {
+  if (lightAccessory == nullptr) {
+    return;
+  }
+  markAccessoryWrite();
+  lightAccessory->setLevel(level);
+}
+
+uint8_t DimmableLightDevice::getEndpointLevel() { return shadow.read().targetLevel; }
+
+esp_err_t DimmableLightDevice::loadShadow() {
+  esp_matter::cluster_t *on_off_cluster = esp_matter::cluster::get(endpoint, chip::app::Clusters::OnOff::Id);
+  esp_matter::attribute_t *on_off_attribute =
+      esp_matter::attribute::get(on_off_cluster, chip::app::Clusters::OnOff::Attributes::OnOff::Id);
+  esp_matter::cluster_t *level_cluster =
+      esp_matter::cluster::get(endpoint, chip::app::Clusters::LevelControl::Id);
+  esp_matter::attribute_t *current_level_attribute =
+      esp_matter::attribute::get(level_cluster, chip::app::Clusters::LevelControl::Attributes::CurrentLevel::Id);
+  if (on_off_attribute == nullptr || current_level_attribute == nullptr) {
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  esp_matter_attr_val_t on_off_val;
+  esp_err_t err = esp_matter::attribute::get_val(on_off_attribute, &on_off_val);
+  if (err != ESP_OK) {
+    return err;
+  }
+  esp_matter_attr_val_t level_val;
+  err = esp_matter::attribute::get_val(current_level_attribute, &level_val);
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  uint8_t targetLevel = level_val.val.u8;
+  shadow.modify([targetLevel](State &state) { state.targetLevel = targetLevel; });
+  cachePowerState(on_off_val.val.b);
+  return ESP_OK;
+}
+
+uint16_t DimmableLightDevice::getEndpointRemainingTime() {
+  esp_matter::cluster_t *level_cluster =
+      esp_matter::cluster::get(endpoint, chip::app::Clusters::LevelControl::Id);
+  esp_matter::attribute_t *remaining_attribute =
+      esp_matter::attribute::get(level_cluster, chip::app::Clusters::LevelControl::Attributes::RemainingTime::Id);
+  if (remaining_attribute == nullptr) {
+    return 0;
+  }
+  esp_matter_attr_val_t attr_val;
+  if (esp_matter::attribute::get_val(remaining_attribute, &attr_val) != ESP_OK) {
+    return 0;
+  }
+  return attr_val.val.u16;
+}
+
+esp_err_t DimmableLightDevice::setEndpointPowerState(bool powerState) {
+  esp_matter_attr_val_t attr_val = esp_matter_bool(powerState);
+  return reportAttribute(esp_matter::endpoint::get_id(endpoint), chip::app::Clusters::OnOff::Id,
+                         chip::app::Clusters::OnOff::Attributes::OnOff::Id, &attr_val);
+}
+
+esp_err_t DimmableLightDevice::setEndpointLevel(uint8_t level) {
+  esp_matter_attr_val_t attr_val = esp_matter_nullable_uint8(level);
+  return reportAttribute(esp_matter::endpoint::get_id(endpoint), chip::app::Clusters::LevelControl::Id,
+                         chip::app::Clusters::LevelControl::Attributes::CurrentLevel::Id, &attr_val);
+}
+
+void DimmableLightDevice::cachePowerState(bool powerState) {
+  State previous = shadow.modify([powerState](State &state) { state.powerState = powerState; });
+  if (previous.powerState != powerState) {
+    StateStreamEncoder::emit(esp_matter::endpoint::get_id(endpoint), StateChangeKind::Power, powerState);
+  }
+}
+
+void DimmableLightDevice::cacheLevel(uint8_t level) {
+  State previous = shadow.modify([level](State &state) { state.level = level; });
+  if (previous.level != level) {
+    StateStreamEncoder::emit(esp_matter::endpoint::get_id(endpoint), StateChangeKind::Level, level);
+  }
+}
@@ -0,0 +1,94 @@
+#include "EspTimerTickSource.hpp"
+
+#include <esp_err.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <TimerWheel.hpp>
+#include <atomic>
+#include <cstdint>
+
+EspTimerTickSource::EspTimerTickSource(TimerWheel &wheel, uint32_t stackSize, UBaseType_t priority)
+    : wheel(wheel),
+      stackSize(stackSize),
+      priority(priority),
+      timer(nullptr),
+      task(nullptr),
+      exiting(false),
+      exited(false),
+      restarted(false),
+      lastTickUs(0) {}
+
+EspTimerTickSource::~EspTimerTickSource() {
+  stop();
+  if (timer != nullptr) {
+    esp_timer_delete(timer);
+  }
+  if (task != nullptr) {
+    // Let the task finish its current advance and leave on its own
+    exiting.store(true);
+    xTaskNotifyGive(task);
+    while (!exited.load()) {
+      vTaskDelay(1);
+    }
+  }
+}
+
+esp_err_t EspTimerTickSource::start() {
+  if (task == nullptr) {
+    if (xTaskCreate([](void *self) { static_cast<EspTimerTickSource *>(self)->run(); }, "timer_wheel", stackSize,
+                    this, priority, &task) != pdPASS) {
+      ESP_LOGE(__FILENAME__, "Failed to create timer wheel task");
+      task = nullptr;
+      return ESP_ERR_NO_MEM;
+    }
+  }
+  if (timer == nullptr) {
+    esp_timer_create_args_t timer_args = {};
+    timer_args.callback = [](void *self) { xTaskNotifyGive(static_cast<EspTimerTickSource *>(self)->task); };
+    timer_args.arg = this;
+    timer_args.dispatch_method = ESP_TIMER_TASK;
+    timer_args.name = "timer_wheel";
+    esp_err_t err = esp_timer_create(&timer_args, &timer);
+    if (err != ESP_OK) {
+      ESP_LOGE(__FILENAME__, "Failed to create timer wheel tick: %s", esp_err_to_name(err));
+      timer = nullptr;
+      return err;
+    }
+  }
+  // The task owns lastTickUs, it restarts the count on its next notification
+  restarted.store(true);
+  return esp_timer_start_periodic(timer, TimerWheel::kTickMs * 1000);
+}
+
+void EspTimerTickSource::stop() {
+  if (timer != nullptr) {
+    esp_timer_stop(timer);
+  }
+}
+
+void EspTimerTickSource::run() {
+  constexpr int64_t kTickUs = TimerWheel::kTickMs * 1000;
+  while (true) {
+    // Notifications that pile up while the wheel runs late are taken at once
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    if (exiting.load()) {
+      break;
+    }
+    int64_t nowUs = esp_timer_get_time();
+    if (restarted.exchange(false)) {
+      lastTickUs = nowUs;
+      continue;
+    }
+    int64_t ticks = (nowUs - lastTickUs) / kTickUs;
+    if (ticks <= 0) {
+      continue;
+    }
+    lastTickUs += ticks * kTickUs;
+    wheel.advance(static_cast<uint32_t>(ticks));
+  }
+  exited.store(true);
+  vTaskDelete(nullptr);
+}
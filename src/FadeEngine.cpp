@@ -0,0 +1,156 @@
+#include "FadeEngine.hpp"
+
+#include <esp_err.h>
+#include <esp_log.h>
+
+#include <TimerWheel.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+FadeEngine &FadeEngine::instance() {
+  static FadeEngine engine;
+  return engine;
+}
+
+FadeEngine::FadeEngine()
+    : fades(), active(0), steps(), stepCount(0), delivering(nullptr), tickThread(), timer(), timerRunning(false) {}
+
+esp_err_t FadeEngine::start(StepCallback callback, void *context, uint8_t from, uint8_t to, uint32_t durationMs) {
+  uint32_t ticks = durationMs / kTickMs;
+  if (ticks == 0 || from == to) {
+    // Nothing to fade, step straight to the target
+    cancel(context);
+    callback(context, to, true);
+    return ESP_OK;
+  }
+
+  std::lock_guard<std::mutex> guard(fadeMutex);
+  Fade *slot = nullptr;
+  for (size_t i = 0; i < active; i++) {
+    if (fades[i].context == context) {
+      slot = &fades[i];
+      break;
+    }
+  }
+  if (slot == nullptr) {
+    if (active == kMaxFades) {
+      ESP_LOGW(__FILENAME__, "Fade table full");
+      return ESP_ERR_NO_MEM;
+    }
+    slot = &fades[active++];
+  }
+  // A pending step of the replaced fade must not overwrite the new one
+  dropSteps(context);
+
+  slot->callback = callback;
+  slot->context = context;
+  slot->level = static_cast<int32_t>(from) << 16;
+  slot->step = ((static_cast<int32_t>(to) - static_cast<int32_t>(from)) << 16) / static_cast<int32_t>(ticks);
+  slot->remaining = ticks;
+  slot->target = to;
+
+  startTimer();
+  return ESP_OK;
+}
+
+void FadeEngine::cancel(void *context) {
+  bool fromCallback;
+  {
+    std::lock_guard<std::mutex> guard(fadeMutex);
+    for (size_t i = 0; i < active; i++) {
+      if (fades[i].context == context) {
+        fades[i] = fades[--active];
+        break;
+      }
+    }
+    dropSteps(context);
+    if (active == 0) {
+      stopTimer();
+    }
+    fromCallback = tickThread == std::this_thread::get_id();
+  }
+
+  // A step callback already running for the channel must return before the caller may free it
+  if (!fromCallback) {
+    while (delivering.load() == context) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+size_t FadeEngine::activeFades() {
+  std::lock_guard<std::mutex> guard(fadeMutex);
+  return active;
+}
+
+void FadeEngine::tick() {
+  size_t count = 0;
+
+  // Step every active fade in one pass, finished fades are swapped out of the packed table
+  {
+    std::lock_guard<std::mutex> guard(fadeMutex);
+    for (size_t i = 0; i < active;) {
+      Fade &fade = fades[i];
+      Step &step = steps[count++];
+      step.callback = fade.callback;
+      step.context = fade.context;
+      step.cancelled.store(false);
+      fade.remaining--;
+      step.finished = fade.remaining == 0;
+      if (step.finished) {
+        step.level = fade.target;
+        fades[i] = fades[--active];
+      } else {
+        fade.level += fade.step;
+        step.level = static_cast<uint8_t>((fade.level + (1 << 15)) >> 16);
+        i++;
+      }
+    }
+    stepCount = count;
+    tickThread = std::this_thread::get_id();
+    if (active == 0) {
+      stopTimer();
+    }
+  }
+
+  // Deliver outside of the lock so the callbacks may report. Publishing the context before
+  // checking the flag pairs with cancel(), which sets the flag before checking the context.
+  for (size_t i = 0; i < count; i++) {
+    Step &step = steps[i];
+    delivering.store(step.context);
+    if (!step.cancelled.load()) {
+      step.callback(step.context, step.level, step.finished);
+    }
+  }
+  delivering.store(nullptr);
+
+  std::lock_guard<std::mutex> guard(fadeMutex);
+  stepCount = 0;
+}
+
+void FadeEngine::dropSteps(void *context) {
+  for (size_t i = 0; i < stepCount; i++) {
+    if (steps[i].context == context) {
+      steps[i].cancelled.store(true);
+    }
+  }
+}
+
+void FadeEngine::startTimer() {
+  if (timerRunning) {
+    return;
+  }
+  uint32_t ticks = TimerWheel::msToTicks(kTickMs);
+  TimerWheel::device().schedule(
+      timer, ticks, [](void *self) { static_cast<FadeEngine *>(self)->tick(); }, this, ticks);
+  timerRunning = true;
+}
+
+void FadeEngine::stopTimer() {
+  if (timerRunning) {
+    TimerWheel::device().cancel(timer);
+    timerRunning = false;
+  }
+}
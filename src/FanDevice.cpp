@@ -5,16 +5,20 @@
 #include <esp_matter.h>
 #include <esp_matter_endpoint.h>
 
+#include <DeviceName.hpp>
+#include <SeqLock.hpp>
+#include <StateStream.hpp>
 #include <cstdint>
+#include <utility>
 
-FanDevice::FanDevice(const char *device_name, FanAccessoryInterface *fanAccessory,
+FanDevice::FanDevice(DeviceName device_name, FanAccessoryInterface *fanAccessory,
                      esp_matter::endpoint_t *aggregator)
-    : BaseDevice() {
+    : BaseDevice(), name(std::move(device_name)), shadow(State{0, 0}) {
   // Create the FanAccessory instance
   this->fanAccessory = fanAccessory;
 
   // Set up the callback for reporting attributes
-  fanAccessory->setReportAppCallback([](void *self) { static_cast<FanDevice *>(self)->reportEndpoint(); },
+  fanAccessory->setReportAppCallback([](void *self) { static_cast<FanDevice *>(self)->onAccessoryReport(); },
                                      this);
 
   // Check if an aggregator is provided
@@ -24,15 +28,12 @@ FanDevice::FanDevice(const char *device_name, FanAccessoryInterface *fanAccessor
                     esp_matter::endpoint_flags::ENDPOINT_FLAG_DESTROYABLE;
     endpoint = esp_matter::endpoint::bridged_node::create(esp_matter::node::get(), &bridged_node_config,
                                                           flags, this);
-    if (device_name != nullptr && strlen(device_name) > 0 &&
-        strlen(device_name) < 64)  // TODO: change to a define
-    {
-      strncpy(this->name, device_name, sizeof(this->name));
-      ESP_LOGI(__FILENAME__, "Creating Bridged Node FanDevice with name: %s", name);
+    if (name.length() > 0) {
+      ESP_LOGI(__FILENAME__, "Creating Bridged Node FanDevice with name: %s", name.get());
       esp_matter::cluster_t *bridge_device_basic_information_cluster =
           esp_matter::cluster::get(endpoint, chip::app::Clusters::BridgedDeviceBasicInformation::Id);
       esp_matter::cluster::bridged_device_basic_information::attribute::create_node_label(
-          bridge_device_basic_information_cluster, name, strlen(name));
+          bridge_device_basic_information_cluster, name.get(), name.length());
     } else {
       ESP_LOGW(__FILENAME__, "device_name is not set");
       ESP_LOGI(__FILENAME__, "Creating Bridged Node FanDevice with default name");
@@ -47,10 +48,24 @@ FanDevice::FanDevice(const char *device_name, FanAccessoryInterface *fanAccessor
   esp_matter::endpoint::fan::config_t fan_config;
   esp_matter::endpoint::fan::add(endpoint, &fan_config);
 
+  loadShadow();
   setAccessoryPowerState(getEndpointPowerState());
+
+  registerDevice();
 }
 
+FanDevice::~FanDevice() { unregisterDevice(); }
+
 esp_err_t FanDevice::updateAccessory() {
+  if (!isReachable()) {
+    ESP_LOGW(__FILENAME__, "Rejecting update, accessory unreachable");
+    return ESP_ERR_INVALID_STATE;
+  }
+  esp_err_t err = loadShadow();
+  if (err != ESP_OK) {
+    ESP_LOGE(__FILENAME__, "Cannot read FanDevice endpoint state: %s", esp_err_to_name(err));
+    return err;
+  }
   bool powerState = getEndpointPowerState();
   ESP_LOGI(__FILENAME__, "Updating FanDevice accessory with power state: %d", powerState);
   setAccessoryPowerState(powerState);
@@ -61,43 +76,73 @@ esp_err_t FanDevice::reportEndpoint() {
   bool powerState = getAccessoryPowerState();
   ESP_LOGI(__FILENAME__, "Reporting FanDevice endpoint with power state: %d", powerState);
 
-  setEndpointPowerState(powerState);
-  return ESP_OK;
+  esp_err_t err = setEndpointPowerState(powerState);
+  cachePercentSetting(powerState ? 100 : 0);
+  return err;
 }
 
 bool FanDevice::getAccessoryPowerState() { return fanAccessory->getPower(); }
 
-void FanDevice::setAccessoryPowerState(bool powerState) { fanAccessory->setPower(powerState); }
+void FanDevice::setAccessoryPowerState(bool powerState) {
+  markAccessoryWrite();
+  fanAccessory->setPower(powerState);
+}
 
-bool FanDevice::getEndpointPowerState() {
+void FanDevice::onAccessoryReport() {
+  bool powerState = getAccessoryPowerState();
+  if (isWriteEcho(powerState == getEndpointPowerState())) {
+    // The write only set PercentSetting, PercentCurrent follows what the accessory runs at
+    setEndpointPercentCurrent(powerState ? 100 : 0);
+    return;
+  }
+  reportEndpoint();
+}
+
+bool FanDevice::getEndpointPowerState() { return shadow.read().percentSetting != 0; }
+
+esp_err_t FanDevice::loadShadow() {
   esp_matter::cluster_t *fan_cluster =
       esp_matter::cluster::get(endpoint, chip::app::Clusters::FanControl::Id);
   esp_matter::attribute_t *fan_percent_setting_attribute = esp_matter::attribute::get(
       fan_cluster, chip::app::Clusters::FanControl::Attributes::PercentSetting::Id);
+  if (fan_percent_setting_attribute == nullptr) {
+    return ESP_ERR_NOT_FOUND;
+  }
   esp_matter_attr_val_t attr_val;
-  esp_matter::attribute::get_val(fan_percent_setting_attribute, &attr_val);
-
-  if (attr_val.val.u8 == 0) {
-    return false;
-  } else {
-    return true;
+  esp_err_t err = esp_matter::attribute::get_val(fan_percent_setting_attribute, &attr_val);
+  if (err != ESP_OK) {
+    return err;
   }
+
+  // The accessory is on/off only, any non-zero setting runs it at full speed
+  cachePercentSetting(attr_val.val.u8 == 0 ? 0 : 100);
+  return ESP_OK;
 }
 
-void FanDevice::setEndpointPowerState(bool powerState) {
-  esp_matter_attr_val_t percentCurrent_val = esp_matter_uint8(powerState ? 100 : 0);
-  esp_matter::attribute::report(esp_matter::endpoint::get_id(endpoint), chip::app::Clusters::FanControl::Id,
-                                chip::app::Clusters::FanControl::Attributes::PercentCurrent::Id,
-                                &percentCurrent_val);
+esp_err_t FanDevice::setEndpointPowerState(bool powerState) {
+  // Every attribute is reported even if one fails, the first error is returned
+  esp_err_t err = setEndpointPercentCurrent(powerState ? 100 : 0);
 
   esp_matter_attr_val_t fanMode_val = esp_matter_enum8(powerState ? 3 : 0);
-  esp_matter::attribute::report(esp_matter::endpoint::get_id(endpoint), chip::app::Clusters::FanControl::Id,
-                                chip::app::Clusters::FanControl::Attributes::FanMode::Id, &fanMode_val);
+  esp_err_t fanMode_err = reportAttribute(esp_matter::endpoint::get_id(endpoint), chip::app::Clusters::FanControl::Id,
+                                          chip::app::Clusters::FanControl::Attributes::FanMode::Id, &fanMode_val);
+  if (err == ESP_OK) err = fanMode_err;
 
   esp_matter_attr_val_t percentSetting_val = esp_matter_nullable_uint8(powerState ? 100 : 0);
-  esp_matter::attribute::report(esp_matter::endpoint::get_id(endpoint), chip::app::Clusters::FanControl::Id,
-                                chip::app::Clusters::FanControl::Attributes::PercentSetting::Id,
-                                &percentSetting_val);
+  esp_err_t percentSetting_err = reportAttribute(
+      esp_matter::endpoint::get_id(endpoint), chip::app::Clusters::FanControl::Id,
+      chip::app::Clusters::FanControl::Attributes::PercentSetting::Id, &percentSetting_val);
+  if (err == ESP_OK) err = percentSetting_err;
+  return err;
+}
+
+esp_err_t FanDevice::setEndpointPercentCurrent(uint8_t percent) {
+  esp_matter_attr_val_t percentCurrent_val = esp_matter_uint8(percent);
+  esp_err_t err = reportAttribute(esp_matter::endpoint::get_id(endpoint), chip::app::Clusters::FanControl::Id,
+                                  chip::app::Clusters::FanControl::Attributes::PercentCurrent::Id,
+                                  &percentCurrent_val);
+  cachePercentCurrent(percent);
+  return err;
 }
 
 esp_err_t FanDevice::identify() {
@@ -105,3 +150,32 @@ esp_err_t FanDevice::identify() {
   fanAccessory->identifyYourSelf();
   return ESP_OK;
 }
+
+void FanDevice::fillSnapshot(DeviceSnapshot &snapshot, size_t index) const {
+  State state = shadow.read();
+  if (snapshot.endpointIds != nullptr) snapshot.endpointIds[index] = esp_matter::endpoint::get_id(endpoint);
+  if (snapshot.types != nullptr) snapshot.types[index] = DeviceType::Fan;
+  if (snapshot.fanPercent != nullptr) snapshot.fanPercent[index] = state.percentCurrent;
+  snapshot.setPower(index, state.percentSetting != 0);
+}
+
+size_t FanDevice::getEndpointIds(uint16_t *endpointIds, size_t capacity) const {
+  if (capacity == 0) {
+    return 0;
+  }
+  endpointIds[0] = esp_matter::endpoint::get_id(endpoint);
+  return 1;
+}
+
+FanDevice::State FanDevice::getState() const { return shadow.read(); }
+
+void FanDevice::cachePercentSetting(uint8_t percent) {
+  shadow.modify([percent](State &state) { state.percentSetting = percent; });
+}
+
+void FanDevice::cachePercentCurrent(uint8_t percent) {
+  State previous = shadow.modify([percent](State &state) { state.percentCurrent = percent; });
+  if (previous.percentCurrent != percent) {
+    StateStreamEncoder::emit(esp_matter::endpoint::get_id(endpoint), StateChangeKind::FanPercent, percent);
+  }
+}
@@ -0,0 +1,93 @@
+#include "HealthSweep.hpp"
+
+#include <esp_err.h>
+#include <esp_log.h>
+#include <esp_matter.h>
+
+#include <BaseDevice.hpp>
+#include <DeviceRegistry.hpp>
+#include <TimerWheel.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+HealthSweep &HealthSweep::instance() {
+  static HealthSweep sweep;
+  return sweep;
+}
+
+HealthSweep::HealthSweep()
+    : devicesPerTick(kDefaultDevicesPerTick),
+      failThreshold(kDefaultFailThreshold),
+      recoverThreshold(kDefaultRecoverThreshold),
+      ticks(0),
+      probes(0),
+      transitions(0) {}
+
+esp_err_t HealthSweep::start(uint32_t periodMs, size_t devicesPerTick) {
+  if (devicesPerTick == 0 || devicesPerTick > kMaxDevicesPerTick) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  this->devicesPerTick.store(devicesPerTick);
+
+  uint32_t periodTicks = TimerWheel::msToTicks(periodMs);
+  ESP_LOGI(__FILENAME__, "Starting health sweep every %lu ms, %u devices per tick",
+           static_cast<unsigned long>(periodMs), static_cast<unsigned>(devicesPerTick));
+  TimerWheel::device().schedule(
+      timer, periodTicks, [](void *self) { static_cast<HealthSweep *>(self)->tick(); }, this, periodTicks);
+  return ESP_OK;
+}
+
+void HealthSweep::stop() { TimerWheel::device().cancel(timer); }
+
+void HealthSweep::setHysteresis(uint8_t failThreshold, uint8_t recoverThreshold) {
+  this->failThreshold.store(failThreshold > 0 ? failThreshold : 1);
+  this->recoverThreshold.store(recoverThreshold > 0 ? recoverThreshold : 1);
+}
+
+size_t HealthSweep::tick() {
+  struct Flips {
+    HealthSweep *sweep;
+    uint16_t endpointIds[kMaxDevicesPerTick];
+    size_t count;
+  } flips = {this, {}, 0};
+
+  // Probe under the registry lock, only recording the devices that flipped
+  size_t visited = DeviceRegistry::forNext(
+      devicesPerTick.load(),
+      [](BaseDevice *device, void *context) {
+        Flips *flips = static_cast<Flips *>(context);
+        HealthSweep *sweep = flips->sweep;
+        if (!device->probeHealth(sweep->failThreshold.load(), sweep->recoverThreshold.load())) {
+          return;
+        }
+        sweep->transitions.fetch_add(1, std::memory_order_relaxed);
+        if (device->getEndpointIds(&flips->endpointIds[flips->count], 1) == 1) {
+          flips->count++;
+        }
+      },
+      &flips);
+
+  // A device removed in between is not found again; reportReachable() finds the stack lock taken
+  if (flips.count > 0) {
+    esp_matter::lock::status_t lockStatus = esp_matter::lock::chip_stack_lock(portMAX_DELAY);
+    for (size_t i = 0; i < flips.count; i++) {
+      DeviceRegistry::forEndpoint(
+          flips.endpointIds[i], [](BaseDevice *device, void *) { device->reportReachable(); }, nullptr);
+    }
+    if (lockStatus == esp_matter::lock::SUCCESS) {
+      esp_matter::lock::chip_stack_unlock();
+    }
+  }
+  ticks.fetch_add(1, std::memory_order_relaxed);
+  probes.fetch_add(static_cast<uint32_t>(visited), std::memory_order_relaxed);
+  return visited;
+}
+
+HealthSweep::Stats HealthSweep::getStats() const {
+  Stats stats;
+  stats.ticks = ticks.load(std::memory_order_relaxed);
+  stats.probes = probes.load(std::memory_order_relaxed);
+  stats.transitions = transitions.load(std::memory_order_relaxed);
+  return stats;
+}
@@ -0,0 +1,127 @@
+#include "HeapAudit.hpp"
+
+#include <esp_err.h>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+
+#include <DeviceSnapshot.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace {
+
+constexpr size_t kTypeCount = static_cast<size_t>(DeviceType::OccupancySensor) + 1;
+
+// Bridged endpoint with its default clusters, the feature attributes of DeviceConfig and the
+// device object. MultiChannel grows with the channel count and has no budget.
+//
+// These are estimates, not measurements: esp_matter attribute and cluster sizes summed per
+// DeviceConfig with headroom, rounded up. The host benchmark cannot confirm them, its fake
+// esp_matter allocates one small block per object. To measure them, enable auditing, create
+// the devices of a representative manifest on the target and paste the rows printed by
+// HeapAudit::logWorst(), plus headroom for esp_matter updates.
+constexpr HeapAudit::Cost kBudgets[kTypeCount] = {
+    {0, 0},       // Unknown
+    {96, 5120},   // Light
+    {160, 8192},  // PlugIn, with power meter
+    {96, 5120},   // Fan
+    {128, 7168},  // Window, with absolute position
+    {80, 4096},   // Button
+    {128, 6656},  // DimmableLight
+    {0, 0},       // MultiChannel
+    {64, 3072},   // TemperatureSensor
+    {64, 3072},   // HumiditySensor
+    {64, 3072},   // OccupancySensor
+};
+
+std::atomic<uint32_t> worstBlocks[kTypeCount];
+std::atomic<uint32_t> worstBytes[kTypeCount];
+std::atomic<bool> enabled(false);
+std::atomic<HeapAudit::Sampler> sampler(nullptr);
+
+void raise(std::atomic<uint32_t> &worst, uint32_t value) {
+  uint32_t current = worst.load(std::memory_order_relaxed);
+  while (value > current && !worst.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
+
+HeapAudit::HeapAudit() : active(enabled.load()), start(active ? sample() : Cost{0, 0}) {}
+
+HeapAudit::Cost HeapAudit::sample() {
+  Sampler custom = sampler.load();
+  if (custom != nullptr) {
+    return custom();
+  }
+  multi_heap_info_t info;
+  heap_caps_get_info(&info, MALLOC_CAP_DEFAULT);
+  return Cost{static_cast<uint32_t>(info.allocated_blocks), static_cast<uint32_t>(info.total_allocated_bytes)};
+}
+
+HeapAudit::Cost HeapAudit::cost() const {
+  if (!active) {
+    return Cost{0, 0};
+  }
+  Cost now = sample();
+  Cost delta;
+  delta.blocks = now.blocks > start.blocks ? now.blocks - start.blocks : 0;
+  delta.bytes = now.bytes > start.bytes ? now.bytes - start.bytes : 0;
+  return delta;
+}
+
+esp_err_t HeapAudit::check(DeviceType type) const {
+  size_t index = static_cast<size_t>(type);
+  if (!active) {
+    return ESP_OK;
+  }
+  if (index >= kTypeCount) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  Cost used = cost();
+  raise(worstBlocks[index], used.blocks);
+  raise(worstBytes[index], used.bytes);
+
+  const Cost &budget = kBudgets[index];
+  if (budget.blocks > 0 && (used.blocks > budget.blocks || used.bytes > budget.bytes)) {
+    ESP_LOGE(__FILENAME__, "Device type %u allocated %lu blocks / %lu bytes, budget %lu / %lu",
+             static_cast<unsigned>(index), static_cast<unsigned long>(used.blocks),
+             static_cast<unsigned long>(used.bytes), static_cast<unsigned long>(budget.blocks),
+             static_cast<unsigned long>(budget.bytes));
+    return ESP_ERR_INVALID_SIZE;
+  }
+  ESP_LOGI(__FILENAME__, "Device type %u allocated %lu blocks / %lu bytes", static_cast<unsigned>(index),
+           static_cast<unsigned long>(used.blocks), static_cast<unsigned long>(used.bytes));
+  return ESP_OK;
+}
+
+HeapAudit::Cost HeapAudit::getBudget(DeviceType type) {
+  size_t index = static_cast<size_t>(type);
+  return index < kTypeCount ? kBudgets[index] : Cost{0, 0};
+}
+
+HeapAudit::Cost HeapAudit::getWorst(DeviceType type) {
+  size_t index = static_cast<size_t>(type);
+  if (index >= kTypeCount) {
+    return Cost{0, 0};
+  }
+  return Cost{worstBlocks[index].load(std::memory_order_relaxed), worstBytes[index].load(std::memory_order_relaxed)};
+}
+
+void HeapAudit::logWorst() {
+  for (size_t index = 0; index < kTypeCount; index++) {
+    ESP_LOGI(__FILENAME__, "{%lu, %lu},  // type %u, budget %lu / %lu",
+             static_cast<unsigned long>(worstBlocks[index].load(std::memory_order_relaxed)),
+             static_cast<unsigned long>(worstBytes[index].load(std::memory_order_relaxed)),
+             static_cast<unsigned>(index), static_cast<unsigned long>(kBudgets[index].blocks),
+             static_cast<unsigned long>(kBudgets[index].bytes));
+  }
+}
+
+void HeapAudit::setEnabled(bool enable) { enabled.store(enable); }
+
+bool HeapAudit::isEnabled() { return enabled.load(); }
+
+void HeapAudit::setSampler(Sampler custom) { sampler.store(custom); }
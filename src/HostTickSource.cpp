@@ -0,0 +1,28 @@
+#include "HostTickSource.hpp"
+
+#include <esp_err.h>
+
+#include <TimerWheel.hpp>
+#include <cstdint>
+
+HostTickSource::HostTickSource(TimerWheel &wheel) : wheel(wheel), running(false), remainderMs(0) {}
+
+esp_err_t HostTickSource::start() {
+  running = true;
+  return ESP_OK;
+}
+
+void HostTickSource::stop() { running = false; }
+
+void HostTickSource::advanceTicks(uint32_t ticks) {
+  if (running) {
+    wheel.advance(ticks);
+  }
+}
+
+void HostTickSource::advanceMs(uint32_t ms) {
+  remainderMs += ms;
+  uint32_t ticks = remainderMs / TimerWheel::kTickMs;
+  remainderMs %= TimerWheel::kTickMs;
+  advanceTicks(ticks);
+}
@@ -5,15 +5,27 @@
 #include <esp_matter.h>
 #include <esp_matter_endpoint.h>
 
+#include <DeviceExecutor.hpp>
+#include <DeviceName.hpp>
+#include <DeviceTask.hpp>
+#include <SeqLock.hpp>
+#include <StateStream.hpp>
+#include <atomic>
 #include <cstdint>
+#include <utility>
 
-LightDevice::LightDevice(const char *device_name, LightAccessoryInterface *lightAccessory,
+LightDevice::LightDevice(DeviceName device_name, LightAccessoryInterface *lightAccessory,
                          esp_matter::endpoint_t *aggregator)
-    : BaseDevice(), lightAccessory(lightAccessory) {
+    : BaseDevice(),
+      lightAccessory(lightAccessory),
+      name(std::move(device_name)),
+      shadow(State{false}),
+      identifying(false),
+      identifyTask(DeviceExecutor::kNoTask) {
   // Set up the callback for reporting attributes
   if (lightAccessory != nullptr) {
     lightAccessory->setReportAppCallback(
-        [](void *self) { static_cast<LightDevice *>(self)->reportEndpoint(); }, this);
+        [](void *self) { static_cast<LightDevice *>(self)->onAccessoryReport(); }, this);
   }
 
   // Check if an aggregator is provided
@@ -23,15 +35,12 @@ LightDevice::LightDevice(const char *device_name, LightAccessoryInterface *light
                     esp_matter::endpoint_flags::ENDPOINT_FLAG_DESTROYABLE;
     endpoint = esp_matter::endpoint::bridged_node::create(esp_matter::node::get(), &bridged_node_config,
                                                           flags, this);
-    if (device_name != nullptr && strlen(device_name) > 0 &&
-        strlen(device_name) < 64)  // TODO: change to a define
-    {
-      strncpy(this->name, device_name, sizeof(this->name));
-      ESP_LOGI(__FILENAME__, "Creating Bridged Node LightDevice with name: %s", name);
+    if (name.length() > 0) {
+      ESP_LOGI(__FILENAME__, "Creating Bridged Node LightDevice with name: %s", name.get());
       esp_matter::cluster_t *bridge_device_basic_information_cluster =
           esp_matter::cluster::get(endpoint, chip::app::Clusters::BridgedDeviceBasicInformation::Id);
       esp_matter::cluster::bridged_device_basic_information::attribute::create_node_label(
-          bridge_device_basic_information_cluster, name, strlen(name));
+          bridge_device_basic_information_cluster, name.get(), name.length());
     } else {
       ESP_LOGW(__FILENAME__, "device_name is not set");
       ESP_LOGI(__FILENAME__, "Creating Bridged Node LightDevice with default name");
@@ -48,10 +57,27 @@ LightDevice::LightDevice(const char *device_name, LightAccessoryInterface *light
   esp_matter::endpoint::on_off_light::config_t light_config;
   esp_matter::endpoint::on_off_light::add(endpoint, &light_config);
 
+  loadShadow();
   setAccessoryPowerState(getEndpointPowerState());
+
+  registerDevice();
+}
+
+LightDevice::~LightDevice() {
+  unregisterDevice();
+  DeviceExecutor::device().cancel(identifyTask);
 }
 
 esp_err_t LightDevice::updateAccessory() {
+  if (!isReachable()) {
+    ESP_LOGW(__FILENAME__, "Rejecting update, accessory unreachable");
+    return ESP_ERR_INVALID_STATE;
+  }
+  esp_err_t err = loadShadow();
+  if (err != ESP_OK) {
+    ESP_LOGE(__FILENAME__, "Cannot read LightDevice endpoint state: %s", esp_err_to_name(err));
+    return err;
+  }
   bool powerState = getEndpointPowerState();
   ESP_LOGI(__FILENAME__, "Updating LightDevice Accessory with powerState: %d", powerState);
   setAccessoryPowerState(powerState);
@@ -62,31 +88,119 @@ esp_err_t LightDevice::reportEndpoint() {
   bool powerState = getAccessoryPowerState();
   ESP_LOGI(__FILENAME__, "Reporting LightDevice Endpoint with powerState: %d", powerState);
 
-  setEndpointPowerState(powerState);
-  return ESP_OK;
+  esp_err_t err = setEndpointPowerState(powerState);
+  cachePowerState(powerState);
+  return err;
 }
 
 bool LightDevice::getAccessoryPowerState() { return lightAccessory->getPower(); }
 
-void LightDevice::setAccessoryPowerState(bool powerState) { lightAccessory->setPower(powerState); }
+void LightDevice::setAccessoryPowerState(bool powerState) {
+  markAccessoryWrite();
+  lightAccessory->setPower(powerState);
+}
 
-bool LightDevice::getEndpointPowerState() {
+void LightDevice::onAccessoryReport() {
+  if (identifying.load()) {
+    // The blink is not a state change
+    return;
+  }
+  if (isWriteEcho(getAccessoryPowerState() == getEndpointPowerState())) {
+    return;
+  }
+  reportEndpoint();
+}
+
+bool LightDevice::getEndpointPowerState() { return shadow.read().powerState; }
+
+esp_err_t LightDevice::loadShadow() {
   esp_matter::cluster_t *on_off_cluster = esp_matter::cluster::get(endpoint, chip::app::Clusters::OnOff::Id);
   esp_matter::attribute_t *on_off_attribute =
       esp_matter::attribute::get(on_off_cluster, chip::app::Clusters::OnOff::Attributes::OnOff::Id);
+  if (on_off_attribute == nullptr) {
+    return ESP_ERR_NOT_FOUND;
+  }
   esp_matter_attr_val_t attr_val;
-  esp_matter::attribute::get_val(on_off_attribute, &attr_val);
-  return attr_val.val.b;
+  esp_err_t err = esp_matter::attribute::get_val(on_off_attribute, &attr_val);
+  if (err != ESP_OK) {
+    return err;
+  }
+  cachePowerState(attr_val.val.b);
+  return ESP_OK;
 }
 
-void LightDevice::setEndpointPowerState(bool powerState) {
+esp_err_t LightDevice::setEndpointPowerState(bool powerState) {
   esp_matter_attr_val_t attr_val = esp_matter_bool(powerState);
-  esp_matter::attribute::report(esp_matter::endpoint::get_id(endpoint), chip::app::Clusters::OnOff::Id,
-                                chip::app::Clusters::OnOff::Attributes::OnOff::Id, &attr_val);
+  return reportAttribute(esp_matter::endpoint::get_id(endpoint), chip::app::Clusters::OnOff::Id,
+                         chip::app::Clusters::OnOff::Attributes::OnOff::Id, &attr_val);
 }
 
 esp_err_t LightDevice::identify() {
-  ESP_LOGI(__FILENAME__, "Identifying LightDevice");
-  lightAccessory->identifyYourSelf();
+  uint16_t seconds = getEndpointIdentifyTime();
+  ESP_LOGI(__FILENAME__, "Identifying LightDevice for %u s", seconds);
+
+  DeviceExecutor &executor = DeviceExecutor::device();
+  executor.cancel(identifyTask);
+  if (seconds == 0) {
+    identifying.store(false);
+    setAccessoryPowerState(getEndpointPowerState());
+    return ESP_OK;
+  }
+
+  identifying.store(true);
+  if (executor.spawn(blinkIdentify(seconds), &identifyTask) != ESP_OK) {
+    ESP_LOGW(__FILENAME__, "Cannot start the identify sequence, using the accessory effect");
+    identifying.store(false);
+    lightAccessory->identifyYourSelf();
+  }
   return ESP_OK;
-}
\ No newline at end of file
+}
+
+DeviceTask LightDevice::blinkIdentify(uint16_t seconds) {
+  // Start from the opposite of the endpoint state so the first phase is visible
+  bool powerState = !getEndpointPowerState();
+  for (uint32_t phase = 0; phase < 2u * seconds; phase++) {
+    lightAccessory->setPower(powerState);
+    powerState = !powerState;
+    co_await DeviceExecutor::delay(kIdentifyBlinkMs);
+  }
+  identifying.store(false);
+  setAccessoryPowerState(getEndpointPowerState());
+}
+
+uint16_t LightDevice::getEndpointIdentifyTime() {
+  esp_matter::attribute_t *identify_time_attribute =
+      esp_matter::attribute::get(esp_matter::endpoint::get_id(endpoint), chip::app::Clusters::Identify::Id,
+                                 chip::app::Clusters::Identify::Attributes::IdentifyTime::Id);
+  if (identify_time_attribute == nullptr) {
+    return kIdentifyDefaultSeconds;
+  }
+  esp_matter_attr_val_t attr_val;
+  if (esp_matter::attribute::get_val(identify_time_attribute, &attr_val) != ESP_OK) {
+    return kIdentifyDefaultSeconds;
+  }
+  return attr_val.val.u16;
+}
+
+void LightDevice::fillSnapshot(DeviceSnapshot &snapshot, size_t index) const {
+  if (snapshot.endpointIds != nullptr) snapshot.endpointIds[index] = esp_matter::endpoint::get_id(endpoint);
+  if (snapshot.types != nullptr) snapshot.types[index] = DeviceType::Light;
+  snapshot.setPower(index, shadow.read().powerState);
+}
+
+size_t LightDevice::getEndpointIds(uint16_t *endpointIds, size_t capacity) const {
+  if (capacity == 0) {
+    return 0;
+  }
+  endpointIds[0] = esp_matter::endpoint::get_id(endpoint);
+  return 1;
+}
+
+LightDevice::State LightDevice::getState() const { return shadow.read(); }
+
+void LightDevice::cachePowerState(bool powerState) {
+  State previous = shadow.modify([powerState](State &state) { state.powerState = powerState; });
+  if (previous.powerState != powerState) {
+    StateStreamEncoder::emit(esp_matter::endpoint::get_id(endpoint), StateChangeKind::Power, powerState);
+  }
+}
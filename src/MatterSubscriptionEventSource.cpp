@@ -0,0 +1,59 @@
+#include "MatterSubscriptionEventSource.hpp"
+
+#include <esp_err.h>
+#include <esp_log.h>
+
+#include <app/InteractionModelEngine.h>
+#include <app/ReadHandler.h>
+
+#include <SubscriptionTracker.hpp>
+#include <cstddef>
+#include <cstdint>
+
+MatterSubscriptionEventSource::MatterSubscriptionEventSource()
+    : listener(nullptr), listenerContext(nullptr), established() {}
+
+esp_err_t MatterSubscriptionEventSource::setListener(Listener listener, void *context) {
+  this->listener = listener;
+  this->listenerContext = context;
+  chip::app::InteractionModelEngine::GetInstance()->RegisterReadHandlerAppCallback(this);
+  return ESP_OK;
+}
+
+void MatterSubscriptionEventSource::OnSubscriptionEstablished(chip::app::ReadHandler &readHandler) {
+  for (chip::app::ReadHandler *&slot : established) {
+    if (slot == nullptr) {
+      slot = &readHandler;
+      forward(readHandler, true);
+      return;
+    }
+  }
+  // Cannot be matched on termination, so fall back to reporting every path from now on
+  ESP_LOGW(__FILENAME__, "Too many subscriptions to track");
+  if (listener != nullptr) {
+    listener(listenerContext, SubscriptionTracker::kAnyEndpoint, SubscriptionTracker::kAnyCluster, true);
+  }
+}
+
+void MatterSubscriptionEventSource::OnSubscriptionTerminated(chip::app::ReadHandler &readHandler) {
+  for (chip::app::ReadHandler *&slot : established) {
+    if (slot == &readHandler) {
+      slot = nullptr;
+      forward(readHandler, false);
+      return;
+    }
+  }
+}
+
+void MatterSubscriptionEventSource::forward(chip::app::ReadHandler &readHandler, bool subscribed) {
+  if (listener == nullptr) {
+    return;
+  }
+  for (auto *path = readHandler.GetAttributePathList(); path != nullptr; path = path->mpNext) {
+    uint16_t endpointId =
+        path->mValue.HasWildcardEndpointId() ? SubscriptionTracker::kAnyEndpoint : path->mValue.mEndpointId;
+    uint32_t clusterId =
+        path->mValue.HasWildcardClusterId() ? SubscriptionTracker::kAnyCluster : path->mValue.mClusterId;
+    listener(listenerContext, endpointId, clusterId, subscribed);
+  }
+}
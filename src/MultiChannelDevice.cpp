@@ -0,0 +1,208 @@
+#include "MultiChannelDevice.hpp"
+
+#include <esp_err.h>
+#include <esp_log.h>
+#include <esp_matter.h>
+#include <esp_matter_endpoint.h>
+
+#include <DeviceName.hpp>
+#include <MultiChannelAccessoryInterface.hpp>
+#include <ReportScheduler.hpp>
+#include <SeqLock.hpp>
+#include <StateStream.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+
+MultiChannelDevice::MultiChannelDevice(DeviceName device_name, MultiChannelAccessoryInterface *accessory,
+                                       esp_matter::endpoint_t *aggregator, ChannelType channelType)
+    : BaseDevice(),
+      endpoints(),
+      accessory(accessory),
+      channelCount(0),
+      channelType(channelType),
+      name(std::move(device_name)),
+      shadow(State{0}) {
+  if (accessory == nullptr) {
+    ESP_LOGW(__FILENAME__, "MultiChannelDevice created without accessory");
+    registerDevice();
+    return;
+  }
+
+  // Set up the callback for reporting attributes, one call per accessory batch
+  accessory->setReportAppCallback(
+      [](void *self) { static_cast<MultiChannelDevice *>(self)->reportEndpoint(); }, this);
+
+  channelCount = accessory->getChannelCount();
+  if (channelCount > kMaxChannels) {
+    ESP_LOGW(__FILENAME__, "Accessory has %u channels, using the first %u", channelCount, kMaxChannels);
+    channelCount = kMaxChannels;
+  }
+
+  ESP_LOGI(__FILENAME__, "Creating MultiChannelDevice %s with %u channels", name.get(), channelCount);
+
+  for (uint8_t channel = 0; channel < channelCount; channel++) {
+    endpoints[channel] = createChannelEndpoint(channel, aggregator);
+  }
+
+  // Bring every channel to the stored state in one write
+  uint32_t powerMask = getEndpointPowerMask();
+  cachePowerMask(powerMask);
+  accessory->setChannelMask(powerMask, channelsMask());
+
+  registerDevice();
+}
+
+MultiChannelDevice::~MultiChannelDevice() { unregisterDevice(); }
+
+esp_err_t MultiChannelDevice::updateAccessory() {
+  if (!isReachable()) {
+    ESP_LOGW(__FILENAME__, "Rejecting update, accessory unreachable");
+    return ESP_ERR_INVALID_STATE;
+  }
+  uint32_t powerMask = getEndpointPowerMask();
+  uint32_t changedMask = cachePowerMask(powerMask);
+  if (changedMask == 0) {
+    return ESP_OK;
+  }
+
+  ESP_LOGI(__FILENAME__, "Updating MultiChannelDevice accessory with mask 0x%08lx, changed 0x%08lx",
+           static_cast<unsigned long>(powerMask), static_cast<unsigned long>(changedMask));
+  accessory->setChannelMask(powerMask, changedMask);
+  return ESP_OK;
+}
+
+esp_err_t MultiChannelDevice::reportEndpoint() {
+  if (accessory == nullptr) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  uint32_t powerMask = accessory->getChannelMask() & channelsMask();
+  uint32_t changedMask = cachePowerMask(powerMask);
+  ESP_LOGI(__FILENAME__, "Reporting MultiChannelDevice endpoints with mask 0x%08lx, changed 0x%08lx",
+           static_cast<unsigned long>(powerMask), static_cast<unsigned long>(changedMask));
+
+  // Every changed channel goes to the stack under one lock, a failed one does not stop the others
+  ReportScheduler::AttributeReport reports[kMaxChannels];
+  size_t count = 0;
+  for (uint8_t channel = 0; channel < channelCount; channel++) {
+    if (changedMask & (1u << channel)) {
+      reports[count++] = ReportScheduler::AttributeReport{
+          esp_matter::endpoint::get_id(endpoints[channel]), chip::app::Clusters::OnOff::Id,
+          chip::app::Clusters::OnOff::Attributes::OnOff::Id, esp_matter_bool((powerMask >> channel) & 1u)};
+    }
+  }
+  if (count == 0) {
+    return ESP_OK;
+  }
+  return reportAttributes(reports, count);
+}
+
+esp_err_t MultiChannelDevice::identify() {
+  if (accessory == nullptr) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  ESP_LOGI(__FILENAME__, "Identifying MultiChannelDevice");
+  accessory->identifyYourSelf();
+  return ESP_OK;
+}
+
+void MultiChannelDevice::fillSnapshot(DeviceSnapshot &snapshot, size_t index) const {
+  State state = shadow.read();
+  if (snapshot.endpointIds != nullptr) snapshot.endpointIds[index] = getChannelEndpointId(0);
+  if (snapshot.types != nullptr) snapshot.types[index] = DeviceType::MultiChannel;
+  if (snapshot.channelMask != nullptr) snapshot.channelMask[index] = state.powerMask;
+  snapshot.setPower(index, state.powerMask != 0);
+}
+
+size_t MultiChannelDevice::getEndpointIds(uint16_t *endpointIds, size_t capacity) const {
+  size_t count = 0;
+  for (uint8_t channel = 0; channel < channelCount && count < capacity; channel++) {
+    endpointIds[count++] = esp_matter::endpoint::get_id(endpoints[channel]);
+  }
+  return count;
+}
+
+uint8_t MultiChannelDevice::getChannelCount() const { return channelCount; }
+
+uint16_t MultiChannelDevice::getChannelEndpointId(uint8_t channel) const {
+  if (channel >= channelCount) {
+    return 0xFFFF;
+  }
+  return esp_matter::endpoint::get_id(endpoints[channel]);
+}
+
+MultiChannelDevice::State MultiChannelDevice::getState() const { return shadow.read(); }
+
+esp_matter::endpoint_t *MultiChannelDevice::createChannelEndpoint(uint8_t channel,
+                                                                  esp_matter::endpoint_t *aggregator) {
+  esp_matter::endpoint_t *endpoint;
+  if (aggregator != nullptr) {
+    esp_matter::endpoint::bridged_node::config_t bridged_node_config;
+    uint8_t flags = esp_matter::endpoint_flags::ENDPOINT_FLAG_BRIDGE |
+                    esp_matter::endpoint_flags::ENDPOINT_FLAG_DESTROYABLE;
+    endpoint = esp_matter::endpoint::bridged_node::create(esp_matter::node::get(), &bridged_node_config,
+                                                          flags, this);
+    if (name.length() > 0) {
+      char label[DeviceName::kMaxLength + 5];
+      snprintf(label, sizeof(label), "%s %u", name.get(), channel + 1);
+      esp_matter::cluster_t *bridge_device_basic_information_cluster =
+          esp_matter::cluster::get(endpoint, chip::app::Clusters::BridgedDeviceBasicInformation::Id);
+      esp_matter::cluster::bridged_device_basic_information::attribute::create_node_label(
+          bridge_device_basic_information_cluster, label, strlen(label));
+    }
+    esp_matter::endpoint::set_parent_endpoint(endpoint, aggregator);
+  } else {
+    uint8_t flags = esp_matter::endpoint_flags::ENDPOINT_FLAG_NONE;
+    endpoint = esp_matter::endpoint::create(esp_matter::node::get(), flags, this);
+  }
+
+  if (channelType == ChannelType::Light) {
+    esp_matter::endpoint::on_off_light::config_t light_config;
+    esp_matter::endpoint::on_off_light::add(endpoint, &light_config);
+  } else {
+    esp_matter::endpoint::on_off_plugin_unit::config_t on_off_plugin_unit_config;
+    esp_matter::endpoint::on_off_plugin_unit::add(endpoint, &on_off_plugin_unit_config);
+  }
+  return endpoint;
+}
+
+uint32_t MultiChannelDevice::getEndpointPowerMask() {
+  // A channel whose attribute cannot be read keeps its cached state
+  uint32_t powerMask = shadow.read().powerMask;
+  for (uint8_t channel = 0; channel < channelCount; channel++) {
+    esp_matter::cluster_t *on_off_cluster =
+        esp_matter::cluster::get(endpoints[channel], chip::app::Clusters::OnOff::Id);
+    esp_matter::attribute_t *on_off_attribute =
+        on_off_cluster == nullptr
+            ? nullptr
+            : esp_matter::attribute::get(on_off_cluster, chip::app::Clusters::OnOff::Attributes::OnOff::Id);
+    esp_matter_attr_val_t attr_val = {};
+    if (on_off_attribute == nullptr || esp_matter::attribute::get_val(on_off_attribute, &attr_val) != ESP_OK) {
+      ESP_LOGW(__FILENAME__, "Cannot read the OnOff attribute of channel %u", channel);
+      continue;
+    }
+    if (attr_val.val.b) {
+      powerMask |= 1u << channel;
+    } else {
+      powerMask &= ~(1u << channel);
+    }
+  }
+  return powerMask;
+}
+
+uint32_t MultiChannelDevice::channelsMask() const {
+  return channelCount >= 32 ? 0xFFFFFFFFu : (1u << channelCount) - 1u;
+}
+
+uint32_t MultiChannelDevice::cachePowerMask(uint32_t powerMask) {
+  State previous = shadow.modify([powerMask](State &state) { state.powerMask = powerMask; });
+  uint32_t changedMask = previous.powerMask ^ powerMask;
+  for (uint8_t channel = 0; channel < channelCount; channel++) {
+    if (changedMask & (1u << channel)) {
+      StateStreamEncoder::emit(esp_matter::endpoint::get_id(endpoints[channel]), StateChangeKind::Power,
+                               (powerMask >> channel) & 1u);
+    }
+  }
+  return changedMask;
+}
@@ -0,0 +1,67 @@
+#include "NvsWindowProfileStorage.hpp"
+
+#include <esp_err.h>
+#include <esp_log.h>
+#include <nvs.h>
+
+#include <WindowProfileStorageInterface.hpp>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+
+// Copy the key into an NVS sized buffer, NVS rejects longer keys
+void toNvsKey(const char *key, char (&nvsKey)[NVS_KEY_NAME_MAX_SIZE]) {
+  strncpy(nvsKey, key != nullptr ? key : "", sizeof(nvsKey) - 1);
+  nvsKey[sizeof(nvsKey) - 1] = '\0';
+}
+
+}  // namespace
+
+NvsWindowProfileStorage::NvsWindowProfileStorage(const char *nvsNamespace) : nvsNamespace(nvsNamespace) {}
+
+esp_err_t NvsWindowProfileStorage::load(const char *key, WindowTravelProfile &profile) {
+  char nvsKey[NVS_KEY_NAME_MAX_SIZE];
+  toNvsKey(key, nvsKey);
+
+  nvs_handle_t handle;
+  esp_err_t err = nvs_open(nvsNamespace, NVS_READONLY, &handle);
+  if (err != ESP_OK) {
+    // The namespace only exists once a profile was saved
+    return err == ESP_ERR_NVS_NOT_FOUND ? ESP_ERR_NOT_FOUND : err;
+  }
+
+  WindowTravelProfile stored;
+  size_t size = sizeof(stored);
+  err = nvs_get_blob(handle, nvsKey, &stored, &size);
+  nvs_close(handle);
+  if (err == ESP_ERR_NVS_NOT_FOUND) {
+    return ESP_ERR_NOT_FOUND;
+  }
+  if (err != ESP_OK) {
+    return err;
+  }
+  if (size != sizeof(stored)) {
+    ESP_LOGW(__FILENAME__, "Ignoring window profile %s of %u bytes", nvsKey, static_cast<unsigned>(size));
+    return ESP_ERR_INVALID_SIZE;
+  }
+  profile = stored;
+  return ESP_OK;
+}
+
+esp_err_t NvsWindowProfileStorage::save(const char *key, const WindowTravelProfile &profile) {
+  char nvsKey[NVS_KEY_NAME_MAX_SIZE];
+  toNvsKey(key, nvsKey);
+
+  nvs_handle_t handle;
+  esp_err_t err = nvs_open(nvsNamespace, NVS_READWRITE, &handle);
+  if (err != ESP_OK) {
+    return err;
+  }
+  err = nvs_set_blob(handle, nvsKey, &profile, sizeof(profile));
+  if (err == ESP_OK) {
+    err = nvs_commit(handle);
+  }
+  nvs_close(handle);
+  return err;
+}
@@ -5,16 +5,27 @@
 #include <esp_matter.h>
 #include <esp_matter_endpoint.h>
 
+#include <DeviceConfig.hpp>
+#include <DeviceName.hpp>
+#include <PowerMeasurementDelegate.hpp>
+#include <PowerMeterAggregator.hpp>
+#include <PowerMeterInterface.hpp>
+#include <SeqLock.hpp>
+#include <StateStream.hpp>
+#include <TimerWheel.hpp>
 #include <cstdint>
+#include <mutex>
+#include <new>
+#include <utility>
 
-PlugInDevice::PlugInDevice(const char *device_name, PluginAccessoryInterface *plugInAccessory,
-                           esp_matter::endpoint_t *aggregator)
-    : BaseDevice() {
+PlugInDevice::PlugInDevice(DeviceName device_name, PluginAccessoryInterface *plugInAccessory,
+                           esp_matter::endpoint_t *aggregator, PowerMeterInterface *powerMeter)
+    : BaseDevice(), name(std::move(device_name)), shadow(State{false}), powerMeter(powerMeter), metering(nullptr) {
   // Create the PlugInAccessory instance
   accessory = plugInAccessory;
 
   // Set up the callback for reporting attributes
-  accessory->setReportAppCallback([](void *self) { static_cast<PlugInDevice *>(self)->reportEndpoint(); },
+  accessory->setReportAppCallback([](void *self) { static_cast<PlugInDevice *>(self)->onAccessoryReport(); },
                                   this);
 
   // Check if an aggregator is provided
@@ -24,15 +35,12 @@ PlugInDevice::PlugInDevice(const char *device_name, PluginAccessoryInterface *pl
                     esp_matter::endpoint_flags::ENDPOINT_FLAG_DESTROYABLE;
     endpoint = esp_matter::endpoint::bridged_node::create(esp_matter::node::get(), &bridged_node_config,
                                                           flags, this);
-    if (device_name != nullptr && strlen(device_name) > 0 &&
-        strlen(device_name) < 64)  // TODO: change to a define
-    {
-      strncpy(this->name, device_name, sizeof(this->name));
-      ESP_LOGI(__FILENAME__, "Creating Bridged Node PlugInDevice with name: %s", name);
+    if (name.length() > 0) {
+      ESP_LOGI(__FILENAME__, "Creating Bridged Node PlugInDevice with name: %s", name.get());
       esp_matter::cluster_t *bridge_device_basic_information_cluster =
           esp_matter::cluster::get(endpoint, chip::app::Clusters::BridgedDeviceBasicInformation::Id);
       esp_matter::cluster::bridged_device_basic_information::attribute::create_node_label(
-          bridge_device_basic_information_cluster, name, strlen(name));
+          bridge_device_basic_information_cluster, name.get(), name.length());
     } else {
       ESP_LOGW(__FILENAME__, "device_name is not set");
       ESP_LOGI(__FILENAME__, "Creating Bridged Node PlugInDevice with default name");
@@ -47,10 +55,66 @@ PlugInDevice::PlugInDevice(const char *device_name, PluginAccessoryInterface *pl
   esp_matter::endpoint::on_off_plugin_unit::config_t on_off_plugin_unit_config;
   esp_matter::endpoint::on_off_plugin_unit::add(endpoint, &on_off_plugin_unit_config);
 
+  // Unmetered plugs do not pay for the meter state
+  if (powerMeter != nullptr) {
+    metering = new (std::nothrow) Metering();
+    if (metering == nullptr) {
+      ESP_LOGE(__FILENAME__, "Cannot allocate PlugInDevice metering, the plug stays unmetered");
+      this->powerMeter = nullptr;
+    }
+  }
+
+  // Add the metering clusters if the plug has a metering chip
+  if (metering != nullptr) {
+    ESP_LOGI(__FILENAME__, "Adding PlugInDevice power and energy measurement");
+    if constexpr (DeviceConfig::kPlugIn.powerTopology) {
+      esp_matter::cluster::power_topology::config_t power_topology_config;
+      esp_matter::cluster_t *power_topology_cluster = esp_matter::cluster::power_topology::create(
+          endpoint, &power_topology_config, esp_matter::cluster_flags::CLUSTER_FLAG_SERVER);
+      esp_matter::cluster::power_topology::feature::node_topology::add(power_topology_cluster);
+    }
+
+    // The EPM attributes are served by the delegate, not by the attribute store
+    metering->delegate.attach(esp_matter::endpoint::get_id(endpoint));
+    esp_matter::cluster::electrical_power_measurement::config_t power_measurement_config;
+    power_measurement_config.delegate = &metering->delegate;
+    esp_matter::cluster_t *power_measurement_cluster = esp_matter::cluster::electrical_power_measurement::create(
+        endpoint, &power_measurement_config, esp_matter::cluster_flags::CLUSTER_FLAG_SERVER);
+    esp_matter::cluster::electrical_power_measurement::feature::alternating_current::add(
+        power_measurement_cluster);
+
+    esp_matter::cluster::electrical_energy_measurement::config_t energy_measurement_config;
+    esp_matter::cluster_t *energy_measurement_cluster = esp_matter::cluster::electrical_energy_measurement::create(
+        endpoint, &energy_measurement_config, esp_matter::cluster_flags::CLUSTER_FLAG_SERVER);
+    esp_matter::cluster::electrical_energy_measurement::feature::imported_energy::add(energy_measurement_cluster);
+    if constexpr (DeviceConfig::kPlugIn.cumulativeEnergy) {
+      esp_matter::cluster::electrical_energy_measurement::feature::cumulative_energy::add(
+          energy_measurement_cluster);
+    }
+  }
+
+  loadShadow();
   setAccessoryPowerState(getEndpointPowerState());
+
+  registerDevice();
+}
+
+PlugInDevice::~PlugInDevice() {
+  unregisterDevice();
+  stopMetering();
+  delete metering;
 }
 
 esp_err_t PlugInDevice::updateAccessory() {
+  if (!isReachable()) {
+    ESP_LOGW(__FILENAME__, "Rejecting update, accessory unreachable");
+    return ESP_ERR_INVALID_STATE;
+  }
+  esp_err_t err = loadShadow();
+  if (err != ESP_OK) {
+    ESP_LOGE(__FILENAME__, "Cannot read PlugInDevice endpoint state: %s", esp_err_to_name(err));
+    return err;
+  }
   bool powerState = getEndpointPowerState();
 
   ESP_LOGI(__FILENAME__, "Updating PlugInDevice accessory state to %s", powerState ? "on" : "off");
@@ -64,8 +128,9 @@ esp_err_t PlugInDevice::reportEndpoint() {
 
   ESP_LOGI(__FILENAME__, "Reporting PlugInDevice endpoint state to %s", powerState ? "on" : "off");
 
-  setEndpointPowerState(powerState);
-  return ESP_OK;
+  esp_err_t err = setEndpointPowerState(powerState);
+  cachePowerState(powerState);
+  return err;
 }
 
 esp_err_t PlugInDevice::identify() {
@@ -77,19 +142,131 @@ esp_err_t PlugInDevice::identify() {
 
 bool PlugInDevice::getAccessoryPowerState() { return accessory->getPower(); }
 
-void PlugInDevice::setAccessoryPowerState(bool powerState) { accessory->setPower(powerState); }
+void PlugInDevice::setAccessoryPowerState(bool powerState) {
+  markAccessoryWrite();
+  accessory->setPower(powerState);
+}
 
-bool PlugInDevice::getEndpointPowerState() {
+void PlugInDevice::onAccessoryReport() {
+  if (isWriteEcho(getAccessoryPowerState() == getEndpointPowerState())) {
+    return;
+  }
+  reportEndpoint();
+}
+
+bool PlugInDevice::getEndpointPowerState() { return shadow.read().powerState; }
+
+esp_err_t PlugInDevice::loadShadow() {
   esp_matter::cluster_t *on_off_cluster = esp_matter::cluster::get(endpoint, chip::app::Clusters::OnOff::Id);
   esp_matter::attribute_t *on_off_attribute =
       esp_matter::attribute::get(on_off_cluster, chip::app::Clusters::OnOff::Attributes::OnOff::Id);
+  if (on_off_attribute == nullptr) {
+    return ESP_ERR_NOT_FOUND;
+  }
   esp_matter_attr_val_t attr_val;
-  esp_matter::attribute::get_val(on_off_attribute, &attr_val);
-  return attr_val.val.b;
+  esp_err_t err = esp_matter::attribute::get_val(on_off_attribute, &attr_val);
+  if (err != ESP_OK) {
+    return err;
+  }
+  cachePowerState(attr_val.val.b);
+  return ESP_OK;
 }
 
-void PlugInDevice::setEndpointPowerState(bool powerState) {
+esp_err_t PlugInDevice::setEndpointPowerState(bool powerState) {
   esp_matter_attr_val_t attr_val = esp_matter_bool(powerState);
-  esp_matter::attribute::report(esp_matter::endpoint::get_id(endpoint), chip::app::Clusters::OnOff::Id,
-                                chip::app::Clusters::OnOff::Attributes::OnOff::Id, &attr_val);
+  return reportAttribute(esp_matter::endpoint::get_id(endpoint), chip::app::Clusters::OnOff::Id,
+                         chip::app::Clusters::OnOff::Attributes::OnOff::Id, &attr_val);
+}
+
+void PlugInDevice::fillSnapshot(DeviceSnapshot &snapshot, size_t index) const {
+  if (snapshot.endpointIds != nullptr) snapshot.endpointIds[index] = esp_matter::endpoint::get_id(endpoint);
+  if (snapshot.types != nullptr) snapshot.types[index] = DeviceType::PlugIn;
+  snapshot.setPower(index, shadow.read().powerState);
+}
+
+size_t PlugInDevice::getEndpointIds(uint16_t *endpointIds, size_t capacity) const {
+  if (capacity == 0) {
+    return 0;
+  }
+  endpointIds[0] = esp_matter::endpoint::get_id(endpoint);
+  return 1;
+}
+
+PlugInDevice::State PlugInDevice::getState() const { return shadow.read(); }
+
+void PlugInDevice::cachePowerState(bool powerState) {
+  State previous = shadow.modify([powerState](State &state) { state.powerState = powerState; });
+  if (previous.powerState != powerState) {
+    StateStreamEncoder::emit(esp_matter::endpoint::get_id(endpoint), StateChangeKind::Power, powerState);
+  }
+}
+
+esp_err_t PlugInDevice::sampleMeter(uint32_t nowMs) {
+  if (metering == nullptr) {
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+
+  PowerSample sample;
+  if (!powerMeter->readSample(nowMs, sample)) {
+    ESP_LOGW(__FILENAME__, "PlugInDevice power meter read failed");
+    return ESP_FAIL;
+  }
+
+  // Only report when the aggregate moved enough or the max interval expired
+  PowerMeterAggregator::Summary summary;
+  {
+    std::lock_guard<std::mutex> guard(metering->mutex);
+    metering->aggregator.addSample(sample);
+    if (!metering->aggregator.reportDue(nowMs)) {
+      return ESP_OK;
+    }
+    summary = metering->aggregator.summary();
+    // A dropped notification is superseded by the next aggregate, so the aggregate counts as reported
+    metering->aggregator.markReported(nowMs);
+  }
+  ESP_LOGI(__FILENAME__, "Reporting PlugInDevice power %ld mW, energy %lld mWh", static_cast<long>(summary.meanPower),
+           static_cast<long long>(summary.energy));
+  return setEndpointPowerMeasurement(summary);
+}
+
+esp_err_t PlugInDevice::startMetering(uint32_t intervalMs) {
+  if (metering == nullptr) {
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+  uint32_t ticks = TimerWheel::msToTicks(intervalMs);
+  TimerWheel::device().schedule(
+      metering->timer, ticks,
+      [](void *self) {
+        uint32_t nowMs = static_cast<uint32_t>(TimerWheel::device().now() * TimerWheel::kTickMs);
+        static_cast<PlugInDevice *>(self)->sampleMeter(nowMs);
+      },
+      this, ticks);
+  return ESP_OK;
+}
+
+void PlugInDevice::stopMetering() {
+  if (metering != nullptr) {
+    TimerWheel::device().cancelAndWait(metering->timer);
+  }
+}
+
+void PlugInDevice::setMeterThresholds(const PowerMeterAggregator::Thresholds &thresholds) {
+  if (metering == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(metering->mutex);
+  metering->aggregator.setThresholds(thresholds);
+}
+
+PowerMeterAggregator::Summary PlugInDevice::getMeterSummary() const {
+  if (metering == nullptr) {
+    return PowerMeterAggregator::Summary{0, 0, 0, 0, 0, 0, 0};
+  }
+  std::lock_guard<std::mutex> guard(metering->mutex);
+  return metering->aggregator.summary();
+}
+
+esp_err_t PlugInDevice::setEndpointPowerMeasurement(const PowerMeterAggregator::Summary &summary) {
+  // The delegate notifies the stack from the CHIP thread, the meter task never takes the stack lock
+  return metering->delegate.publish(summary);
 }
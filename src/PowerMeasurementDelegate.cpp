@@ -0,0 +1,170 @@
+#include "PowerMeasurementDelegate.hpp"
+
+#include <esp_err.h>
+#include <esp_log.h>
+
+#include <app/clusters/electrical-energy-measurement-server/electrical-energy-measurement-server.h>
+#include <app/clusters/electrical-power-measurement-server/electrical-power-measurement-server.h>
+#include <app/reporting/reporting.h>
+#include <platform/CHIPDeviceLayer.h>
+
+#include <DeviceConfig.hpp>
+#include <PowerMeterAggregator.hpp>
+#include <SeqLock.hpp>
+#include <cstdint>
+#include <mutex>
+
+using chip::app::DataModel::Nullable;
+namespace EPM = chip::app::Clusters::ElectricalPowerMeasurement;
+
+PowerMeasurementDelegate *PowerMeasurementDelegate::head = nullptr;
+
+namespace {
+
+// Power, voltage and current are measured
+constexpr uint8_t kMeasurementTypes = 3;
+
+}  // namespace
+
+std::mutex &PowerMeasurementDelegate::listMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+PowerMeasurementDelegate::PowerMeasurementDelegate()
+    : measurement(Measurement{false, 0, 0, 0, 0}), next(nullptr), attached(false) {}
+
+PowerMeasurementDelegate::~PowerMeasurementDelegate() {
+  std::lock_guard<std::mutex> guard(listMutex());
+  if (!attached) {
+    return;
+  }
+  for (PowerMeasurementDelegate **link = &head; *link != nullptr; link = &(*link)->next) {
+    if (*link == this) {
+      *link = next;
+      break;
+    }
+  }
+}
+
+void PowerMeasurementDelegate::attach(uint16_t endpointId) {
+  std::lock_guard<std::mutex> guard(listMutex());
+  SetEndpointId(endpointId);
+  if (!attached) {
+    next = head;
+    head = this;
+    attached = true;
+  }
+}
+
+esp_err_t PowerMeasurementDelegate::publish(const PowerMeterAggregator::Summary &summary) {
+  if (!attached) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  measurement.write(Measurement{true, summary.meanPower, summary.meanVoltage, summary.meanCurrent, summary.energy});
+  if (chip::DeviceLayer::PlatformMgr().ScheduleWork(notifyChanged, static_cast<intptr_t>(mEndpointId)) !=
+      CHIP_NO_ERROR) {
+    ESP_LOGW(__FILENAME__, "Cannot schedule power measurement report of endpoint %u", mEndpointId);
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+void PowerMeasurementDelegate::notifyChanged(intptr_t endpointId) {
+  uint16_t endpoint_id = static_cast<uint16_t>(endpointId);
+
+  // Hold the list lock so the delegate cannot be destroyed while its energy is read
+  std::lock_guard<std::mutex> guard(listMutex());
+  PowerMeasurementDelegate *delegate = head;
+  while (delegate != nullptr && delegate->mEndpointId != endpoint_id) {
+    delegate = delegate->next;
+  }
+  if (delegate == nullptr) {
+    return;
+  }
+
+  MatterReportingAttributeChangeCallback(endpoint_id, EPM::Id, EPM::Attributes::ActivePower::Id);
+  MatterReportingAttributeChangeCallback(endpoint_id, EPM::Id, EPM::Attributes::Voltage::Id);
+  MatterReportingAttributeChangeCallback(endpoint_id, EPM::Id, EPM::Attributes::ActiveCurrent::Id);
+
+  if constexpr (DeviceConfig::kPlugIn.cumulativeEnergy) {
+    chip::app::Clusters::ElectricalEnergyMeasurement::Structs::EnergyMeasurementStruct::Type energy;
+    energy.energy = delegate->measurement.read().energy;
+    chip::app::Clusters::ElectricalEnergyMeasurement::NotifyCumulativeEnergyMeasured(
+        endpoint_id, chip::MakeOptional(energy), chip::NullOptional);
+  }
+}
+
+EPM::PowerModeEnum PowerMeasurementDelegate::GetPowerMode() { return EPM::PowerModeEnum::kAc; }
+
+uint8_t PowerMeasurementDelegate::GetNumberOfMeasurementTypes() { return kMeasurementTypes; }
+
+CHIP_ERROR PowerMeasurementDelegate::StartAccuracyRead() { return CHIP_NO_ERROR; }
+
+CHIP_ERROR PowerMeasurementDelegate::GetAccuracyByIndex(uint8_t,
+                                                        EPM::Structs::MeasurementAccuracyStruct::Type &) {
+  return CHIP_ERROR_PROVIDER_LIST_EXHAUSTED;
+}
+
+CHIP_ERROR PowerMeasurementDelegate::EndAccuracyRead() { return CHIP_NO_ERROR; }
+
+CHIP_ERROR PowerMeasurementDelegate::StartRangesRead() { return CHIP_NO_ERROR; }
+
+CHIP_ERROR PowerMeasurementDelegate::GetRangeByIndex(uint8_t, EPM::Structs::MeasurementRangeStruct::Type &) {
+  return CHIP_ERROR_PROVIDER_LIST_EXHAUSTED;
+}
+
+CHIP_ERROR PowerMeasurementDelegate::EndRangesRead() { return CHIP_NO_ERROR; }
+
+CHIP_ERROR PowerMeasurementDelegate::StartHarmonicCurrentsRead() { return CHIP_NO_ERROR; }
+
+CHIP_ERROR PowerMeasurementDelegate::GetHarmonicCurrentsByIndex(uint8_t,
+                                                                EPM::Structs::HarmonicMeasurementStruct::Type &) {
+  return CHIP_ERROR_PROVIDER_LIST_EXHAUSTED;
+}
+
+CHIP_ERROR PowerMeasurementDelegate::EndHarmonicCurrentsRead() { return CHIP_NO_ERROR; }
+
+CHIP_ERROR PowerMeasurementDelegate::StartHarmonicPhasesRead() { return CHIP_NO_ERROR; }
+
+CHIP_ERROR PowerMeasurementDelegate::GetHarmonicPhasesByIndex(uint8_t,
+                                                              EPM::Structs::HarmonicMeasurementStruct::Type &) {
+  return CHIP_ERROR_PROVIDER_LIST_EXHAUSTED;
+}
+
+CHIP_ERROR PowerMeasurementDelegate::EndHarmonicPhasesRead() { return CHIP_NO_ERROR; }
+
+Nullable<int64_t> PowerMeasurementDelegate::GetVoltage() {
+  Measurement value = measurement.read();
+  return value.valid ? Nullable<int64_t>(value.voltage) : Nullable<int64_t>();
+}
+
+Nullable<int64_t> PowerMeasurementDelegate::GetActiveCurrent() {
+  Measurement value = measurement.read();
+  return value.valid ? Nullable<int64_t>(value.current) : Nullable<int64_t>();
+}
+
+Nullable<int64_t> PowerMeasurementDelegate::GetReactiveCurrent() { return {}; }
+
+Nullable<int64_t> PowerMeasurementDelegate::GetApparentCurrent() { return {}; }
+
+Nullable<int64_t> PowerMeasurementDelegate::GetActivePower() {
+  Measurement value = measurement.read();
+  return value.valid ? Nullable<int64_t>(value.power) : Nullable<int64_t>();
+}
+
+Nullable<int64_t> PowerMeasurementDelegate::GetReactivePower() { return {}; }
+
+Nullable<int64_t> PowerMeasurementDelegate::GetApparentPower() { return {}; }
+
+Nullable<int64_t> PowerMeasurementDelegate::GetRMSVoltage() { return {}; }
+
+Nullable<int64_t> PowerMeasurementDelegate::GetRMSCurrent() { return {}; }
+
+Nullable<int64_t> PowerMeasurementDelegate::GetRMSPower() { return {}; }
+
+Nullable<int64_t> PowerMeasurementDelegate::GetFrequency() { return {}; }
+
+Nullable<int64_t> PowerMeasurementDelegate::GetPowerFactor() { return {}; }
+
+Nullable<int64_t> PowerMeasurementDelegate::GetNeutralCurrent() { return {}; }
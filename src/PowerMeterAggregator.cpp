@@ -0,0 +1,110 @@
+#include "PowerMeterAggregator.hpp"
+
+#include <PowerMeterInterface.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace {
+
+constexpr int64_t kMilliWattMsPerMilliWattHour = 3600000;
+
+}  // namespace
+
+PowerMeterAggregator::PowerMeterAggregator() : PowerMeterAggregator(Thresholds()) {}
+
+PowerMeterAggregator::PowerMeterAggregator(const Thresholds &thresholds)
+    : thresholds(thresholds),
+      window(),
+      next(0),
+      count(0),
+      powerSum(0),
+      voltageSum(0),
+      currentSum(0),
+      energyMilliWattMs(0),
+      hasLastSample(false),
+      lastSample(),
+      hasReported(false),
+      lastReportMs(0),
+      lastReportedPower(0),
+      lastReportedEnergy(0) {}
+
+void PowerMeterAggregator::addSample(const PowerSample &sample) {
+  // Trapezoidal integration between consecutive samples
+  if (hasLastSample) {
+    uint32_t elapsedMs = sample.timestampMs - lastSample.timestampMs;
+    int64_t meanPower = (static_cast<int64_t>(lastSample.activePower) + sample.activePower) / 2;
+    energyMilliWattMs += meanPower * elapsedMs;
+  }
+  lastSample = sample;
+  hasLastSample = true;
+
+  if (count == kWindowSize) {
+    const PowerSample &evicted = window[next];
+    powerSum -= evicted.activePower;
+    voltageSum -= evicted.voltage;
+    currentSum -= evicted.current;
+  } else {
+    count++;
+  }
+  window[next] = sample;
+  next = (next + 1) % kWindowSize;
+  powerSum += sample.activePower;
+  voltageSum += sample.voltage;
+  currentSum += sample.current;
+}
+
+PowerMeterAggregator::Summary PowerMeterAggregator::summary() const {
+  Summary result = {};
+  result.energy = energyMilliWattMs / kMilliWattMsPerMilliWattHour;
+  result.samples = count;
+  if (count == 0) {
+    return result;
+  }
+
+  result.minPower = window[0].activePower;
+  result.maxPower = window[0].activePower;
+  for (size_t i = 1; i < count; i++) {
+    if (window[i].activePower < result.minPower) result.minPower = window[i].activePower;
+    if (window[i].activePower > result.maxPower) result.maxPower = window[i].activePower;
+  }
+  result.meanPower = static_cast<int32_t>(powerSum / static_cast<int64_t>(count));
+  result.meanVoltage = static_cast<int32_t>(voltageSum / static_cast<int64_t>(count));
+  result.meanCurrent = static_cast<int32_t>(currentSum / static_cast<int64_t>(count));
+  return result;
+}
+
+bool PowerMeterAggregator::reportDue(uint32_t nowMs) const {
+  if (count == 0) {
+    return false;
+  }
+  if (!hasReported) {
+    return true;
+  }
+
+  uint32_t elapsedMs = nowMs - lastReportMs;
+  if (elapsedMs < thresholds.minIntervalMs) {
+    return false;
+  }
+  if (elapsedMs >= thresholds.maxIntervalMs) {
+    return true;
+  }
+
+  int64_t meanPower = powerSum / static_cast<int64_t>(count);
+  int64_t powerChange = meanPower - lastReportedPower;
+  if (powerChange < 0) powerChange = -powerChange;
+  if (powerChange >= thresholds.powerDelta) {
+    return true;
+  }
+
+  int64_t energy = energyMilliWattMs / kMilliWattMsPerMilliWattHour;
+  return energy - lastReportedEnergy >= thresholds.energyDelta;
+}
+
+void PowerMeterAggregator::markReported(uint32_t nowMs) {
+  hasReported = true;
+  lastReportMs = nowMs;
+  lastReportedPower = count == 0 ? 0 : static_cast<int32_t>(powerSum / static_cast<int64_t>(count));
+  lastReportedEnergy = energyMilliWattMs / kMilliWattMsPerMilliWattHour;
+}
+
+void PowerMeterAggregator::setThresholds(const Thresholds &thresholds) { this->thresholds = thresholds; }
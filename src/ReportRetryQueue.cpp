@@ -0,0 +1,183 @@
+#include "ReportRetryQueue.hpp"
+
+#include <esp_err.h>
+#include <esp_log.h>
+#include <esp_matter.h>
+
+#include <BaseDevice.hpp>
+#include <DeviceRegistry.hpp>
+#include <ReportScheduler.hpp>
+#include <TimerWheel.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace {
+
+// Retries sent per timer expiry, bounds the copy on the wheel context stack
+constexpr size_t kRetryBatch = 8;
+
+void countOnDevice(uint16_t endpointId, BaseDevice::ReportError error) {
+  DeviceRegistry::forEndpoint(
+      endpointId,
+      [](BaseDevice *device, void *context) {
+        device->countReportError(*static_cast<BaseDevice::ReportError *>(context));
+      },
+      &error);
+}
+
+}  // namespace
+
+ReportRetryQueue &ReportRetryQueue::instance() {
+  static ReportRetryQueue queue;
+  return queue;
+}
+
+ReportRetryQueue::ReportRetryQueue() : entries(), pending(0), stats() {}
+
+uint32_t ReportRetryQueue::backoffMs(uint8_t attempt) {
+  uint32_t delayMs = kBaseDelayMs;
+  for (uint8_t i = 0; i < attempt && delayMs < kMaxDelayMs; i++) {
+    delayMs *= 2;
+  }
+  return delayMs < kMaxDelayMs ? delayMs : kMaxDelayMs;
+}
+
+esp_err_t ReportRetryQueue::reportFailed(ReportLane lane, uint16_t endpointId, uint32_t clusterId,
+                                         uint32_t attributeId, const esp_matter_attr_val_t *val, uint8_t attempt,
+                                         uint32_t sequence, esp_err_t err) {
+  countOnDevice(endpointId, BaseDevice::ReportError::Failed);
+
+  esp_err_t result = ESP_OK;
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    Entry *freeEntry = nullptr;
+    Entry *match = nullptr;
+    for (Entry &entry : entries) {
+      if (!entry.used) {
+        if (freeEntry == nullptr) freeEntry = &entry;
+        continue;
+      }
+      if (entry.endpointId == endpointId && entry.clusterId == clusterId && entry.attributeId == attributeId) {
+        match = &entry;
+        break;
+      }
+    }
+
+    if (match != nullptr) {
+      // Only the latest value of the path is retried, keeping the backoff already reached
+      if (ReportScheduler::isNewer(sequence, match->sequence)) {
+        match->val = *val;
+        match->sequence = sequence;
+      }
+      match->lane = lane;
+      if (attempt > match->attempt) match->attempt = attempt;
+      stats.coalesced++;
+      return ESP_OK;
+    }
+
+    if (attempt >= kMaxAttempts) {
+      result = ESP_ERR_TIMEOUT;
+    } else if (freeEntry == nullptr) {
+      result = ESP_ERR_NO_MEM;
+    } else {
+      freeEntry->used = true;
+      freeEntry->lane = lane;
+      freeEntry->attempt = attempt;
+      freeEntry->endpointId = endpointId;
+      freeEntry->clusterId = clusterId;
+      freeEntry->attributeId = attributeId;
+      freeEntry->val = *val;
+      freeEntry->sequence = sequence;
+      freeEntry->dueTick = TimerWheel::device().now() + TimerWheel::msToTicks(backoffMs(attempt));
+      pending.fetch_add(1);
+      stats.queued++;
+      stats.depth = static_cast<uint32_t>(pending.load());
+      armTimer();
+    }
+    if (result != ESP_OK) {
+      stats.dropped++;
+    }
+  }
+
+  if (result != ESP_OK) {
+    ESP_LOGW(__FILENAME__, "Dropping report of endpoint %u cluster 0x%04lx attribute 0x%04lx: %s", endpointId,
+             static_cast<unsigned long>(clusterId), static_cast<unsigned long>(attributeId),
+             esp_err_to_name(err));
+    countOnDevice(endpointId, BaseDevice::ReportError::Dropped);
+  }
+  return result;
+}
+
+void ReportRetryQueue::cancel(uint16_t endpointId, uint32_t clusterId, uint32_t attributeId) {
+  if (pending.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(mutex);
+  for (Entry &entry : entries) {
+    if (entry.used && entry.endpointId == endpointId && entry.clusterId == clusterId &&
+        entry.attributeId == attributeId) {
+      entry.used = false;
+      pending.fetch_sub(1);
+      stats.cancelled++;
+      stats.depth = static_cast<uint32_t>(pending.load());
+      return;
+    }
+  }
+}
+
+size_t ReportRetryQueue::retryDue() {
+  Entry due[kRetryBatch];
+  size_t count = 0;
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    uint64_t now = TimerWheel::device().now();
+    for (Entry &entry : entries) {
+      if (count == kRetryBatch) {
+        break;
+      }
+      if (entry.used && entry.dueTick <= now) {
+        due[count++] = entry;
+        entry.used = false;
+        pending.fetch_sub(1);
+      }
+    }
+    stats.retried += static_cast<uint32_t>(count);
+    stats.depth = static_cast<uint32_t>(pending.load());
+    armTimer();
+  }
+
+  // Outside the mutex, a retry that fails synchronously comes straight back through reportFailed()
+  ReportScheduler &scheduler = ReportScheduler::instance();
+  for (size_t i = 0; i < count; i++) {
+    countOnDevice(due[i].endpointId, BaseDevice::ReportError::Retried);
+    scheduler.reportAttribute(due[i].lane, due[i].endpointId, due[i].clusterId, due[i].attributeId, &due[i].val,
+                              static_cast<uint8_t>(due[i].attempt + 1), due[i].sequence);
+  }
+  return count;
+}
+
+ReportRetryQueue::Stats ReportRetryQueue::getStats() {
+  std::lock_guard<std::mutex> guard(mutex);
+  return stats;
+}
+
+void ReportRetryQueue::armTimer() {
+  uint64_t earliest = UINT64_MAX;
+  for (const Entry &entry : entries) {
+    if (entry.used && entry.dueTick < earliest) {
+      earliest = entry.dueTick;
+    }
+  }
+
+  TimerWheel &wheel = TimerWheel::device();
+  if (earliest == UINT64_MAX) {
+    wheel.cancel(timer);
+    return;
+  }
+  uint64_t now = wheel.now();
+  uint32_t delayTicks = earliest > now ? static_cast<uint32_t>(earliest - now) : 0;
+  wheel.schedule(timer, delayTicks, [](void *self) { static_cast<ReportRetryQueue *>(self)->retryDue(); }, this);
+}
@@ -0,0 +1,462 @@
+#include "ReportScheduler.hpp"
+
+#include <esp_err.h>
+#include <esp_log.h>
+#include <esp_matter.h>
+
+#include <ReportRetryQueue.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// The queue keeps a shallow copy of the value, so only values without a buffer may be queued
+bool isScalar(const esp_matter_attr_val_t *val) {
+  switch (val->type) {
+    case ESP_MATTER_VAL_TYPE_CHAR_STRING:
+    case ESP_MATTER_VAL_TYPE_LONG_CHAR_STRING:
+    case ESP_MATTER_VAL_TYPE_OCTET_STRING:
+    case ESP_MATTER_VAL_TYPE_LONG_OCTET_STRING:
+    case ESP_MATTER_VAL_TYPE_ARRAY:
+      return false;
+    default:
+      return true;
+  }
+}
+
+}  // namespace
+
+ReportScheduler &ReportScheduler::instance() {
+  static ReportScheduler scheduler;
+  return scheduler;
+}
+
+ReportScheduler::FlushWaiter::FlushWaiter()
+    : next(nullptr), target(), callback(nullptr), context(nullptr), registered(false) {}
+
+ReportScheduler::ReportScheduler() : flushWaiters(nullptr), lanes(), tracked(), lastSequence(0), running(false) {
+  setWeight(ReportLane::Interactive, 0);
+  setWeight(ReportLane::State, 4);
+  setWeight(ReportLane::Telemetry, 1);
+}
+
+int64_t ReportScheduler::nowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+esp_err_t ReportScheduler::start() {
+  std::lock_guard<std::mutex> guard(laneMutex);
+  if (running) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  running = true;
+  worker = std::thread([this]() { run(); });
+  return ESP_OK;
+}
+
+void ReportScheduler::stop() {
+  {
+    std::lock_guard<std::mutex> guard(laneMutex);
+    if (!running) {
+      return;
+    }
+    running = false;
+  }
+  pending.notify_all();
+  if (worker.get_id() == std::this_thread::get_id()) {
+    // Called from a report on the worker itself: it drains the lanes and ends after returning
+    worker.detach();
+    return;
+  }
+  worker.join();
+}
+
+bool ReportScheduler::isRunning() {
+  std::lock_guard<std::mutex> guard(laneMutex);
+  return running;
+}
+
+void ReportScheduler::setWeight(ReportLane lane, uint8_t weight) {
+  std::lock_guard<std::mutex> guard(laneMutex);
+  Lane &target = lanes[static_cast<size_t>(lane)];
+  target.weight = weight;
+  target.credits = weight;
+}
+
+bool ReportScheduler::isNewer(uint32_t sequence, uint32_t than) { return static_cast<int32_t>(sequence - than) > 0; }
+
+esp_err_t ReportScheduler::reportAttribute(ReportLane lane, uint16_t endpointId, uint32_t clusterId,
+                                           uint32_t attributeId, const esp_matter_attr_val_t *val, uint8_t attempt,
+                                           uint32_t sequence) {
+  if (!isScalar(val)) {
+    ESP_LOGE(__FILENAME__, "Rejecting report of 0x%08lx/0x%08lx, string and array values cannot be queued",
+             static_cast<unsigned long>(clusterId), static_cast<unsigned long>(attributeId));
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+  if (attempt == 0) {
+    ReportRetryQueue::instance().cancel(endpointId, clusterId, attributeId);
+  }
+
+  Report report = {};
+  report.event = nullptr;
+  report.endpointId = endpointId;
+  report.clusterId = clusterId;
+  report.attributeId = attributeId;
+  report.val = *val;
+  report.attempt = attempt;
+  report.sequence = sequence;
+  return enqueue(lane, report);
+}
+
+esp_err_t ReportScheduler::reportAttributes(ReportLane lane, const AttributeReport *reports, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    if (!isScalar(&reports[i].val)) {
+      ESP_LOGE(__FILENAME__, "Rejecting batch with 0x%08lx/0x%08lx, string and array values cannot be queued",
+               static_cast<unsigned long>(reports[i].clusterId), static_cast<unsigned long>(reports[i].attributeId));
+      return ESP_ERR_NOT_SUPPORTED;
+    }
+  }
+
+  // send() finds the lock taken by this task and keeps it for the whole batch
+  size_t laneIndex = static_cast<size_t>(lane);
+  esp_err_t err = ESP_OK;
+  esp_matter::lock::status_t lockStatus = esp_matter::lock::chip_stack_lock(portMAX_DELAY);
+  for (size_t i = 0; i < count; i++) {
+    ReportRetryQueue::instance().cancel(reports[i].endpointId, reports[i].clusterId, reports[i].attributeId);
+
+    Report report = {};
+    report.event = nullptr;
+    report.endpointId = reports[i].endpointId;
+    report.clusterId = reports[i].clusterId;
+    report.attributeId = reports[i].attributeId;
+    report.val = reports[i].val;
+    {
+      std::lock_guard<std::mutex> guard(laneMutex);
+      report.sequence = stampFresh(report);
+    }
+    report.enqueuedUs = nowUs();
+    esp_err_t reportErr = send(report, laneIndex);
+    if (err == ESP_OK) err = reportErr;
+  }
+  if (lockStatus == esp_matter::lock::SUCCESS) {
+    esp_matter::lock::chip_stack_unlock();
+  }
+  return err;
+}
+
+esp_err_t ReportScheduler::sendEvent(ReportLane lane, EventCallback callback, uint16_t endpointId, uint32_t arg) {
+  Report report = {};
+  report.event = callback;
+  report.endpointId = endpointId;
+  report.attributeId = arg;
+  return enqueue(lane, report);
+}
+
+uint32_t ReportScheduler::stampFresh(const Report &report) {
+  // Sequence 0 marks a free slot
+  if (++lastSequence == 0) {
+    ++lastSequence;
+  }
+
+  // Reuse the slot of the path, or take the one with the oldest report
+  TrackedPath *slot = &tracked[0];
+  for (TrackedPath &path : tracked) {
+    if (path.sequence != 0 && path.endpointId == report.endpointId && path.clusterId == report.clusterId &&
+        path.attributeId == report.attributeId) {
+      slot = &path;
+      break;
+    }
+    if (slot->sequence != 0 && (path.sequence == 0 || isNewer(slot->sequence, path.sequence))) {
+      slot = &path;
+    }
+  }
+  *slot = TrackedPath{report.endpointId, report.clusterId, report.attributeId, lastSequence};
+  return lastSequence;
+}
+
+bool ReportScheduler::isSuperseded(const Report &report) const {
+  for (const TrackedPath &path : tracked) {
+    if (path.sequence != 0 && path.endpointId == report.endpointId && path.clusterId == report.clusterId &&
+        path.attributeId == report.attributeId) {
+      return isNewer(path.sequence, report.sequence);
+    }
+  }
+  return false;
+}
+
+esp_err_t ReportScheduler::enqueue(ReportLane lane, const Report &request) {
+  size_t laneIndex = static_cast<size_t>(lane);
+  Report report = request;
+  {
+    std::lock_guard<std::mutex> guard(laneMutex);
+    if (report.event == nullptr) {
+      if (report.attempt == 0) {
+        report.sequence = stampFresh(report);
+      } else if (isSuperseded(report)) {
+        // A retry resubmitted after a fresh report of its path must not bring back the older value
+        lanes[laneIndex].stats.superseded++;
+        return ESP_OK;
+      }
+    }
+    if (running) {
+      Lane &target = lanes[laneIndex];
+
+      // The latest value of a pending attribute report wins
+      if (report.event == nullptr) {
+        for (size_t i = 0; i < target.count; i++) {
+          Report &queued = target.queue[(target.head + i) % kQueueDepth];
+          if (queued.event == nullptr && queued.endpointId == report.endpointId &&
+              queued.clusterId == report.clusterId && queued.attributeId == report.attributeId) {
+            queued.val = report.val;
+            queued.attempt = report.attempt;
+            queued.sequence = report.sequence;
+            target.stats.coalesced++;
+            return ESP_OK;
+          }
+        }
+      }
+
+      if (target.count < kQueueDepth) {
+        Report &slot = target.queue[(target.head + target.count) % kQueueDepth];
+        slot = report;
+        slot.enqueuedUs = nowUs();
+        target.count++;
+        target.pushed++;
+        target.stats.enqueued++;
+        target.stats.depth = static_cast<uint32_t>(target.count);
+        if (target.stats.depth > target.stats.maxDepth) {
+          target.stats.maxDepth = target.stats.depth;
+        }
+        pending.notify_one();
+        return ESP_OK;
+      }
+      target.stats.overflowed++;
+      ESP_LOGW(__FILENAME__, "Report lane %u full, reporting synchronously", static_cast<unsigned>(laneIndex));
+    }
+  }
+
+  // Not running, or the lane is full: never drop, report on the calling task
+  Report synchronous = report;
+  synchronous.enqueuedUs = nowUs();
+  return send(synchronous, laneIndex);
+}
+
+bool ReportScheduler::popNext(Report &report, size_t &laneIndex) {
+  while (true) {
+    // Strict priority lanes first
+    laneIndex = kLanes;
+    for (size_t i = 0; i < kLanes; i++) {
+      if (lanes[i].weight == 0 && lanes[i].count > 0) {
+        laneIndex = i;
+        break;
+      }
+    }
+
+    // Weighted round robin, always scanning from the highest lane
+    for (int round = 0; round < 2 && laneIndex == kLanes; round++) {
+      for (size_t i = 0; i < kLanes; i++) {
+        if (lanes[i].weight > 0 && lanes[i].count > 0 && lanes[i].credits > 0) {
+          lanes[i].credits--;
+          laneIndex = i;
+          break;
+        }
+      }
+      if (laneIndex == kLanes) {
+        for (Lane &lane : lanes) {
+          lane.credits = lane.weight;
+        }
+      }
+    }
+    if (laneIndex == kLanes) {
+      return false;
+    }
+
+    Lane &lane = lanes[laneIndex];
+    report = lane.queue[lane.head];
+    lane.head = (lane.head + 1) % kQueueDepth;
+    lane.count--;
+    lane.stats.depth = static_cast<uint32_t>(lane.count);
+    if (report.event != nullptr || !isSuperseded(report)) {
+      return true;
+    }
+
+    // A batch or a synchronous report sent a fresher value of the path while this one was queued
+    lane.stats.superseded++;
+    lane.sent++;
+  }
+}
+
+esp_err_t ReportScheduler::send(Report &report, size_t laneIndex) {
+  esp_err_t err = ESP_OK;
+
+  // A synchronous report from the stack context already holds the lock and must keep it
+  esp_matter::lock::status_t lockStatus = esp_matter::lock::chip_stack_lock(portMAX_DELAY);
+  if (report.event != nullptr) {
+    report.event(report.endpointId, report.attributeId);
+  } else {
+    err = esp_matter::attribute::report(report.endpointId, report.clusterId, report.attributeId, &report.val);
+  }
+  if (lockStatus == esp_matter::lock::SUCCESS) {
+    esp_matter::lock::chip_stack_unlock();
+  }
+
+  if (err != ESP_OK) {
+    ReportRetryQueue::instance().reportFailed(static_cast<ReportLane>(laneIndex), report.endpointId, report.clusterId,
+                                              report.attributeId, &report.val, report.attempt, report.sequence, err);
+  }
+
+  int64_t latencyUs = nowUs() - report.enqueuedUs;
+  std::lock_guard<std::mutex> guard(laneMutex);
+  LaneStats &stats = lanes[laneIndex].stats;
+  stats.dispatched++;
+  if (err != ESP_OK) {
+    stats.failed++;
+  }
+  stats.totalLatencyUs += static_cast<uint64_t>(latencyUs);
+  if (latencyUs > stats.maxLatencyUs) {
+    stats.maxLatencyUs = static_cast<uint32_t>(latencyUs);
+  }
+  return err;
+}
+
+size_t ReportScheduler::dispatch(size_t maxReports) {
+  size_t dispatched = 0;
+  while (dispatched < maxReports) {
+    Report report;
+    size_t laneIndex;
+    bool drained;
+    bool hasWaiters;
+    {
+      std::lock_guard<std::mutex> guard(laneMutex);
+      drained = !popNext(report, laneIndex);
+      hasWaiters = flushWaiters != nullptr;
+    }
+    if (drained) {
+      // Dropping superseded reports may have completed a waiter
+      if (hasWaiters) {
+        completeFlushWaiters();
+      }
+      break;
+    }
+    send(report, laneIndex);
+    dispatched++;
+
+    {
+      std::lock_guard<std::mutex> guard(laneMutex);
+      lanes[laneIndex].sent++;
+      hasWaiters = flushWaiters != nullptr;
+    }
+    if (hasWaiters) {
+      completeFlushWaiters();
+    }
+  }
+  return dispatched;
+}
+
+bool ReportScheduler::notifyFlushed(FlushWaiter &waiter, FlushCallback callback, void *context) {
+  std::lock_guard<std::mutex> guard(laneMutex);
+  bool flushed = true;
+  for (size_t i = 0; i < kLanes; i++) {
+    waiter.target[i] = lanes[i].pushed;
+    flushed = flushed && lanes[i].sent == lanes[i].pushed;
+  }
+  if (flushed) {
+    return false;
+  }
+
+  waiter.callback = callback;
+  waiter.context = context;
+  waiter.registered = true;
+  waiter.next = flushWaiters;
+  flushWaiters = &waiter;
+  return true;
+}
+
+void ReportScheduler::cancelFlushed(FlushWaiter &waiter) {
+  // Taking flushMutex first waits for a callback that is running right now
+  std::lock_guard<std::mutex> flushGuard(flushMutex);
+  std::lock_guard<std::mutex> guard(laneMutex);
+  if (!waiter.registered) {
+    return;
+  }
+  for (FlushWaiter **link = &flushWaiters; *link != nullptr; link = &(*link)->next) {
+    if (*link == &waiter) {
+      *link = waiter.next;
+      break;
+    }
+  }
+  waiter.registered = false;
+}
+
+void ReportScheduler::completeFlushWaiters() {
+  std::lock_guard<std::mutex> flushGuard(flushMutex);
+  FlushWaiter *done = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(laneMutex);
+    FlushWaiter **link = &flushWaiters;
+    while (*link != nullptr) {
+      FlushWaiter *waiter = *link;
+      bool flushed = true;
+      for (size_t i = 0; i < kLanes; i++) {
+        flushed = flushed && lanes[i].sent >= waiter->target[i];
+      }
+      if (!flushed) {
+        link = &waiter->next;
+        continue;
+      }
+      *link = waiter->next;
+      waiter->registered = false;
+      waiter->next = done;
+      done = waiter;
+    }
+  }
+
+  // Still under flushMutex, so cancelFlushed() cannot return while a waiter is being called
+  while (done != nullptr) {
+    FlushWaiter *waiter = done;
+    done = waiter->next;
+    waiter->next = nullptr;
+    waiter->callback(waiter->context);
+  }
+}
+
+ReportScheduler::LaneStats ReportScheduler::getStats(ReportLane lane) {
+  std::lock_guard<std::mutex> guard(laneMutex);
+  return lanes[static_cast<size_t>(lane)].stats;
+}
+
+void ReportScheduler::resetStats() {
+  std::lock_guard<std::mutex> guard(laneMutex);
+  for (Lane &lane : lanes) {
+    uint32_t depth = lane.stats.depth;
+    lane.stats = LaneStats();
+    lane.stats.depth = depth;
+    lane.stats.maxDepth = depth;
+  }
+}
+
+void ReportScheduler::run() {
+  std::unique_lock<std::mutex> lock(laneMutex);
+  while (true) {
+    bool hasReports = false;
+    for (const Lane &lane : lanes) {
+      hasReports = hasReports || lane.count > 0;
+    }
+    if (!hasReports) {
+      if (!running) {
+        break;
+      }
+      pending.wait(lock);
+      continue;
+    }
+    lock.unlock();
+    dispatch(kQueueDepth);
+    lock.lock();
+  }
+}
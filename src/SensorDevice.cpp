@@ -0,0 +1,232 @@
+#include "SensorDevice.hpp"
+
+#include <esp_err.h>
+#include <esp_log.h>
+#include <esp_matter.h>
+#include <esp_matter_endpoint.h>
+
+#include <DeviceConfig.hpp>
+#include <DeviceName.hpp>
+#include <SensorAccessoryInterface.hpp>
+#include <SensorFilter.hpp>
+#include <SeqLock.hpp>
+#include <StateStream.hpp>
+#include <TimerWheel.hpp>
+#include <cstdint>
+#include <utility>
+
+namespace {
+
+// Attribute ranges, absolute zero to the int16 limit and 0 to 100 %
+constexpr int32_t kMinTemperature = -27315;
+constexpr int32_t kMaxTemperature = 32767;
+constexpr int32_t kMaxHumidity = 10000;
+
+const SensorFilter::Config &defaultFilter(SensorDevice::SensorType sensorType) {
+  switch (sensorType) {
+    case SensorDevice::SensorType::Humidity:
+      return DeviceConfig::kHumidityFilter;
+    case SensorDevice::SensorType::Occupancy:
+      return DeviceConfig::kOccupancyFilter;
+    case SensorDevice::SensorType::Temperature:
+    default:
+      return DeviceConfig::kTemperatureFilter;
+  }
+}
+
+int32_t clamp(int32_t value, int32_t low, int32_t high) { return value < low ? low : (value > high ? high : value); }
+
+uint32_t wheelNowMs() { return static_cast<uint32_t>(TimerWheel::device().now() * TimerWheel::kTickMs); }
+
+}  // namespace
+
+SensorDevice::SensorDevice(DeviceName device_name, SensorAccessoryInterface *accessory,
+                           esp_matter::endpoint_t *aggregator, SensorType sensorType)
+    : BaseDevice(),
+      accessory(accessory),
+      name(std::move(device_name)),
+      sensorType(sensorType),
+      shadow(State{false, 0}),
+      filter(defaultFilter(sensorType)),
+      pendingFilterConfig(defaultFilter(sensorType)) {
+  // Samples pushed by the accessory are filtered on the wheel like the periodic ones
+  if (accessory != nullptr) {
+    accessory->setReportAppCallback([](void *self) { static_cast<SensorDevice *>(self)->reportEndpoint(); },
+                                    this);
+  } else {
+    ESP_LOGW(__FILENAME__, "SensorDevice has no accessory, it will never report");
+  }
+
+  // Check if an aggregator is provided
+  if (aggregator != nullptr) {
+    esp_matter::endpoint::bridged_node::config_t bridged_node_config;
+    uint8_t flags = esp_matter::endpoint_flags::ENDPOINT_FLAG_BRIDGE |
+                    esp_matter::endpoint_flags::ENDPOINT_FLAG_DESTROYABLE;
+    endpoint = esp_matter::endpoint::bridged_node::create(esp_matter::node::get(), &bridged_node_config,
+                                                          flags, this);
+
+    if (name.length() > 0) {
+      ESP_LOGI(__FILENAME__, "Creating Bridged Node SensorDevice with name: %s", name.get());
+      esp_matter::cluster_t *bridge_device_basic_information_cluster =
+          esp_matter::cluster::get(endpoint, chip::app::Clusters::BridgedDeviceBasicInformation::Id);
+      esp_matter::cluster::bridged_device_basic_information::attribute::create_node_label(
+          bridge_device_basic_information_cluster, name.get(), name.length());
+    } else {
+      ESP_LOGW(__FILENAME__, "device_name is not set");
+      ESP_LOGI(__FILENAME__, "Creating Bridged Node SensorDevice with default name");
+    }
+    esp_matter::endpoint::set_parent_endpoint(endpoint, aggregator);
+  } else {
+    ESP_LOGI(__FILENAME__, "Creating SensorDevice standalone endpoint");
+    uint8_t flags = esp_matter::endpoint_flags::ENDPOINT_FLAG_NONE;
+    endpoint = esp_matter::endpoint::create(esp_matter::node::get(), flags, this);
+  }
+
+  switch (sensorType) {
+    case SensorType::Humidity: {
+      esp_matter::endpoint::humidity_sensor::config_t humidity_sensor_config;
+      esp_matter::endpoint::humidity_sensor::add(endpoint, &humidity_sensor_config);
+      break;
+    }
+    case SensorType::Occupancy: {
+      esp_matter::endpoint::occupancy_sensor::config_t occupancy_sensor_config;
+      esp_matter::endpoint::occupancy_sensor::add(endpoint, &occupancy_sensor_config);
+      break;
+    }
+    case SensorType::Temperature:
+    default: {
+      esp_matter::endpoint::temperature_sensor::config_t temperature_sensor_config;
+      esp_matter::endpoint::temperature_sensor::add(endpoint, &temperature_sensor_config);
+      break;
+    }
+  }
+
+  registerDevice();
+}
+
+SensorDevice::~SensorDevice() {
+  unregisterDevice();
+  stopSampling();
+}
+
+esp_err_t SensorDevice::updateAccessory() { return ESP_OK; }
+
+esp_err_t SensorDevice::reportEndpoint() {
+  // Keep every filter access on the wheel context, the callback may come from another task
+  TimerWheel::device().schedule(
+      wakeTimer, 0, [](void *self) { static_cast<SensorDevice *>(self)->sample(wheelNowMs()); }, this);
+  return ESP_OK;
+}
+
+esp_err_t SensorDevice::identify() {
+  ESP_LOGI(__FILENAME__, "Identifying SensorDevice");
+
+  if (accessory == nullptr) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  accessory->identifyYourSelf();
+  return ESP_OK;
+}
+
+void SensorDevice::fillSnapshot(DeviceSnapshot &snapshot, size_t index) const {
+  static constexpr DeviceType kTypes[] = {DeviceType::TemperatureSensor, DeviceType::HumiditySensor,
+                                          DeviceType::OccupancySensor};
+  State state = shadow.read();
+  if (snapshot.endpointIds != nullptr) snapshot.endpointIds[index] = esp_matter::endpoint::get_id(endpoint);
+  if (snapshot.types != nullptr) snapshot.types[index] = kTypes[static_cast<uint8_t>(sensorType)];
+  if (snapshot.sensorValue != nullptr) snapshot.sensorValue[index] = state.value;
+}
+
+size_t SensorDevice::getEndpointIds(uint16_t *endpointIds, size_t capacity) const {
+  if (capacity == 0) {
+    return 0;
+  }
+  endpointIds[0] = esp_matter::endpoint::get_id(endpoint);
+  return 1;
+}
+
+esp_err_t SensorDevice::sample(uint32_t nowMs) {
+  if (accessory == nullptr) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  int32_t raw;
+  if (!accessory->readSample(raw)) {
+    ESP_LOGW(__FILENAME__, "SensorDevice read failed");
+    return ESP_FAIL;
+  }
+  filter.addSample(raw);
+
+  // Only report when the filtered value moved enough or the max interval expired
+  esp_err_t err = ESP_OK;
+  if (filter.reportDue(nowMs)) {
+    int32_t value = filter.value();
+    ESP_LOGI(__FILENAME__, "Reporting SensorDevice value %ld", static_cast<long>(value));
+    // A rejected report is retried by the ReportRetryQueue, so the value counts as reported
+    err = setEndpointMeasuredValue(value);
+    cacheValue(value);
+    filter.markReported(nowMs);
+  }
+  return err;
+}
+
+esp_err_t SensorDevice::startSampling(uint32_t intervalMs) {
+  uint32_t ticks = TimerWheel::msToTicks(intervalMs);
+  TimerWheel::device().schedule(
+      sampleTimer, ticks, [](void *self) { static_cast<SensorDevice *>(self)->sample(wheelNowMs()); }, this,
+      ticks);
+  return ESP_OK;
+}
+
+void SensorDevice::stopSampling() {
+  TimerWheel::device().cancelAndWait(sampleTimer);
+  TimerWheel::device().cancelAndWait(wakeTimer);
+  TimerWheel::device().cancelAndWait(configTimer);
+}
+
+void SensorDevice::setFilterConfig(const SensorFilter::Config &config) {
+  // The filter belongs to the wheel context, hand the configuration over like a sample
+  pendingFilterConfig.write(config);
+  TimerWheel::device().schedule(
+      configTimer, 0,
+      [](void *context) {
+        SensorDevice *self = static_cast<SensorDevice *>(context);
+        self->filter.setConfig(self->pendingFilterConfig.read());
+      },
+      this);
+}
+
+SensorDevice::SensorType SensorDevice::getSensorType() const { return sensorType; }
+
+SensorDevice::State SensorDevice::getState() const { return shadow.read(); }
+
+esp_err_t SensorDevice::setEndpointMeasuredValue(int32_t value) {
+  uint16_t endpoint_id = esp_matter::endpoint::get_id(endpoint);
+  esp_matter_attr_val_t attr_val;
+  switch (sensorType) {
+    case SensorType::Humidity:
+      attr_val = esp_matter_nullable_uint16(static_cast<uint16_t>(clamp(value, 0, kMaxHumidity)));
+      return reportAttribute(endpoint_id, chip::app::Clusters::RelativeHumidityMeasurement::Id,
+                             chip::app::Clusters::RelativeHumidityMeasurement::Attributes::MeasuredValue::Id,
+                             &attr_val, ReportLane::Telemetry);
+    case SensorType::Occupancy:
+      attr_val = esp_matter_bitmap8(value != 0 ? 1 : 0);
+      return reportAttribute(endpoint_id, chip::app::Clusters::OccupancySensing::Id,
+                             chip::app::Clusters::OccupancySensing::Attributes::Occupancy::Id, &attr_val);
+    case SensorType::Temperature:
+    default:
+      attr_val = esp_matter_nullable_int16(static_cast<int16_t>(clamp(value, kMinTemperature, kMaxTemperature)));
+      return reportAttribute(endpoint_id, chip::app::Clusters::TemperatureMeasurement::Id,
+                             chip::app::Clusters::TemperatureMeasurement::Attributes::MeasuredValue::Id, &attr_val,
+                             ReportLane::Telemetry);
+  }
+}
+
+void SensorDevice::cacheValue(int32_t value) {
+  State previous = shadow.modify([value](State &state) {
+    state.valid = true;
+    state.value = value;
+  });
+  if (!previous.valid || previous.value != value) {
+    StateStreamEncoder::emit(esp_matter::endpoint::get_id(endpoint), StateChangeKind::SensorValue, value);
+  }
+}
@@ -0,0 +1,112 @@
+#include "SensorFilter.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace {
+
+// Division rounded to the nearest integer, halves away from zero
+int32_t divideRounded(int64_t dividend, int64_t divisor) {
+  int64_t half = divisor / 2;
+  return static_cast<int32_t>(dividend >= 0 ? (dividend + half) / divisor : (dividend - half) / divisor);
+}
+
+int64_t distance(int64_t a, int64_t b) { return a > b ? a - b : b - a; }
+
+}  // namespace
+
+SensorFilter::SensorFilter() : SensorFilter(Config()) {}
+
+SensorFilter::SensorFilter(const Config &config)
+    : config(),
+      decimationSum(0),
+      decimationCount(0),
+      average(),
+      averageSum(0),
+      averageNext(0),
+      averageCount(0),
+      hasOutput(false),
+      output(0),
+      hasReported(false),
+      lastReportMs(0),
+      lastReportedValue(0) {
+  setConfig(config);
+}
+
+bool SensorFilter::addSample(int32_t raw) {
+  // Decimation
+  decimationSum += raw;
+  if (++decimationCount < config.decimation) {
+    return false;
+  }
+  int32_t decimated = divideRounded(decimationSum, decimationCount);
+  decimationSum = 0;
+  decimationCount = 0;
+
+  // Moving average
+  if (averageCount == config.averageLength) {
+    averageSum -= average[averageNext];
+  } else {
+    averageCount++;
+  }
+  average[averageNext] = decimated;
+  averageNext = static_cast<uint8_t>((averageNext + 1) % config.averageLength);
+  averageSum += decimated;
+  int32_t mean = divideRounded(averageSum, averageCount);
+
+  // Hysteresis
+  if (hasOutput && distance(mean, output) <= config.hysteresis) {
+    return false;
+  }
+  bool changed = !hasOutput || mean != output;
+  output = mean;
+  hasOutput = true;
+  return changed;
+}
+
+bool SensorFilter::hasValue() const { return hasOutput; }
+
+int32_t SensorFilter::value() const { return output; }
+
+bool SensorFilter::reportDue(uint32_t nowMs) const {
+  if (!hasOutput) {
+    return false;
+  }
+  if (!hasReported) {
+    return true;
+  }
+
+  uint32_t elapsedMs = nowMs - lastReportMs;
+  if (elapsedMs < config.minIntervalMs) {
+    return false;
+  }
+  if (elapsedMs >= config.maxIntervalMs) {
+    return true;
+  }
+  return distance(output, lastReportedValue) >= config.reportDelta;
+}
+
+void SensorFilter::markReported(uint32_t nowMs) {
+  hasReported = true;
+  lastReportMs = nowMs;
+  lastReportedValue = output;
+}
+
+void SensorFilter::setConfig(const Config &config) {
+  this->config = config;
+  if (this->config.decimation == 0) this->config.decimation = 1;
+  if (this->config.averageLength == 0) this->config.averageLength = 1;
+  if (this->config.averageLength > kMaxAverageLength) this->config.averageLength = kMaxAverageLength;
+  if (this->config.hysteresis < 0) this->config.hysteresis = 0;
+  if (this->config.reportDelta < 1) this->config.reportDelta = 1;
+  reset();
+}
+
+void SensorFilter::reset() {
+  decimationSum = 0;
+  decimationCount = 0;
+  averageSum = 0;
+  averageNext = 0;
+  averageCount = 0;
+  hasOutput = false;
+}
@@ -0,0 +1,137 @@
+#include "StateStream.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+namespace {
+
+size_t writeVarint(uint8_t *out, uint32_t value) {
+  size_t length = 0;
+  while (value >= 0x80) {
+    out[length++] = static_cast<uint8_t>(value | 0x80);
+    value >>= 7;
+  }
+  out[length++] = static_cast<uint8_t>(value);
+  return length;
+}
+
+uint32_t zigzagEncode(int32_t value) {
+  return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+}  // namespace
+
+StateStreamRing::StateStreamRing(uint8_t *buffer, size_t size)
+    : buffer(buffer), slots(size / kRecordSize), head(0), tail(0) {}
+
+uint8_t *StateStreamRing::acquire() {
+  uint32_t written = head.load(std::memory_order_relaxed);
+  if (slots == 0 || written - tail.load(std::memory_order_acquire) >= slots) {
+    return nullptr;
+  }
+  return buffer + (written % slots) * kRecordSize;
+}
+
+void StateStreamRing::commit() { head.fetch_add(1, std::memory_order_release); }
+
+const uint8_t *StateStreamRing::peek() const {
+  uint32_t read = tail.load(std::memory_order_relaxed);
+  if (head.load(std::memory_order_acquire) == read) {
+    return nullptr;
+  }
+  return buffer + (read % slots) * kRecordSize;
+}
+
+void StateStreamRing::release() { tail.fetch_add(1, std::memory_order_release); }
+
+size_t StateStreamRing::pending() const {
+  return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+}
+
+std::atomic<StateStreamEncoder *> StateStreamEncoder::installed(nullptr);
+
+StateStreamEncoder::StateStreamEncoder(StateStreamRing &ring)
+    : ring(ring), tracked(), sequence(0), writtenSequence(0), dropped(0) {}
+
+bool StateStreamEncoder::publish(uint16_t endpointId, StateChangeKind kind, int32_t value) {
+  std::lock_guard<std::mutex> guard(producerMutex);
+  sequence++;
+
+  uint8_t *slot = ring.acquire();
+  if (slot == nullptr) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // Find the delta base for this endpoint/kind, or the least recently used entry to track it
+  uint8_t kindByte = static_cast<uint8_t>(kind);
+  TrackedKey *entry = nullptr;
+  TrackedKey *victim = &tracked[0];
+  for (TrackedKey &candidate : tracked) {
+    if (candidate.kind == kindByte && candidate.endpointId == endpointId) {
+      entry = &candidate;
+      break;
+    }
+    // Free entries were never used and always win
+    if (candidate.lastUse < victim->lastUse) {
+      victim = &candidate;
+    }
+  }
+
+  bool absolute = entry == nullptr || entry->deltas >= kKeyframeInterval;
+  if (entry == nullptr) {
+    entry = victim;
+    entry->endpointId = endpointId;
+    entry->kind = kindByte;
+  }
+  uint32_t encodedValue;
+  if (absolute) {
+    kindByte |= kAbsoluteFlag;
+    encodedValue = zigzagEncode(value);
+    entry->deltas = 0;
+  } else {
+    encodedValue = zigzagEncode(static_cast<int32_t>(static_cast<uint32_t>(value) -
+                                                     static_cast<uint32_t>(entry->value)));
+    entry->deltas++;
+  }
+  entry->value = value;
+  entry->lastUse = sequence;
+
+  size_t length = 1;
+  slot[length++] = kindByte;
+  length += writeVarint(slot + length, sequence - writtenSequence);
+  length += writeVarint(slot + length, endpointId);
+  length += writeVarint(slot + length, encodedValue);
+  slot[0] = static_cast<uint8_t>(length - 1);
+  memset(slot + length, 0, StateStreamRing::kRecordSize - length);
+
+  writtenSequence = sequence;
+  ring.commit();
+  return true;
+}
+
+void StateStreamEncoder::resync() {
+  std::lock_guard<std::mutex> guard(producerMutex);
+  for (TrackedKey &entry : tracked) {
+    entry.deltas = kKeyframeInterval;
+  }
+}
+
+uint32_t StateStreamEncoder::droppedRecords() const { return dropped.load(std::memory_order_relaxed); }
+
+void StateStreamEncoder::install(StateStreamEncoder *encoder) {
+  if (encoder != nullptr) {
+    encoder->resync();
+  }
+  installed.store(encoder, std::memory_order_release);
+}
+
+void StateStreamEncoder::emit(uint16_t endpointId, StateChangeKind kind, int32_t value) {
+  StateStreamEncoder *encoder = installed.load(std::memory_order_acquire);
+  if (encoder != nullptr) {
+    encoder->publish(endpointId, kind, value);
+  }
+}
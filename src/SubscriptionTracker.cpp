@@ -0,0 +1,136 @@
+#include "SubscriptionTracker.hpp"
+
+#include <esp_err.h>
+#include <esp_log.h>
+#include <esp_matter.h>
+
+#include <BaseDevice.hpp>
+#include <DeviceRegistry.hpp>
+#include <TimerWheel.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+SubscriptionTracker &SubscriptionTracker::instance() {
+  static SubscriptionTracker tracker;
+  return tracker;
+}
+
+SubscriptionTracker::SubscriptionTracker() : interests(), attached(false), overflow(0), deferred(0) {}
+
+esp_err_t SubscriptionTracker::attach(SubscriptionEventSource &source) {
+  esp_err_t err = source.setListener(
+      [](void *self, uint16_t endpointId, uint32_t clusterId, bool isSubscribed) {
+        SubscriptionTracker *tracker = static_cast<SubscriptionTracker *>(self);
+        if (isSubscribed) {
+          tracker->subscribed(endpointId, clusterId);
+        } else {
+          tracker->unsubscribed(endpointId, clusterId);
+        }
+      },
+      this);
+  if (err == ESP_OK) {
+    std::lock_guard<std::mutex> guard(interestMutex);
+    attached = true;
+  }
+  return err;
+}
+
+void SubscriptionTracker::subscribed(uint16_t endpointId, uint32_t clusterId) {
+  {
+    std::lock_guard<std::mutex> guard(interestMutex);
+    Interest *freeEntry = nullptr;
+    Interest *entry = nullptr;
+    for (Interest &interest : interests) {
+      if (interest.count > 0 && interest.endpointId == endpointId && interest.clusterId == clusterId) {
+        entry = &interest;
+        break;
+      }
+      if (interest.count == 0 && freeEntry == nullptr) {
+        freeEntry = &interest;
+      }
+    }
+    if (entry == nullptr && freeEntry != nullptr) {
+      entry = freeEntry;
+      entry->endpointId = endpointId;
+      entry->clusterId = clusterId;
+    }
+    if (entry != nullptr) {
+      entry->count++;
+    } else {
+      ESP_LOGW(__FILENAME__, "Subscription table full, reporting every path");
+      overflow++;
+    }
+  }
+
+  // Flush from the wheel rather than from the stack callback that announced the subscription
+  TimerWheel::device().schedule(flushTimer, 1, flushDeferred, this);
+}
+
+void SubscriptionTracker::unsubscribed(uint16_t endpointId, uint32_t clusterId) {
+  std::lock_guard<std::mutex> guard(interestMutex);
+  for (Interest &interest : interests) {
+    if (interest.count > 0 && interest.endpointId == endpointId && interest.clusterId == clusterId) {
+      interest.count--;
+      return;
+    }
+  }
+  if (overflow > 0) {
+    overflow--;
+  }
+}
+
+bool SubscriptionTracker::hasInterest(uint16_t endpointId, uint32_t clusterId) {
+  std::lock_guard<std::mutex> guard(interestMutex);
+  if (!attached || overflow > 0) {
+    return true;
+  }
+  for (const Interest &interest : interests) {
+    if (interest.count > 0 && (interest.endpointId == endpointId || interest.endpointId == kAnyEndpoint) &&
+        (interest.clusterId == clusterId || interest.clusterId == kAnyCluster)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void SubscriptionTracker::countDeferred() { deferred.fetch_add(1, std::memory_order_relaxed); }
+
+uint32_t SubscriptionTracker::deferredReports() const { return deferred.load(std::memory_order_relaxed); }
+
+void SubscriptionTracker::flushDeferred(void *context) {
+  SubscriptionTracker *tracker = static_cast<SubscriptionTracker *>(context);
+  struct Batch {
+    BaseDevice *devices[kFlushBatch];
+    size_t count;
+    bool truncated;
+  } batch = {};
+
+  // Devices are destroyed under the stack lock, so holding it keeps the batch alive after the
+  // registry lock is released. Taking it first matches the order of the stack context.
+  esp_matter::lock::status_t lockStatus = esp_matter::lock::chip_stack_lock(portMAX_DELAY);
+  DeviceRegistry::forEach(
+      [](BaseDevice *device, void *context) {
+        Batch *batch = static_cast<Batch *>(context);
+        if (!device->isReportDeferred()) {
+          return;
+        }
+        if (batch->count < kFlushBatch) {
+          batch->devices[batch->count++] = device;
+        } else {
+          batch->truncated = true;
+        }
+      },
+      &batch);
+  for (size_t i = 0; i < batch.count; i++) {
+    batch.devices[i]->flushDeferredReports();
+  }
+  if (lockStatus == esp_matter::lock::SUCCESS) {
+    esp_matter::lock::chip_stack_unlock();
+  }
+
+  if (batch.truncated) {
+    TimerWheel::device().schedule(tracker->flushTimer, 1, flushDeferred, tracker);
+  }
+}
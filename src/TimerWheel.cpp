@@ -0,0 +1,174 @@
+#include "TimerWheel.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+TimerWheel::Timer::Timer()
+    : next(nullptr), prev(nullptr), expiry(0), period(0), callback(nullptr), context(nullptr) {}
+
+bool TimerWheel::Timer::isPending() const { return next != nullptr; }
+
+TimerWheel::TimerWheel() : currentTick(0), count(0), running(nullptr), runningThread() {
+  for (unsigned level = 0; level < kLevels; level++) {
+    for (uint32_t slot = 0; slot < kSlots; slot++) {
+      slots[level][slot].next = &slots[level][slot];
+      slots[level][slot].prev = &slots[level][slot];
+    }
+  }
+}
+
+TimerWheel &TimerWheel::device() {
+  static TimerWheel wheel;
+  return wheel;
+}
+
+uint32_t TimerWheel::msToTicks(uint32_t ms) { return (ms + kTickMs - 1) / kTickMs; }
+
+void TimerWheel::schedule(Timer &timer, uint32_t delayTicks, Callback callback, void *context,
+                          uint32_t periodTicks) {
+  std::lock_guard<std::mutex> guard(wheelMutex);
+  if (timer.isPending()) {
+    unlink(timer);
+    count--;
+  }
+  // A delay of N ticks expires on the N-th advance from now
+  timer.expiry = currentTick + (delayTicks == 0 ? 0 : delayTicks - 1);
+  timer.period = periodTicks;
+  timer.callback = callback;
+  timer.context = context;
+  insert(timer);
+  count++;
+}
+
+void TimerWheel::cancel(Timer &timer) {
+  std::lock_guard<std::mutex> guard(wheelMutex);
+  if (timer.isPending()) {
+    unlink(timer);
+    count--;
+  }
+}
+
+void TimerWheel::cancelAndWait(Timer &timer) {
+  std::unique_lock<std::mutex> lock(wheelMutex);
+  while (true) {
+    if (timer.isPending()) {
+      unlink(timer);
+      count--;
+    }
+    if (running != &timer || runningThread == std::this_thread::get_id()) {
+      return;
+    }
+    // The running callback may schedule the timer again, cancel once more after it returned
+    callbackDone.wait(lock);
+  }
+}
+
+void TimerWheel::advance(uint32_t ticks) {
+  std::unique_lock<std::mutex> lock(wheelMutex);
+  for (uint32_t i = 0; i < ticks; i++) {
+    uint32_t index = static_cast<uint32_t>(currentTick) & (kSlots - 1);
+
+    // Pull the next block of every upper level down once the level below wrapped
+    if (index == 0) {
+      for (unsigned level = 1; level < kLevels; level++) {
+        cascade(level);
+        if (((currentTick >> (level * kLevelBits)) & (kSlots - 1)) != 0) {
+          break;
+        }
+      }
+    }
+    uint64_t firedTick = currentTick++;
+
+    // Detach the expired slot so callbacks can safely touch the wheel
+    Timer expired;
+    Timer &head = slots[0][index];
+    if (head.next == &head) {
+      continue;
+    }
+    expired.next = head.next;
+    expired.prev = head.prev;
+    expired.next->prev = &expired;
+    expired.prev->next = &expired;
+    head.next = &head;
+    head.prev = &head;
+
+    while (expired.next != &expired) {
+      Timer &timer = *expired.next;
+      unlink(timer);
+      count--;
+      Callback callback = timer.callback;
+      void *context = timer.context;
+      if (timer.period != 0) {
+        timer.expiry = firedTick + timer.period;
+        insert(timer);
+        count++;
+      }
+
+      running = &timer;
+      runningThread = std::this_thread::get_id();
+      lock.unlock();
+      callback(context);
+      lock.lock();
+      // The timer may be gone by now, it is only compared, never touched
+      running = nullptr;
+      callbackDone.notify_all();
+    }
+  }
+}
+
+uint64_t TimerWheel::now() {
+  std::lock_guard<std::mutex> guard(wheelMutex);
+  return currentTick;
+}
+
+size_t TimerWheel::pending() {
+  std::lock_guard<std::mutex> guard(wheelMutex);
+  return count;
+}
+
+void TimerWheel::link(Timer &head, Timer &timer) {
+  timer.prev = head.prev;
+  timer.next = &head;
+  head.prev->next = &timer;
+  head.prev = &timer;
+}
+
+void TimerWheel::unlink(Timer &timer) {
+  timer.prev->next = timer.next;
+  timer.next->prev = timer.prev;
+  timer.next = nullptr;
+  timer.prev = nullptr;
+}
+
+void TimerWheel::insert(Timer &timer) {
+  constexpr uint64_t kRange = 1ull << (kLevelBits * kLevels);
+  uint64_t expiry = timer.expiry;
+  if (expiry < currentTick) {
+    link(slots[0][currentTick & (kSlots - 1)], timer);
+    return;
+  }
+
+  uint64_t delta = expiry - currentTick;
+  if (delta >= kRange) {
+    // Park beyond-range timers in the last level, they are cascaded again when reached
+    expiry = currentTick + kRange - 1;
+    delta = kRange - 1;
+  }
+  unsigned level = 0;
+  while (level < kLevels - 1 && delta >= (1ull << (kLevelBits * (level + 1)))) {
+    level++;
+  }
+  link(slots[level][(expiry >> (kLevelBits * level)) & (kSlots - 1)], timer);
+}
+
+void TimerWheel::cascade(unsigned level) {
+  Timer &head = slots[level][(currentTick >> (level * kLevelBits)) & (kSlots - 1)];
+  while (head.next != &head) {
+    Timer &timer = *head.next;
+    unlink(timer);
+    insert(timer);
+  }
+}
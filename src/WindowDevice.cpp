@@ -5,16 +5,86 @@
 #include <esp_matter.h>
 #include <esp_matter_endpoint.h>
 
+#include <AccessoryCompletion.hpp>
+#include <DeviceConfig.hpp>
+#include <DeviceExecutor.hpp>
+#include <DeviceName.hpp>
+#include <DeviceTask.hpp>
+#include <SeqLock.hpp>
+#include <StateStream.hpp>
+#include <TimerWheel.hpp>
+#include <WindowProfileStorageInterface.hpp>
+#include <atomic>
 #include <cstdint>
+#include <cstdio>
+#include <utility>
 
-WindowDevice::WindowDevice(const char *device_name, BlindAccessoryInterface *blindAccessory,
-                           esp_matter::endpoint_t *aggregator)
-    : BaseDevice() {
+namespace {
+
+// Uncalibrated blinds are commanded without compensation
+constexpr WindowTravelProfile kDefaultProfile = {WindowDevice::kDefaultTravelMs, WindowDevice::kDefaultTravelMs, 0};
+
+uint32_t wheelNowMs() { return static_cast<uint32_t>(TimerWheel::device().now() * TimerWheel::kTickMs); }
+
+constexpr size_t kProfileKeySize = 16;
+
+// NVS keys hold 15 characters, so a named window is keyed by a hash of its full name and an
+// unnamed one by its endpoint
+void profileKey(const char *name, uint16_t endpointId, char (&key)[kProfileKeySize]) {
+  if (name[0] == '\0') {
+    snprintf(key, sizeof(key), "window_ep%u", static_cast<unsigned>(endpointId));
+    return;
+  }
+  uint32_t hash = 2166136261u;  // FNV-1a
+  for (const char *c = name; *c != '\0'; c++) {
+    hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+  }
+  snprintf(key, sizeof(key), "window_%08x", static_cast<unsigned>(hash));
+}
+
+// Distance between two positions in percent
+uint32_t travelled(uint16_t from, uint16_t to) { return from > to ? from - to : to - from; }
+
+// The state of the last move lives in one atomic word so that no report ever sees the target of
+// one move with the write state of another: the commanded position in the low bits, the Matter
+// target above it and two flags, whether the write is still open and whether the blind was
+// taken as arrived without a move. Positions are percent, 15 bits hold them.
+constexpr uint32_t kPositionBits = 15;
+constexpr uint32_t kPositionMask = (1u << kPositionBits) - 1;
+constexpr uint32_t kWriteOpen = 1u << 30;
+constexpr uint32_t kSettled = 1u << 31;
+
+uint32_t packMove(uint16_t requested, uint16_t commanded, uint32_t flags) {
+  return ((requested & kPositionMask) << kPositionBits) | (commanded & kPositionMask) | flags;
+}
+
+uint16_t commandedOf(uint32_t move) { return static_cast<uint16_t>(move & kPositionMask); }
+
+uint16_t requestedOf(uint32_t move) { return static_cast<uint16_t>((move >> kPositionBits) & kPositionMask); }
+
+// Clear flags of the move last seen, unless another move was commanded meanwhile
+void clearMoveFlags(std::atomic<uint32_t> &state, uint32_t seen, uint32_t flags) {
+  state.compare_exchange_strong(seen, seen & ~flags);
+}
+
+}  // namespace
+
+WindowDevice::WindowDevice(DeviceName device_name, BlindAccessoryInterface *blindAccessory,
+                           esp_matter::endpoint_t *aggregator, WindowProfileStorageInterface *profileStorage)
+    : BaseDevice(),
+      name(std::move(device_name)),
+      shadow(State{0, 0}),
+      profileStorage(profileStorage),
+      profile(kDefaultProfile),
+      commandedMove(0),
+      calibrating(false),
+      calibrationTask(DeviceExecutor::kNoTask),
+      moved() {
   BlindAccessory = blindAccessory;
 
   // Set up the callback for reporting attributes
   BlindAccessory->setReportAppCallback(
-      [](void *self) { static_cast<WindowDevice *>(self)->reportEndpoint(); }, this);
+      [](void *self) { static_cast<WindowDevice *>(self)->onAccessoryReport(); }, this);
 
   // Check if an aggregator is provided
   if (aggregator != nullptr) {
@@ -24,15 +94,12 @@ WindowDevice::WindowDevice(const char *device_name, BlindAccessoryInterface *bli
     endpoint = esp_matter::endpoint::bridged_node::create(esp_matter::node::get(), &bridged_node_config,
                                                           flags, this);
 
-    if (device_name != nullptr && strlen(device_name) > 0 &&
-        strlen(device_name) < 64)  // TODO: change to a define
-    {
-      strncpy(this->name, device_name, sizeof(this->name));
-      ESP_LOGI(__FILENAME__, "Creating Bridged Node WindowDevice with name: %s", name);
+    if (name.length() > 0) {
+      ESP_LOGI(__FILENAME__, "Creating Bridged Node WindowDevice with name: %s", name.get());
       esp_matter::cluster_t *bridge_device_basic_information_cluster =
           esp_matter::cluster::get(endpoint, chip::app::Clusters::BridgedDeviceBasicInformation::Id);
       esp_matter::cluster::bridged_device_basic_information::attribute::create_node_label(
-          bridge_device_basic_information_cluster, name, strlen(name));
+          bridge_device_basic_information_cluster, name.get(), name.length());
     } else {
       ESP_LOGW(__FILENAME__, "device_name is not set");
       ESP_LOGI(__FILENAME__, "Creating Bridged Node WindowDevice with default name");
@@ -52,37 +119,75 @@ WindowDevice::WindowDevice(const char *device_name, BlindAccessoryInterface *bli
 
   esp_matter::cluster::window_covering::feature::lift::config_t lift_config;
   esp_matter::cluster::window_covering::feature::position_aware_lift::config_t position_aware_lift_config;
-  esp_matter::cluster::window_covering::feature::absolute_position::config_t absolute_position_config;
 
   position_aware_lift_config.current_position_lift_percentage =
-      nullable<uint8_t>(0);  // TODO: change to last known position
+      nullable<uint8_t>(DeviceConfig::kWindow.initialLiftPercent);  // TODO: change to last known position
   position_aware_lift_config.current_position_lift_percent_100ths =
-      nullable<uint16_t>(0);  // TODO: change to last known position
+      nullable<uint16_t>(DeviceConfig::kWindow.initialLiftPercent100ths);
   position_aware_lift_config.target_position_lift_percent_100ths =
-      nullable<uint16_t>(0);  // TODO: change to last known position
+      nullable<uint16_t>(DeviceConfig::kWindow.initialLiftPercent100ths);
 
   esp_matter::cluster::window_covering::feature::lift::add(window_covering_cluster, &lift_config);
   esp_matter::cluster::window_covering::feature::position_aware_lift::add(window_covering_cluster,
                                                                           &position_aware_lift_config);
-  esp_matter::cluster::window_covering::feature::absolute_position::add(window_covering_cluster,
-                                                                        &absolute_position_config);
+  if constexpr (DeviceConfig::kWindow.absolutePosition) {
+    esp_matter::cluster::window_covering::feature::absolute_position::config_t absolute_position_config;
+    esp_matter::cluster::window_covering::feature::absolute_position::add(window_covering_cluster,
+                                                                          &absolute_position_config);
+  }
+
+  // The key needs the name and the endpoint
+  if (profileStorage != nullptr) {
+    char key[kProfileKeySize];
+    profileKey(name.get(), esp_matter::endpoint::get_id(endpoint), key);
+    WindowTravelProfile storedProfile;
+    esp_err_t err = profileStorage->load(key, storedProfile);
+    if (err == ESP_OK) {
+      profile.write(storedProfile);
+    } else if (err != ESP_ERR_NOT_FOUND) {
+      ESP_LOGW(__FILENAME__, "Cannot load WindowDevice travel profile: %s", esp_err_to_name(err));
+    }
+  }
 
   // syncAccessoryState();
+
+  registerDevice();
+}
+
+WindowDevice::~WindowDevice() {
+  unregisterDevice();
+  DeviceExecutor::device().cancel(calibrationTask);
 }
 
 esp_err_t WindowDevice::updateAccessory() {
-  ESP_LOGI(__FILENAME__, "Updating WindowDevice Accessory with target position: %d",
-           getEndpointTargetPosition());
-  setAccessoryTargetPosition(getEndpointTargetPosition());
+  if (!isReachable()) {
+    ESP_LOGW(__FILENAME__, "Rejecting update, accessory unreachable");
+    return ESP_ERR_INVALID_STATE;
+  }
+  esp_err_t err = loadShadow();
+  if (err != ESP_OK) {
+    ESP_LOGE(__FILENAME__, "Cannot read WindowDevice endpoint state: %s", esp_err_to_name(err));
+    return err;
+  }
+  uint16_t targetPosition = getEndpointTargetPosition();
+  if (calibrating.load()) {
+    ESP_LOGI(__FILENAME__, "Deferring WindowDevice target position %d until calibrated", targetPosition);
+    return ESP_OK;
+  }
+  ESP_LOGI(__FILENAME__, "Updating WindowDevice Accessory with target position: %d", targetPosition);
+  setAccessoryTargetPosition(targetPosition);
   return ESP_OK;
 }
 
 esp_err_t WindowDevice::reportEndpoint() {
   ESP_LOGI(__FILENAME__, "Reporting WindowDevice Endpoint with target position: %d",
            getAccessoryTargetPosition());
-  setEndpointCurrentPosition(getAccessoryCurrentPosition());
-  setEndpointTargetPosition(getAccessoryTargetPosition());
-  return ESP_OK;
+  uint16_t currentPosition = getAccessoryCurrentPosition();
+  uint16_t targetPosition = toEndpointTarget(getAccessoryTargetPosition());
+  esp_err_t err = setEndpointCurrentPosition(currentPosition);
+  esp_err_t target_err = setEndpointTargetPosition(targetPosition);
+  cachePositions(currentPosition, targetPosition);
+  return err != ESP_OK ? err : target_err;
 }
 
 esp_err_t WindowDevice::identify() {
@@ -95,29 +200,287 @@ uint16_t WindowDevice::getAccessoryCurrentPosition() { return BlindAccessory->ge
 
 uint16_t WindowDevice::getAccessoryTargetPosition() { return BlindAccessory->getTargetPosition(); }
 
-void WindowDevice::setAccessoryTargetPosition(uint16_t position) { BlindAccessory->moveBlindTo(position); }
+void WindowDevice::setAccessoryTargetPosition(uint16_t position) {
+  uint16_t currentPosition = getAccessoryCurrentPosition();
+  uint16_t commanded = getCompensatedPosition(position);
+  if (commanded != currentPosition || position == currentPosition) {
+    commandAccessory(position, commanded);
+    return;
+  }
+
+  // Any move would coast further past the target than the blind is from it, so it stays where
+  // it is. The stack keeps the requested target and learns the position the blind really has.
+  commandedMove.store(packMove(position, currentPosition, kSettled));
+  setEndpointCurrentPosition(currentPosition);
+  cachePositions(currentPosition, position);
+}
+
+void WindowDevice::commandAccessory(uint16_t requested, uint16_t commanded) {
+  commandedMove.store(packMove(requested, commanded, kWriteOpen));
+  BlindAccessory->moveBlindTo(commanded);
+}
+
+uint16_t WindowDevice::getCompensatedPosition(uint16_t position) {
+  uint16_t currentPosition = getAccessoryCurrentPosition();
+  if (position == 0 || position >= 100 || position == currentPosition) {
+    return position;
+  }
+
+  WindowTravelProfile travel = profile.read();
+  bool closing = position > currentPosition;
+  uint32_t travelMs = closing ? travel.closeMs : travel.openMs;
+  if (travelMs == 0) {
+    return position;
+  }
+  uint32_t overrun = (travel.stopLatencyMs * 100 + travelMs / 2) / travelMs;
+  uint32_t distance = closing ? position - currentPosition : currentPosition - position;
+  if (overrun == 0) {
+    return position;
+  }
+  if (overrun >= distance) {
+    // Any move coasts past the target, only move if that still lands closer
+    return distance * 2 > overrun ? position : currentPosition;
+  }
+  return static_cast<uint16_t>(closing ? position - overrun : position + overrun);
+}
+
+uint16_t WindowDevice::toEndpointTarget(uint16_t accessoryTarget) const {
+  uint32_t move = commandedMove.load();
+  if (accessoryTarget == commandedOf(move)) {
+    return requestedOf(move);
+  }
+  return accessoryTarget;
+}
+
+void WindowDevice::onAccessoryReport() {
+  uint16_t currentPosition = getAccessoryCurrentPosition();
+  if (calibrating.load()) {
+    // Calibration moves are not Matter targets, only the travel of the blind is reported
+    reportTravel(currentPosition);
+    moved.signal();
+    return;
+  }
+
+  // A blind taken as arrived stays there until it moves by itself
+  uint32_t move = commandedMove.load();
+  uint16_t commanded = commandedOf(move);
+  if (move & kSettled) {
+    if (currentPosition == commanded) {
+      return;
+    }
+    clearMoveFlags(commandedMove, move, kSettled);
+    reportEndpoint();
+    return;
+  }
+
+  // Every report while the blind keeps the commanded position as its target echoes the write:
+  // the progress reports, the stop at the target and any status report after it. The write
+  // only ends when something else gives the blind another target.
+  uint16_t targetPosition = getAccessoryTargetPosition();
+  if (!(move & kWriteOpen) || targetPosition != commanded) {
+    clearMoveFlags(commandedMove, move, kWriteOpen);
+    reportEndpoint();
+    return;
+  }
+
+  // The stack already holds the written target, only the travel of the blind is news
+  reportTravel(currentPosition);
+}
+
+void WindowDevice::reportTravel(uint16_t currentPosition) {
+  if (currentPosition != shadow.read().currentPosition) {
+    setEndpointCurrentPosition(currentPosition);
+    cachePositions(currentPosition, getEndpointTargetPosition());
+  }
+}
+
+esp_err_t WindowDevice::calibrate() {
+  bool expected = false;
+  if (!calibrating.compare_exchange_strong(expected, true)) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  ESP_LOGI(__FILENAME__, "Calibrating WindowDevice");
+  moved.reset();
+  esp_err_t err = DeviceExecutor::device().spawn(runCalibration(), &calibrationTask);
+  if (err != ESP_OK) {
+    calibrating.store(false);
+  }
+  return err;
+}
+
+bool WindowDevice::isCalibrating() const { return calibrating.load(); }
+
+WindowTravelProfile WindowDevice::getTravelProfile() const { return profile.read(); }
+
+DeviceTask WindowDevice::runCalibration() {
+  WindowTravelProfile measuredProfile = profile.read();
+  bool measured = false;
+  co_await measureProfile(&measuredProfile, &measured);
+
+  if (measured) {
+    ESP_LOGI(__FILENAME__, "WindowDevice travel: open %u ms, close %u ms, stop %u ms",
+             static_cast<unsigned>(measuredProfile.openMs), static_cast<unsigned>(measuredProfile.closeMs),
+             static_cast<unsigned>(measuredProfile.stopLatencyMs));
+    profile.write(measuredProfile);
+    if (profileStorage != nullptr) {
+      char key[kProfileKeySize];
+      profileKey(name.get(), esp_matter::endpoint::get_id(endpoint), key);
+      esp_err_t err = profileStorage->save(key, measuredProfile);
+      if (err != ESP_OK) {
+        ESP_LOGW(__FILENAME__, "Cannot save WindowDevice travel profile: %s", esp_err_to_name(err));
+      }
+    }
+  } else {
+    ESP_LOGE(__FILENAME__, "WindowDevice calibration stalled, keeping the previous travel profile");
+  }
+
+  // Return to the Matter target, which may have been written meanwhile
+  calibrating.store(false);
+  setAccessoryTargetPosition(getEndpointTargetPosition());
+}
+
+DeviceTask WindowDevice::measureProfile(WindowTravelProfile *measuredProfile, bool *measured) {
+  // A move whose frame cannot be allocated leaves the leg as not arrived
+  CalibrationLeg leg{};
+
+  // Start from a known end
+  if (!co_await calibrationMove(0, 0, &leg) || !leg.arrived) {
+    co_return;
+  }
+
+  // The reports from the first motion to the arrival time the travel between them
+  if (!co_await calibrationMove(100, 100, &leg) || !leg.arrived || leg.stoppedAt == leg.motionAt) {
+    co_return;
+  }
+  uint32_t closeMs = (leg.arrivalMs - leg.motionMs) * 100 / travelled(leg.motionAt, leg.stoppedAt);
+
+  if (!co_await calibrationMove(0, 0, &leg) || !leg.arrived || leg.stoppedAt == leg.motionAt) {
+    co_return;
+  }
+  uint32_t openMs = (leg.arrivalMs - leg.motionMs) * 100 / travelled(leg.motionAt, leg.stoppedAt);
+
+  // Stop halfway through a close, the distance it coasts gives the stop latency
+  if (!co_await calibrationMove(100, kCalibrationStopPosition, &leg) || !leg.arrived) {
+    co_return;
+  }
+  uint16_t finalPosition = getAccessoryCurrentPosition();
+  uint32_t overrun = finalPosition > leg.stoppedAt ? finalPosition - leg.stoppedAt : 0;
+
+  measuredProfile->openMs = openMs;
+  measuredProfile->closeMs = closeMs;
+  measuredProfile->stopLatencyMs = overrun * closeMs / 100;
+  *measured = true;
+}
 
-uint16_t WindowDevice::getEndpointTargetPosition() {
+DeviceTask WindowDevice::calibrationMove(uint16_t position, uint16_t stopAt, CalibrationLeg *leg) {
+  uint16_t currentPosition = getAccessoryCurrentPosition();
+  bool closing = position > currentPosition;
+  bool moving = false;
+  leg->arrived = false;
+  leg->from = currentPosition;
+  leg->motionAt = currentPosition;
+  leg->stoppedAt = stopAt;
+  leg->motionMs = wheelNowMs();
+  leg->arrivalMs = leg->motionMs;
+
+  moved.reset();
+  commandAccessory(position, position);
+  while (true) {
+    currentPosition = getAccessoryCurrentPosition();
+    if (!moving && currentPosition != leg->from) {
+      moving = true;
+      leg->motionAt = currentPosition;
+      leg->motionMs = wheelNowMs();
+    }
+    if (closing ? currentPosition >= stopAt : currentPosition <= stopAt) {
+      leg->arrivalMs = wheelNowMs();
+      leg->stoppedAt = currentPosition;
+      leg->arrived = true;
+      break;
+    }
+    if (!co_await moved.wait(kCalibrationStallMs)) {
+      co_return;
+    }
+  }
+
+  if (leg->stoppedAt != position) {
+    commandAccessory(leg->stoppedAt, leg->stoppedAt);
+  }
+  // Wait for the blind to stop coasting
+  while (co_await moved.wait(kCalibrationSettleMs)) {
+  }
+}
+
+uint16_t WindowDevice::getEndpointTargetPosition() { return shadow.read().targetPosition; }
+
+esp_err_t WindowDevice::loadShadow() {
   esp_matter::cluster_t *window_covering_cluster =
       esp_matter::cluster::get(endpoint, chip::app::Clusters::WindowCovering::Id);
   esp_matter::attribute_t *target_position_attribute = esp_matter::attribute::get(
       window_covering_cluster,
       chip::app::Clusters::WindowCovering::Attributes::TargetPositionLiftPercent100ths::Id);
+  if (target_position_attribute == nullptr) {
+    return ESP_ERR_NOT_FOUND;
+  }
   esp_matter_attr_val_t attr_val;
-  esp_matter::attribute::get_val(target_position_attribute, &attr_val);
-  return (attr_val.val.u16) / 100;
+  esp_err_t err = esp_matter::attribute::get_val(target_position_attribute, &attr_val);
+  if (err != ESP_OK) {
+    return err;
+  }
+  cacheTargetPosition((attr_val.val.u16) / 100);
+  return ESP_OK;
 }
 
-void WindowDevice::setEndpointTargetPosition(uint16_t position) {
+esp_err_t WindowDevice::setEndpointTargetPosition(uint16_t position) {
   esp_matter_attr_val_t attr_val = esp_matter_nullable_uint16(position * 100);
-  esp_matter::attribute::report(
-      esp_matter::endpoint::get_id(endpoint), chip::app::Clusters::WindowCovering::Id,
-      chip::app::Clusters::WindowCovering::Attributes::TargetPositionLiftPercent100ths::Id, &attr_val);
+  return reportAttribute(esp_matter::endpoint::get_id(endpoint), chip::app::Clusters::WindowCovering::Id,
+                         chip::app::Clusters::WindowCovering::Attributes::TargetPositionLiftPercent100ths::Id,
+                         &attr_val);
 }
 
-void WindowDevice::setEndpointCurrentPosition(uint16_t position) {
+esp_err_t WindowDevice::setEndpointCurrentPosition(uint16_t position) {
   esp_matter_attr_val_t attr_val = esp_matter_nullable_uint16(position * 100);
-  esp_matter::attribute::report(
-      esp_matter::endpoint::get_id(endpoint), chip::app::Clusters::WindowCovering::Id,
-      chip::app::Clusters::WindowCovering::Attributes::CurrentPositionLiftPercent100ths::Id, &attr_val);
+  return reportAttribute(esp_matter::endpoint::get_id(endpoint), chip::app::Clusters::WindowCovering::Id,
+                         chip::app::Clusters::WindowCovering::Attributes::CurrentPositionLiftPercent100ths::Id,
+                         &attr_val);
+}
+
+void WindowDevice::fillSnapshot(DeviceSnapshot &snapshot, size_t index) const {
+  State state = shadow.read();
+  if (snapshot.endpointIds != nullptr) snapshot.endpointIds[index] = esp_matter::endpoint::get_id(endpoint);
+  if (snapshot.types != nullptr) snapshot.types[index] = DeviceType::Window;
+  if (snapshot.windowCurrentPosition != nullptr) snapshot.windowCurrentPosition[index] = state.currentPosition;
+  if (snapshot.windowTargetPosition != nullptr) snapshot.windowTargetPosition[index] = state.targetPosition;
+}
+
+size_t WindowDevice::getEndpointIds(uint16_t *endpointIds, size_t capacity) const {
+  if (capacity == 0) {
+    return 0;
+  }
+  endpointIds[0] = esp_matter::endpoint::get_id(endpoint);
+  return 1;
+}
+
+WindowDevice::State WindowDevice::getState() const { return shadow.read(); }
+
+void WindowDevice::cachePositions(uint16_t currentPosition, uint16_t targetPosition) {
+  State previous = shadow.modify([currentPosition, targetPosition](State &state) {
+    state.currentPosition = currentPosition;
+    state.targetPosition = targetPosition;
+  });
+  uint16_t endpoint_id = esp_matter::endpoint::get_id(endpoint);
+  if (previous.currentPosition != currentPosition) {
+    StateStreamEncoder::emit(endpoint_id, StateChangeKind::WindowCurrentPosition, currentPosition);
+  }
+  if (previous.targetPosition != targetPosition) {
+    StateStreamEncoder::emit(endpoint_id, StateChangeKind::WindowTargetPosition, targetPosition);
+  }
+}
+
+void WindowDevice::cacheTargetPosition(uint16_t position) {
+  State previous = shadow.modify([position](State &state) { state.targetPosition = position; });
+  if (previous.targetPosition != position) {
+    StateStreamEncoder::emit(esp_matter::endpoint::get_id(endpoint), StateChangeKind::WindowTargetPosition,
+                             position);
+  }
 }
@@ -0,0 +1,183 @@
+// DeviceExecutor task lifetime on a HostTickSource.
+//
+// Owners cancel their tasks in their destructors, so a cancelled task must be gone when cancel()
+// returns: a suspended task is destroyed right away, a task resumed on another thread is waited
+// for, and a task cancelling itself is destroyed once it suspends. Awaiting a task whose frame
+// cannot be allocated must report the failure instead of running nothing silently.
+
+#include <DeviceExecutor.hpp>
+#include <DeviceTask.hpp>
+#include <HostTickSource.hpp>
+#include <TimerWheel.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kLongDelayMs = 1000;
+
+bool expect(bool condition, const char *what) {
+  if (!condition) printf("FAILED: %s\n", what);
+  return condition;
+}
+
+// Coroutine local recording its destruction
+struct Guard {
+  std::atomic<bool> *destroyed;
+  ~Guard() { destroyed->store(true); }
+};
+
+DeviceTask sleeper(std::atomic<bool> *destroyed, std::atomic<bool> *resumed) {
+  Guard guard{destroyed};
+  co_await DeviceExecutor::delay(kLongDelayMs);
+  resumed->store(true);
+}
+
+DeviceTask selfCancelling(DeviceExecutor *executor, const uint32_t *taskId, std::atomic<bool> *destroyed,
+                          std::atomic<bool> *resumed) {
+  Guard guard{destroyed};
+  executor->cancel(*taskId);
+  co_await DeviceExecutor::delay(kLongDelayMs);
+  resumed->store(true);
+}
+
+DeviceTask busy(std::atomic<bool> *entered, std::atomic<bool> *release, std::atomic<bool> *destroyed) {
+  Guard guard{destroyed};
+  entered->store(true);
+  while (!release->load()) {
+    std::this_thread::yield();
+  }
+  co_await DeviceExecutor::delay(kLongDelayMs);
+}
+
+DeviceTask child() { co_return; }
+
+DeviceTask parent(bool *started) { *started = co_await child(); }
+
+bool testCancelSuspended() {
+  TimerWheel wheel;
+  HostTickSource ticks(wheel);
+  ticks.start();
+  DeviceExecutor executor(wheel);
+  std::atomic<bool> destroyed(false);
+  std::atomic<bool> resumed(false);
+  size_t frames = DeviceTask::framesInUse();
+  bool ok = true;
+
+  uint32_t taskId = DeviceExecutor::kNoTask;
+  ok = expect(executor.spawn(sleeper(&destroyed, &resumed), &taskId) == ESP_OK, "sleeper spawned") && ok;
+  ticks.advanceTicks(1);
+  ok = expect(executor.isActive(taskId) && !destroyed.load(), "sleeper suspended in its delay") && ok;
+
+  // No tick between the cancel and the checks, the frame must already be gone
+  executor.cancel(taskId);
+  ok = expect(destroyed.load(), "suspended task destroyed by cancel") && ok;
+  ok = expect(!executor.isActive(taskId) && executor.activeTasks() == 0, "cancelled task released") && ok;
+  ok = expect(DeviceTask::framesInUse() == frames, "cancelled frame returned to the pool") && ok;
+  ok = expect(wheel.pending() == 0, "delay timer cancelled with the frame") && ok;
+
+  ticks.advanceMs(kLongDelayMs * 2);
+  ok = expect(!resumed.load(), "cancelled task never resumed") && ok;
+  ticks.stop();
+  return ok;
+}
+
+bool testCancelSelf() {
+  TimerWheel wheel;
+  HostTickSource ticks(wheel);
+  ticks.start();
+  DeviceExecutor executor(wheel);
+  std::atomic<bool> destroyed(false);
+  std::atomic<bool> resumed(false);
+  bool ok = true;
+
+  uint32_t taskId = DeviceExecutor::kNoTask;
+  executor.spawn(selfCancelling(&executor, &taskId, &destroyed, &resumed), &taskId);
+  ticks.advanceTicks(1);
+  ok = expect(destroyed.load(), "self cancelled task destroyed once it suspended") && ok;
+  ok = expect(!executor.isActive(taskId), "self cancelled task released") && ok;
+
+  ticks.advanceMs(kLongDelayMs * 2);
+  ok = expect(!resumed.load(), "self cancelled task never resumed") && ok;
+  ticks.stop();
+  return ok;
+}
+
+bool testCancelRunning() {
+  TimerWheel wheel;
+  HostTickSource ticks(wheel);
+  ticks.start();
+  DeviceExecutor executor(wheel);
+  std::atomic<bool> entered(false);
+  std::atomic<bool> release(false);
+  std::atomic<bool> destroyed(false);
+  std::atomic<bool> cancelled(false);
+  std::atomic<bool> destroyedOnReturn(false);
+  bool ok = true;
+
+  uint32_t taskId = DeviceExecutor::kNoTask;
+  executor.spawn(busy(&entered, &release, &destroyed), &taskId);
+
+  // The wheel runs the task on its own thread while another thread cancels it
+  std::thread wheelThread([&ticks]() { ticks.advanceTicks(1); });
+  while (!entered.load()) {
+    std::this_thread::yield();
+  }
+  std::thread cancelThread([&]() {
+    executor.cancel(taskId);
+    destroyedOnReturn.store(destroyed.load());
+    cancelled.store(true);
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  ok = expect(!cancelled.load(), "cancel waited for the running task") && ok;
+  release.store(true);
+  cancelThread.join();
+  wheelThread.join();
+  ok = expect(destroyedOnReturn.load(), "running task destroyed before cancel returned") && ok;
+  ok = expect(!executor.isActive(taskId), "running task released") && ok;
+  ticks.stop();
+  return ok;
+}
+
+bool testChildAllocationFailure() {
+  TimerWheel wheel;
+  HostTickSource ticks(wheel);
+  ticks.start();
+  DeviceExecutor executor(wheel);
+  bool started = true;
+  bool ok = true;
+
+  executor.spawn(parent(&started));
+
+  // Hold every remaining frame so the child cannot be allocated
+  std::vector<DeviceTask> held;
+  while (DeviceTask::framesInUse() < DeviceTask::kMaxFrames) {
+    held.push_back(child());
+  }
+  ticks.advanceTicks(1);
+  ok = expect(!started, "awaiting an unallocated task reported the failure") && ok;
+  ok = expect(executor.activeTasks() == 0, "parent finished") && ok;
+  held.clear();
+
+  executor.spawn(parent(&started));
+  ticks.advanceTicks(1);
+  ok = expect(started, "awaiting an allocated task reported it ran") && ok;
+  ticks.stop();
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = testCancelSuspended();
+  ok = testCancelSelf() && ok;
+  ok = testCancelRunning() && ok;
+  ok = testChildAllocationFailure() && ok;
+  printf("%s\n", ok ? "device executor tests passed" : "device executor tests failed");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+// Regression gate on the allocations of the device constructors.
+//
+// Global operator new/delete count every allocation and are installed as the HeapAudit
+// sampler. Each row counts the device object, one allocation per esp_matter endpoint, cluster
+// and attribute it requests, and anything the device layer allocates itself. The fake
+// esp_matter sizes its objects nothing like the real one, so the gate guards the number of
+// allocations of the device layer only, not the heap esp_matter costs on the target; the
+// HeapAudit budgets are to be measured there, see HeapAudit::logWorst(). Each device is
+// built once to warm the shared singletons, then twice measured; both must match the table
+// exactly and stay within the HeapAudit budget. Devices built in code copy their name, one block
+// more than the borrowed name of a DeviceManifest entry. Sizes are those of the LP64 host build.
+// When a change moves a number on purpose, update the table with the printed values.
+
+#include <fake_accessories.hpp>
+#include <fake_esp_matter.hpp>
+#include <simulated_blind_accessory.hpp>
+#include <simulated_power_meter.hpp>
+
+#include <BaseDevice.hpp>
+#include <ButtonDevice.hpp>
+#include <DeviceName.hpp>
+#include <DeviceSnapshot.hpp>
+#include <DimmableLightDevice.hpp>
+#include <FanDevice.hpp>
+#include <HeapAudit.hpp>
+#include <LightDevice.hpp>
+#include <MultiChannelDevice.hpp>
+#include <PlugInDevice.hpp>
+#include <SensorDevice.hpp>
+#include <WindowDevice.hpp>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<uint32_t> allocatedBlocks(0);
+std::atomic<uint32_t> allocatedBytes(0);
+
+HeapAudit::Cost countingSampler() { return HeapAudit::Cost{allocatedBlocks.load(), allocatedBytes.load()}; }
+
+struct Row {
+  const char *name;     /**< Device and variant. */
+  DeviceType type;      /**< Budget checked by HeapAudit. */
+  HeapAudit::Cost cost; /**< Exact blocks and bytes of one constructor. */
+  BaseDevice *(*create)();
+};
+
+FakeLight light;
+FakePlugin plugIn;
+FakeFan fan;
+SimulatedBlindAccessory blind;
+FakeButton button;
+FakeDimmableLight dimmableLight;
+FakeRelayBoard relayBoard(4);
+FakeSensor sensor;
+SimulatedPowerMeter powerMeter;
+esp_matter::endpoint_t *aggregator;
+
+// Host allocation counts, not target heap cost
+const Row kRows[] = {
+    {"Light", DeviceType::Light, {11, 460},
+     []() -> BaseDevice * { return new LightDevice("light", &light, aggregator); }},
+    {"Light, borrowed name", DeviceType::Light, {10, 454},
+     []() -> BaseDevice * { return new LightDevice(BorrowedName{"light"}, &light, aggregator); }},
+    {"PlugIn", DeviceType::PlugIn, {11, 466},
+     []() -> BaseDevice * { return new PlugInDevice("plug", &plugIn, aggregator); }},
+    {"PlugIn, metered", DeviceType::PlugIn, {20, 1610},
+     []() -> BaseDevice * { return new PlugInDevice("plug", &plugIn, aggregator, &powerMeter); }},
+    {"Fan", DeviceType::Fan, {13, 544}, []() -> BaseDevice * { return new FanDevice("fan", &fan, aggregator); }},
+    {"Window", DeviceType::Window, {23, 1166},
+     []() -> BaseDevice * { return new WindowDevice("window", &blind, aggregator); }},
+    {"Button", DeviceType::Button, {13, 510},
+     []() -> BaseDevice * { return new ButtonDevice("button", &button, aggregator); }},
+    {"DimmableLight", DeviceType::DimmableLight, {15, 630},
+     []() -> BaseDevice * { return new DimmableLightDevice("dimmer", &dimmableLight, aggregator); }},
+    {"MultiChannel, 4 plugs", DeviceType::MultiChannel, {38, 1651},
+     []() -> BaseDevice * { return new MultiChannelDevice("relays", &relayBoard, aggregator); }},
+    {"TemperatureSensor", DeviceType::TemperatureSensor, {11, 824},
+     []() -> BaseDevice * {
+       return new SensorDevice("temperature", &sensor, aggregator, SensorDevice::SensorType::Temperature);
+     }},
+    {"HumiditySensor", DeviceType::HumiditySensor, {11, 818},
+     []() -> BaseDevice * {
+       return new SensorDevice("humidity", &sensor, aggregator, SensorDevice::SensorType::Humidity);
+     }},
+    {"OccupancySensor", DeviceType::OccupancySensor, {11, 820},
+     []() -> BaseDevice * {
+       return new SensorDevice("occupancy", &sensor, aggregator, SensorDevice::SensorType::Occupancy);
+     }},
+};
+
+}  // namespace
+
+void *operator new(size_t size) {
+  void *block = malloc(size == 0 ? 1 : size);
+  if (block == nullptr) throw std::bad_alloc();
+  allocatedBlocks.fetch_add(1, std::memory_order_relaxed);
+  allocatedBytes.fetch_add(static_cast<uint32_t>(size), std::memory_order_relaxed);
+  return block;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  try {
+    return operator new(size);
+  } catch (const std::bad_alloc &) {
+    return nullptr;
+  }
+}
+
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept { return operator new(size, tag); }
+
+void operator delete(void *block) noexcept { free(block); }
+
+void operator delete[](void *block) noexcept { free(block); }
+
+void operator delete(void *block, size_t) noexcept { free(block); }
+
+void operator delete[](void *block, size_t) noexcept { free(block); }
+
+int main() {
+  esp_matter::endpoint::bridged_node::config_t config;
+  aggregator = esp_matter::endpoint::bridged_node::create(esp_matter::node::get(), &config, 0, nullptr);
+  HeapAudit::setSampler(countingSampler);
+  HeapAudit::setEnabled(true);
+
+  bool ok = true;
+  for (const Row &row : kRows) {
+    delete row.create();
+    for (int run = 0; run < 2; run++) {
+      HeapAudit audit;
+      BaseDevice *device = row.create();
+      HeapAudit::Cost used = audit.cost();
+      bool exact = used.blocks == row.cost.blocks && used.bytes == row.cost.bytes;
+      bool withinBudget = audit.check(row.type) == ESP_OK;
+      delete device;
+      if (run == 0 || !exact || !withinBudget) {
+        printf("%-22s %4u blocks %6u bytes, expected %4u / %6u%s\n", row.name, static_cast<unsigned>(used.blocks),
+               static_cast<unsigned>(used.bytes), static_cast<unsigned>(row.cost.blocks),
+               static_cast<unsigned>(row.cost.bytes), withinBudget ? "" : ", over budget");
+      }
+      ok = ok && exact && withinBudget;
+    }
+  }
+
+  HeapAudit::setEnabled(false);
+  HeapAudit::setSampler(nullptr);
+
+  // DeviceConfig::kWindow keeps the installed limits of the absolute position feature
+  WindowDevice window("window", &blind, aggregator);
+  uint16_t endpointId = 0;
+  window.getEndpointIds(&endpointId, 1);
+  if (!fake_esp_matter::has(endpointId, chip::app::Clusters::WindowCovering::Id, 0x0010)) {
+    printf("Window has no InstalledOpenLimitLift\n");
+    ok = false;
+  }
+  return ok ? 0 : 1;
+}
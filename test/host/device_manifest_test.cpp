@@ -0,0 +1,260 @@
+// DeviceManifest validation and instantiation.
+//
+// The blob is built from device_manifest_test.json by tools/make_device_manifest.py at build
+// time and passed as the first argument. Validation must reject every header whose tables
+// leave the blob, an unterminated string table and an unknown version or magic, without
+// scanning the names. Instantiation creates the resolved devices only, with the names of the
+// string table borrowed in place, while names passed in code are still copied.
+
+#include <fake_accessories.hpp>
+#include <fake_esp_matter.hpp>
+
+#include <BaseDevice.hpp>
+#include <DeviceManifest.hpp>
+#include <DeviceName.hpp>
+#include <DeviceRegistry.hpp>
+#include <DeviceSnapshot.hpp>
+#include <LightDevice.hpp>
+#include <MultiChannelDevice.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+namespace Info = chip::app::Clusters::BridgedDeviceBasicInformation;
+
+constexpr size_t kManifestDevices = 5;
+constexpr uint16_t kUnwiredAccessory = 7;
+
+bool expect(bool condition, const char *what) {
+  if (!condition) printf("FAILED: %s\n", what);
+  return condition;
+}
+
+// 4-byte aligned copy of the blob that the checks corrupt
+struct Blob {
+  std::vector<uint32_t> words;
+  size_t size;
+
+  uint8_t *bytes() { return reinterpret_cast<uint8_t *>(words.data()); }
+  DeviceManifestHeader &header() { return *reinterpret_cast<DeviceManifestHeader *>(words.data()); }
+};
+
+bool readBlob(const char *path, Blob &blob) {
+  FILE *file = fopen(path, "rb");
+  if (file == nullptr) return false;
+  uint8_t buffer[1024];
+  blob.size = fread(buffer, 1, sizeof(buffer), file);
+  fclose(file);
+  blob.words.assign((blob.size + 3) / 4, 0);
+  memcpy(blob.bytes(), buffer, blob.size);
+  return blob.size >= sizeof(DeviceManifestHeader);
+}
+
+struct Accessories {
+  FakeLight kitchen;
+  FakeLight secondKitchen;
+  FakeRelayBoard relays{2};
+  FakePlugin plug;
+};
+
+void *resolve(void *context, DeviceType type, uint16_t accessoryId) {
+  Accessories *accessories = static_cast<Accessories *>(context);
+  switch (accessoryId) {
+    case 0:
+      return type == DeviceType::Light ? static_cast<LightAccessoryInterface *>(&accessories->kitchen) : nullptr;
+    case 1:
+      return type == DeviceType::MultiChannel ? static_cast<MultiChannelAccessoryInterface *>(&accessories->relays)
+                                              : nullptr;
+    case 2:
+      return type == DeviceType::PlugIn ? static_cast<PluginAccessoryInterface *>(&accessories->plug) : nullptr;
+    case 3:
+      return type == DeviceType::Light ? static_cast<LightAccessoryInterface *>(&accessories->secondKitchen)
+                                       : nullptr;
+    default:
+      return nullptr;
+  }
+}
+
+bool hasLabel(uint16_t endpointId, const char *label) {
+  esp_matter_attr_val_t val = fake_esp_matter::read(endpointId, Info::Id, Info::Attributes::NodeLabel::Id);
+  return val.type == ESP_MATTER_VAL_TYPE_CHAR_STRING && strcmp(reinterpret_cast<const char *>(val.val.a.b), label) == 0;
+}
+
+bool testValidate(const Blob &original) {
+  DeviceManifest manifest;
+  bool ok = true;
+
+  Blob blob = original;
+  ok = expect(manifest.parse(blob.bytes(), blob.size) == ESP_OK, "tool output accepted") && ok;
+  ok = expect(manifest.deviceCount() == kManifestDevices, "every device listed") && ok;
+  ok = expect(manifest.entry(kManifestDevices) == nullptr, "entry out of range") && ok;
+  ok = expect(manifest.name(2) == nullptr, "unnamed entry") && ok;
+  ok = expect(manifest.name(0) == manifest.name(4), "identical names share the string") && ok;
+  ok = expect(manifest.name(0) == reinterpret_cast<const char *>(blob.bytes()) + blob.header().stringsOffset,
+              "names point into the blob") &&
+       ok;
+  const DeviceManifestEntry *relays = manifest.entry(1);
+  uint32_t lightChannels = static_cast<uint32_t>(MultiChannelDevice::ChannelType::Light);
+  ok = expect(relays != nullptr && relays->type == static_cast<uint8_t>(DeviceType::MultiChannel) &&
+                  relays->accessoryId == 1 && relays->option == lightChannels,
+              "entry fields") &&
+       ok;
+  ok = expect((manifest.entry(2)->flags & DeviceManifest::kFlagBridged) == 0, "standalone flag") && ok;
+
+  ok = expect(manifest.parse(blob.bytes(), sizeof(DeviceManifestHeader) - 1) == ESP_ERR_INVALID_SIZE,
+              "short header rejected") &&
+       ok;
+  ok = expect(manifest.parse(blob.bytes(), blob.size - 1) == ESP_ERR_INVALID_SIZE, "truncated blob rejected") && ok;
+  ok = expect(manifest.deviceCount() == 0, "rejected blob not kept") && ok;
+  ok = expect(manifest.parse(blob.bytes() + 1, blob.size - 1) == ESP_ERR_INVALID_SIZE, "unaligned blob rejected") &&
+       ok;
+
+  blob = original;
+  blob.header().version = DeviceManifest::kVersion + 1;
+  ok = expect(manifest.parse(blob.bytes(), blob.size) == ESP_ERR_INVALID_VERSION, "newer version rejected") && ok;
+
+  blob = original;
+  blob.header().magic ^= 1;
+  ok = expect(manifest.parse(blob.bytes(), blob.size) == ESP_ERR_INVALID_VERSION, "bad magic rejected") && ok;
+
+  blob = original;
+  blob.header().deviceCount = 0xFFFF;
+  ok = expect(manifest.parse(blob.bytes(), blob.size) == ESP_ERR_INVALID_SIZE, "entry table past the blob rejected") &&
+       ok;
+
+  blob = original;
+  blob.header().deviceCount++;
+  ok = expect(manifest.parse(blob.bytes(), blob.size) == ESP_ERR_INVALID_SIZE,
+              "entry table over the strings rejected") &&
+       ok;
+
+  blob = original;
+  blob.header().entriesOffset = 0;
+  ok = expect(manifest.parse(blob.bytes(), blob.size) == ESP_ERR_INVALID_SIZE,
+              "entry table over the header rejected") &&
+       ok;
+
+  blob = original;
+  blob.header().entriesOffset += 2;
+  ok = expect(manifest.parse(blob.bytes(), blob.size) == ESP_ERR_INVALID_SIZE, "unaligned entry table rejected") &&
+       ok;
+
+  blob = original;
+  blob.header().stringsSize++;
+  ok = expect(manifest.parse(blob.bytes(), blob.size) == ESP_ERR_INVALID_SIZE, "string table past the blob rejected") &&
+       ok;
+
+  blob = original;
+  blob.bytes()[blob.size - 1] = 'x';
+  ok = expect(manifest.parse(blob.bytes(), blob.size) == ESP_ERR_INVALID_SIZE, "unterminated strings rejected") && ok;
+  return ok;
+}
+
+bool testInstantiate(const char *path, esp_matter::endpoint_t *aggregator) {
+  DeviceManifest manifest;
+  Accessories accessories;
+  bool ok = true;
+
+  ok = expect(manifest.loadFile("does-not-exist.bin") == ESP_ERR_NOT_FOUND, "missing file reported") && ok;
+  ok = expect(manifest.mapPartition("devices") == ESP_ERR_NOT_FOUND, "missing partition reported") && ok;
+  ok = expect(manifest.loadFile(path) == ESP_OK, "manifest file loaded") && ok;
+
+  // The first two resolved devices only, then all of them
+  BaseDevice *devices[kManifestDevices] = {};
+  size_t created = manifest.instantiate(resolve, &accessories, aggregator, devices, 2);
+  ok = expect(created == 2 && DeviceRegistry::count() == 2, "capacity respected") && ok;
+  for (size_t i = 0; i < created; i++) {
+    delete devices[i];
+  }
+
+  created = manifest.instantiate(resolve, &accessories, aggregator, devices, kManifestDevices);
+  ok = expect(created == kManifestDevices - 1, "entry without accessory skipped") && ok;
+
+  DeviceType types[kManifestDevices] = {};
+  uint16_t endpointIds[kManifestDevices] = {};
+  DeviceSnapshot snapshot;
+  snapshot.types = types;
+  snapshot.endpointIds = endpointIds;
+  snapshot.capacity = kManifestDevices;
+  size_t rows = DeviceRegistry::snapshot(snapshot);
+  size_t lights = 0;
+  size_t multiChannels = 0;
+  size_t plugs = 0;
+  for (size_t i = 0; i < rows; i++) {
+    lights += types[i] == DeviceType::Light;
+    multiChannels += types[i] == DeviceType::MultiChannel;
+    plugs += types[i] == DeviceType::PlugIn;
+  }
+  ok = expect(rows == created && lights == 2 && multiChannels == 1 && plugs == 1, "device types") && ok;
+
+  MultiChannelDevice *relays = nullptr;
+  for (size_t i = 0; i < created; i++) {
+    uint16_t endpointId = 0;
+    devices[i]->getEndpointIds(&endpointId, 1);
+    if (hasLabel(endpointId, "Relays 1")) {
+      relays = static_cast<MultiChannelDevice *>(devices[i]);
+    }
+  }
+  ok = expect(relays != nullptr && relays->getChannelCount() == 2, "multi-channel device created") && ok;
+  ok = expect(relays != nullptr && hasLabel(relays->getChannelEndpointId(1), "Relays 2"), "channel labels") && ok;
+
+  for (size_t i = 0; i < created; i++) {
+    delete devices[i];
+  }
+  ok = expect(DeviceRegistry::count() == 0, "devices destroyed before the manifest") && ok;
+  return ok;
+}
+
+bool testNames(esp_matter::endpoint_t *aggregator) {
+  bool ok = true;
+
+  // A name passed in code is copied, the caller's buffer may go away
+  char buffer[DeviceName::kMaxLength + 2] = "Hallway";
+  DeviceName copied(buffer);
+  strcpy(buffer, "Overwritten");
+  ok = expect(strcmp(copied.get(), "Hallway") == 0 && !copied.isBorrowed(), "code names copied") && ok;
+
+  DeviceName borrowed(BorrowedName{buffer});
+  ok = expect(borrowed.get() == buffer && borrowed.isBorrowed(), "borrowed names referenced in place") && ok;
+
+  DeviceName moved(static_cast<DeviceName &&>(copied));
+  ok = expect(strcmp(moved.get(), "Hallway") == 0 && copied.length() == 0, "moved name handed over") && ok;
+
+  memset(buffer, 'a', sizeof(buffer) - 1);
+  buffer[sizeof(buffer) - 1] = '\0';
+  ok = expect(DeviceName(buffer).length() == 0 && DeviceName(BorrowedName{buffer}).length() == 0,
+              "overlong names ignored") &&
+       ok;
+  ok = expect(DeviceName().length() == 0 && DeviceName(BorrowedName{nullptr}).get()[0] == '\0', "no name") && ok;
+
+  FakeLight light;
+  char temporary[16] = "Porch";
+  LightDevice device(temporary, &light, aggregator);
+  strcpy(temporary, "Gone");
+  uint16_t endpointId = 0;
+  device.getEndpointIds(&endpointId, 1);
+  ok = expect(hasLabel(endpointId, "Porch"), "device built from a temporary buffer") && ok;
+  return ok;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Blob blob;
+  if (argc < 2 || !readBlob(argv[1], blob)) {
+    printf("usage: device_manifest_test <manifest.bin>\n");
+    return 1;
+  }
+
+  esp_matter::endpoint::bridged_node::config_t config;
+  esp_matter::endpoint_t *aggregator =
+      esp_matter::endpoint::bridged_node::create(esp_matter::node::get(), &config, 0, nullptr);
+  bool ok = testValidate(blob);
+  ok = testInstantiate(argv[1], aggregator) && ok;
+  ok = testNames(aggregator) && ok;
+  printf("%s\n", ok ? "device manifest tests passed" : "device manifest tests failed");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+// Accessories of the host tests: they keep the commanded state and call back on demand.
+
+#ifndef FAKE_ACCESSORIES_HPP
+#define FAKE_ACCESSORIES_HPP
+
+#include <DimmableLightAccessoryInterface.hpp>
+#include <FanAccessoryInterface.hpp>
+#include <LightAccessoryInterface.hpp>
+#include <MultiChannelAccessoryInterface.hpp>
+#include <PluginAccessoryInterface.hpp>
+#include <SensorAccessoryInterface.hpp>
+#include <StatelessButtonAccessoryInterface.hpp>
+#include <cstdint>
+
+// Report callback shared by every fake
+class FakeReporter {
+ public:
+  void setCallback(void (*callback)(void *), void *context) {
+    this->callback = callback;
+    this->context = context;
+  }
+
+  void report() {
+    if (callback != nullptr) callback(context);
+  }
+
+  uint32_t identified = 0;
+
+ private:
+  void (*callback)(void *) = nullptr;
+  void *context = nullptr;
+};
+
+template <typename Interface>
+class FakePowerAccessory : public Interface, public FakeReporter {
+ public:
+  void setPower(bool power) override { this->power = power; }
+  bool getPower() override { return power; }
+  void identifyYourSelf() override { identified++; }
+  void setReportAppCallback(void (*callback)(void *), void *context) override { setCallback(callback, context); }
+
+  bool power = false;
+};
+
+typedef FakePowerAccessory<LightAccessoryInterface> FakeLight;
+typedef FakePowerAccessory<FanAccessoryInterface> FakeFan;
+typedef FakePowerAccessory<PluginAccessoryInterface> FakePlugin;
+
+class FakeDimmableLight : public FakePowerAccessory<DimmableLightAccessoryInterface> {
+ public:
+  void setLevel(uint8_t level) override { this->level = level; }
+  uint8_t getLevel() override { return level; }
+
+  uint8_t level = 0;
+};
+
+class FakeButton : public StatelessButtonAccessoryInterface, public FakeReporter {
+ public:
+  PressType getLastPressType() override { return press; }
+  void identifyYourSelf() override { identified++; }
+  void setReportAppCallback(void (*callback)(void *), void *context) override { setCallback(callback, context); }
+
+  PressType press = PressType::SinglePress;
+};
+
+class FakeSensor : public SensorAccessoryInterface, public FakeReporter {
+ public:
+  bool readSample(int32_t &value) override {
+    value = sample;
+    return valid;
+  }
+  void setReportAppCallback(void (*callback)(void *), void *context) override { setCallback(callback, context); }
+  void identifyYourSelf() override { identified++; }
+
+  int32_t sample = 0;
+  bool valid = true;
+};
+
+class FakeRelayBoard : public MultiChannelAccessoryInterface, public FakeReporter {
+ public:
+  explicit FakeRelayBoard(uint8_t channels) : channels(channels) {}
+  uint8_t getChannelCount() override { return channels; }
+  uint32_t getChannelMask() override { return mask; }
+  void setChannelMask(uint32_t powerMask, uint32_t changedMask) override {
+    mask = (mask & ~changedMask) | (powerMask & changedMask);
+    lastChanged = changedMask;
+    writes++;
+  }
+  void setReportAppCallback(void (*callback)(void *), void *context) override { setCallback(callback, context); }
+  void identifyYourSelf() override { identified++; }
+
+  uint8_t channels;
+  uint32_t mask = 0;
+  uint32_t lastChanged = 0;
+  uint32_t writes = 0;
+};
+
+#endif  // FAKE_ACCESSORIES_HPP
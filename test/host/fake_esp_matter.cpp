@@ -0,0 +1,555 @@
+// In-memory esp_matter for the host tests, see fake_esp_matter.hpp.
+//
+// Device types and features create the attributes of the Matter specification the device
+// layer uses; values are not validated. Scheduled CHIP work runs inline on the caller.
+
+#include "fake_esp_matter.hpp"
+
+#include <app/clusters/electrical-energy-measurement-server/electrical-energy-measurement-server.h>
+#include <app/reporting/reporting.h>
+#include <esp_err.h>
+#include <esp_heap_caps.h>
+#include <esp_matter.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <mutex>
+#include <thread>
+
+namespace esp_matter {
+
+struct attribute_t {
+  uint32_t id;
+  esp_matter_attr_val_t val;
+  uint32_t reports;
+  attribute_t *next;
+};
+
+struct cluster_t {
+  uint32_t id;
+  attribute_t *attributes;
+  cluster_t *next;
+};
+
+struct endpoint_t {
+  uint16_t id;
+  endpoint_t *parent;
+  cluster_t *clusters;
+  uint32_t events;
+  endpoint_t *next;
+};
+
+struct node_t {
+  endpoint_t *endpoints;
+  uint16_t nextId;
+};
+
+}  // namespace esp_matter
+
+namespace {
+
+namespace Clusters = chip::app::Clusters;
+using esp_matter::attribute_t;
+using esp_matter::cluster_t;
+using esp_matter::endpoint_t;
+
+// Guards the store, tests drive devices from their own threads and from the wheel
+std::recursive_mutex storeMutex;
+
+std::mutex stackMutex;
+std::thread::id stackOwner;
+std::atomic<uint32_t> stackLockCount(0);
+
+esp_matter::node_t rootNode = {nullptr, 1};
+
+bool reportsFail = false;
+
+endpoint_t *findEndpoint(uint16_t endpointId) {
+  for (endpoint_t *endpoint = rootNode.endpoints; endpoint != nullptr; endpoint = endpoint->next) {
+    if (endpoint->id == endpointId) return endpoint;
+  }
+  return nullptr;
+}
+
+cluster_t *findCluster(endpoint_t *endpoint, uint32_t clusterId) {
+  if (endpoint == nullptr) return nullptr;
+  for (cluster_t *cluster = endpoint->clusters; cluster != nullptr; cluster = cluster->next) {
+    if (cluster->id == clusterId) return cluster;
+  }
+  return nullptr;
+}
+
+attribute_t *findAttribute(cluster_t *cluster, uint32_t attributeId) {
+  if (cluster == nullptr) return nullptr;
+  for (attribute_t *attribute = cluster->attributes; attribute != nullptr; attribute = attribute->next) {
+    if (attribute->id == attributeId) return attribute;
+  }
+  return nullptr;
+}
+
+attribute_t *findAttribute(uint16_t endpointId, uint32_t clusterId, uint32_t attributeId) {
+  return findAttribute(findCluster(findEndpoint(endpointId), clusterId), attributeId);
+}
+
+endpoint_t *addEndpoint(esp_matter::node_t *node) {
+  std::lock_guard<std::recursive_mutex> guard(storeMutex);
+  endpoint_t *endpoint = new endpoint_t{node->nextId++, nullptr, nullptr, 0, nullptr};
+  endpoint_t **link = &node->endpoints;
+  while (*link != nullptr) link = &(*link)->next;
+  *link = endpoint;
+  return endpoint;
+}
+
+cluster_t *addCluster(endpoint_t *endpoint, uint32_t clusterId) {
+  if (endpoint == nullptr) return nullptr;
+  std::lock_guard<std::recursive_mutex> guard(storeMutex);
+  cluster_t *cluster = findCluster(endpoint, clusterId);
+  if (cluster == nullptr) {
+    cluster = new cluster_t{clusterId, nullptr, endpoint->clusters};
+    endpoint->clusters = cluster;
+  }
+  return cluster;
+}
+
+attribute_t *addAttribute(cluster_t *cluster, uint32_t attributeId, esp_matter_attr_val_t val) {
+  if (cluster == nullptr) return nullptr;
+  std::lock_guard<std::recursive_mutex> guard(storeMutex);
+  attribute_t *attribute = findAttribute(cluster, attributeId);
+  if (attribute == nullptr) {
+    attribute = new attribute_t{attributeId, val, 0, cluster->attributes};
+    cluster->attributes = attribute;
+  }
+  return attribute;
+}
+
+// Cluster with attributes of the same type, all zero
+cluster_t *addCluster(endpoint_t *endpoint, uint32_t clusterId, std::initializer_list<uint32_t> attributeIds,
+                      esp_matter_attr_val_t initial) {
+  cluster_t *cluster = addCluster(endpoint, clusterId);
+  for (uint32_t attributeId : attributeIds) addAttribute(cluster, attributeId, initial);
+  return cluster;
+}
+
+// Every device type carries Identify
+esp_err_t addDeviceType(endpoint_t *endpoint) {
+  if (endpoint == nullptr) return ESP_ERR_INVALID_ARG;
+  addCluster(endpoint, Clusters::Identify::Id, {Clusters::Identify::Attributes::IdentifyTime::Id},
+             esp_matter_uint16(0));
+  return ESP_OK;
+}
+
+esp_err_t addOnOff(endpoint_t *endpoint) {
+  addCluster(endpoint, Clusters::OnOff::Id, {Clusters::OnOff::Attributes::OnOff::Id}, esp_matter_bool(false));
+  return addDeviceType(endpoint);
+}
+
+esp_err_t addFeature(cluster_t *cluster, std::initializer_list<uint32_t> attributeIds, esp_matter_attr_val_t initial) {
+  if (cluster == nullptr) return ESP_ERR_INVALID_ARG;
+  for (uint32_t attributeId : attributeIds) addAttribute(cluster, attributeId, initial);
+  return ESP_OK;
+}
+
+}  // namespace
+
+void heap_caps_get_info(multi_heap_info_t *info, uint32_t) { memset(info, 0, sizeof(*info)); }
+
+void MatterReportingAttributeChangeCallback(uint16_t endpoint, uint32_t clusterId, uint32_t attributeId) {
+  std::lock_guard<std::recursive_mutex> guard(storeMutex);
+  // The delegate backed EPM attributes are not in the store, count them on the cluster
+  cluster_t *cluster = findCluster(findEndpoint(endpoint), clusterId);
+  attribute_t *attribute = addAttribute(cluster, attributeId, esp_matter_nullable_int64(nullable<int64_t>()));
+  if (attribute != nullptr) attribute->reports++;
+}
+
+namespace chip {
+namespace app {
+namespace Clusters {
+namespace ElectricalEnergyMeasurement {
+
+bool NotifyCumulativeEnergyMeasured(uint16_t endpointId, const Optional<Structs::EnergyMeasurementStruct::Type> &,
+                                    const Optional<Structs::EnergyMeasurementStruct::Type> &) {
+  MatterReportingAttributeChangeCallback(endpointId, Id, Attributes::CumulativeEnergyImported::Id);
+  return true;
+}
+
+}  // namespace ElectricalEnergyMeasurement
+}  // namespace Clusters
+}  // namespace app
+}  // namespace chip
+
+namespace esp_matter {
+
+namespace node {
+node_t *get() { return &rootNode; }
+}  // namespace node
+
+namespace lock {
+
+status_t chip_stack_lock(uint32_t) {
+  if (stackOwner == std::this_thread::get_id()) return ALREADY_TAKEN;
+  stackMutex.lock();
+  stackOwner = std::this_thread::get_id();
+  stackLockCount++;
+  return SUCCESS;
+}
+
+esp_err_t chip_stack_unlock() {
+  stackOwner = std::thread::id();
+  stackMutex.unlock();
+  return ESP_OK;
+}
+
+}  // namespace lock
+
+namespace attribute {
+
+attribute_t *get(cluster_t *cluster, uint32_t attribute_id) {
+  std::lock_guard<std::recursive_mutex> guard(storeMutex);
+  return findAttribute(cluster, attribute_id);
+}
+
+attribute_t *get(uint16_t endpoint_id, uint32_t cluster_id, uint32_t attribute_id) {
+  std::lock_guard<std::recursive_mutex> guard(storeMutex);
+  return findAttribute(endpoint_id, cluster_id, attribute_id);
+}
+
+esp_err_t get_val(attribute_t *attribute, esp_matter_attr_val_t *val) {
+  if (attribute == nullptr || val == nullptr) return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::recursive_mutex> guard(storeMutex);
+  *val = attribute->val;
+  return ESP_OK;
+}
+
+esp_err_t set_val(attribute_t *attribute, esp_matter_attr_val_t *val) {
+  if (attribute == nullptr || val == nullptr) return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::recursive_mutex> guard(storeMutex);
+  attribute->val = *val;
+  return ESP_OK;
+}
+
+esp_err_t report(uint16_t endpoint_id, uint32_t cluster_id, uint32_t attribute_id, esp_matter_attr_val_t *val) {
+  std::lock_guard<std::recursive_mutex> guard(storeMutex);
+  attribute_t *attribute = findAttribute(endpoint_id, cluster_id, attribute_id);
+  if (attribute == nullptr || val == nullptr) return ESP_ERR_NOT_FOUND;
+  if (reportsFail) return ESP_FAIL;
+  attribute->val = *val;
+  attribute->reports++;
+  return ESP_OK;
+}
+
+}  // namespace attribute
+
+namespace cluster {
+
+cluster_t *get(endpoint_t *endpoint, uint32_t cluster_id) {
+  std::lock_guard<std::recursive_mutex> guard(storeMutex);
+  return findCluster(endpoint, cluster_id);
+}
+
+namespace bridged_device_basic_information {
+namespace attribute {
+
+attribute_t *create_node_label(cluster_t *cluster, const char *value, uint16_t length) {
+  // The store owns a copy of the label like esp_matter does
+  esp_matter_attr_val_t val = {};
+  val.type = ESP_MATTER_VAL_TYPE_CHAR_STRING;
+  val.val.a.b = new uint8_t[length + 1];
+  memcpy(val.val.a.b, value, length);
+  val.val.a.b[length] = 0;
+  val.val.a.s = length;
+  return addAttribute(cluster, Clusters::BridgedDeviceBasicInformation::Attributes::NodeLabel::Id, val);
+}
+
+}  // namespace attribute
+}  // namespace bridged_device_basic_information
+
+namespace window_covering {
+namespace feature {
+
+namespace lift {
+esp_err_t add(cluster_t *cluster, config_t *config) {
+  // NumberOfActuationsLift
+  return addFeature(cluster, {0x0005}, esp_matter_uint16(config->number_of_actuations_lift));
+}
+}  // namespace lift
+
+namespace position_aware_lift {
+esp_err_t add(cluster_t *cluster, config_t *config) {
+  namespace Attributes = Clusters::WindowCovering::Attributes;
+  // CurrentPositionLiftPercentage
+  addFeature(cluster, {0x0008}, esp_matter_nullable_uint8(config->current_position_lift_percentage));
+  addFeature(cluster, {Attributes::TargetPositionLiftPercent100ths::Id},
+             esp_matter_nullable_uint16(config->target_position_lift_percent_100ths));
+  return addFeature(cluster, {Attributes::CurrentPositionLiftPercent100ths::Id},
+                    esp_matter_nullable_uint16(config->current_position_lift_percent_100ths));
+}
+}  // namespace position_aware_lift
+
+namespace absolute_position {
+esp_err_t add(cluster_t *cluster, config_t *config) {
+  // PhysicalClosedLimitLift, CurrentPositionLift, InstalledOpenLimitLift, InstalledClosedLimitLift
+  return addFeature(cluster, {0x0001, 0x0003, 0x0010, 0x0011}, esp_matter_uint16(config->physical_closed_limit_lift));
+}
+}  // namespace absolute_position
+
+}  // namespace feature
+}  // namespace window_covering
+
+namespace switch_cluster {
+namespace feature {
+
+namespace momentary_switch {
+esp_err_t add(cluster_t *cluster) { return cluster == nullptr ? ESP_ERR_INVALID_ARG : ESP_OK; }
+}  // namespace momentary_switch
+
+namespace momentary_switch_release {
+esp_err_t add(cluster_t *cluster) { return cluster == nullptr ? ESP_ERR_INVALID_ARG : ESP_OK; }
+}  // namespace momentary_switch_release
+
+namespace momentary_switch_long_press {
+esp_err_t add(cluster_t *cluster) { return cluster == nullptr ? ESP_ERR_INVALID_ARG : ESP_OK; }
+}  // namespace momentary_switch_long_press
+
+namespace momentary_switch_multi_press {
+esp_err_t add(cluster_t *cluster, config_t *config) {
+  // MultiPressMax
+  return addFeature(cluster, {0x0002}, esp_matter_uint8(config->multi_press_max));
+}
+}  // namespace momentary_switch_multi_press
+
+}  // namespace feature
+
+namespace event {
+
+static esp_err_t sendEvent(uint16_t endpoint_id) {
+  std::lock_guard<std::recursive_mutex> guard(storeMutex);
+  endpoint_t *endpoint = findEndpoint(endpoint_id);
+  if (endpoint == nullptr) return ESP_ERR_NOT_FOUND;
+  endpoint->events++;
+  return ESP_OK;
+}
+
+esp_err_t send_initial_press(uint16_t endpoint_id, uint8_t) { return sendEvent(endpoint_id); }
+
+esp_err_t send_long_press(uint16_t endpoint_id, uint8_t) { return sendEvent(endpoint_id); }
+
+esp_err_t send_multi_press_complete(uint16_t endpoint_id, uint8_t, uint8_t) { return sendEvent(endpoint_id); }
+
+}  // namespace event
+}  // namespace switch_cluster
+
+namespace electrical_power_measurement {
+
+// PowerMode, NumberOfMeasurementTypes, Accuracy
+cluster_t *create(endpoint_t *endpoint, config_t *, uint8_t) {
+  return addCluster(endpoint, Clusters::ElectricalPowerMeasurement::Id, {0x0000, 0x0001, 0x0002},
+                    esp_matter_enum8(0));
+}
+
+namespace feature {
+namespace alternating_current {
+esp_err_t add(cluster_t *cluster) { return cluster == nullptr ? ESP_ERR_INVALID_ARG : ESP_OK; }
+}  // namespace alternating_current
+}  // namespace feature
+
+}  // namespace electrical_power_measurement
+
+namespace electrical_energy_measurement {
+
+// Accuracy
+cluster_t *create(endpoint_t *endpoint, config_t *, uint8_t) {
+  return addCluster(endpoint, Clusters::ElectricalEnergyMeasurement::Id, {0x0000}, esp_matter_enum8(0));
+}
+
+namespace feature {
+namespace imported_energy {
+esp_err_t add(cluster_t *cluster) { return cluster == nullptr ? ESP_ERR_INVALID_ARG : ESP_OK; }
+}  // namespace imported_energy
+namespace cumulative_energy {
+esp_err_t add(cluster_t *cluster) {
+  return addFeature(cluster, {Clusters::ElectricalEnergyMeasurement::Attributes::CumulativeEnergyImported::Id},
+                    esp_matter_nullable_int64(nullable<int64_t>()));
+}
+}  // namespace cumulative_energy
+}  // namespace feature
+
+}  // namespace electrical_energy_measurement
+
+namespace power_topology {
+
+cluster_t *create(endpoint_t *endpoint, config_t *, uint8_t) {
+  return addCluster(endpoint, Clusters::PowerTopology::Id);
+}
+
+namespace feature {
+namespace node_topology {
+esp_err_t add(cluster_t *cluster) { return cluster == nullptr ? ESP_ERR_INVALID_ARG : ESP_OK; }
+}  // namespace node_topology
+}  // namespace feature
+
+}  // namespace power_topology
+
+}  // namespace cluster
+
+namespace endpoint {
+
+endpoint_t *create(node_t *node, uint8_t, void *) { return node == nullptr ? nullptr : addEndpoint(node); }
+
+uint16_t get_id(endpoint_t *endpoint) { return endpoint == nullptr ? 0xFFFF : endpoint->id; }
+
+esp_err_t set_parent_endpoint(endpoint_t *endpoint, endpoint_t *parent_endpoint) {
+  if (endpoint == nullptr || parent_endpoint == nullptr) return ESP_ERR_INVALID_ARG;
+  endpoint->parent = parent_endpoint;
+  return ESP_OK;
+}
+
+#define FAKE_DEVICE_TYPE(name)                                                            \
+  namespace name {                                                                        \
+  endpoint_t *create(node_t *node, config_t *config, uint8_t flags, void *priv_data) {    \
+    endpoint_t *endpoint = endpoint::create(node, flags, priv_data);                      \
+    return add(endpoint, config) == ESP_OK ? endpoint : nullptr;                          \
+  }                                                                                       \
+  }
+
+namespace bridged_node {
+esp_err_t add(endpoint_t *endpoint, config_t *) {
+  namespace Attributes = Clusters::BridgedDeviceBasicInformation::Attributes;
+  addCluster(endpoint, Clusters::BridgedDeviceBasicInformation::Id, {Attributes::Reachable::Id}, esp_matter_bool(true));
+  return endpoint == nullptr ? ESP_ERR_INVALID_ARG : ESP_OK;
+}
+}  // namespace bridged_node
+FAKE_DEVICE_TYPE(bridged_node)
+
+namespace on_off_light {
+esp_err_t add(endpoint_t *endpoint, config_t *) { return addOnOff(endpoint); }
+}  // namespace on_off_light
+FAKE_DEVICE_TYPE(on_off_light)
+
+namespace on_off_plugin_unit {
+esp_err_t add(endpoint_t *endpoint, config_t *) { return addOnOff(endpoint); }
+}  // namespace on_off_plugin_unit
+FAKE_DEVICE_TYPE(on_off_plugin_unit)
+
+namespace dimmable_light {
+esp_err_t add(endpoint_t *endpoint, config_t *) {
+  namespace Attributes = Clusters::LevelControl::Attributes;
+  addCluster(endpoint, Clusters::LevelControl::Id, {Attributes::CurrentLevel::Id},
+             esp_matter_nullable_uint8(nullable<uint8_t>(0)));
+  addCluster(endpoint, Clusters::LevelControl::Id,
+             {Attributes::RemainingTime::Id, Attributes::OnOffTransitionTime::Id}, esp_matter_uint16(0));
+  return addOnOff(endpoint);
+}
+}  // namespace dimmable_light
+FAKE_DEVICE_TYPE(dimmable_light)
+
+namespace fan {
+esp_err_t add(endpoint_t *endpoint, config_t *) {
+  namespace Attributes = Clusters::FanControl::Attributes;
+  addCluster(endpoint, Clusters::FanControl::Id, {Attributes::FanMode::Id}, esp_matter_enum8(0));
+  addCluster(endpoint, Clusters::FanControl::Id, {Attributes::PercentSetting::Id},
+             esp_matter_nullable_uint8(nullable<uint8_t>(0)));
+  addCluster(endpoint, Clusters::FanControl::Id, {Attributes::PercentCurrent::Id}, esp_matter_uint8(0));
+  return addDeviceType(endpoint);
+}
+}  // namespace fan
+FAKE_DEVICE_TYPE(fan)
+
+namespace window_covering_device {
+esp_err_t add(endpoint_t *endpoint, config_t *) {
+  // Type, ConfigStatus, OperationalStatus, EndProductType, Mode
+  addCluster(endpoint, Clusters::WindowCovering::Id,
+             {0x0000, 0x0007, Clusters::WindowCovering::Attributes::OperationalStatus::Id, 0x000D, 0x0017},
+             esp_matter_bitmap8(0));
+  return addDeviceType(endpoint);
+}
+}  // namespace window_covering_device
+FAKE_DEVICE_TYPE(window_covering_device)
+
+namespace generic_switch {
+esp_err_t add(endpoint_t *endpoint, config_t *) {
+  // NumberOfPositions, CurrentPosition
+  addCluster(endpoint, Clusters::Switch::Id, {0x0000, Clusters::Switch::Attributes::CurrentPosition::Id},
+             esp_matter_uint8(0));
+  return addDeviceType(endpoint);
+}
+}  // namespace generic_switch
+FAKE_DEVICE_TYPE(generic_switch)
+
+namespace temperature_sensor {
+esp_err_t add(endpoint_t *endpoint, config_t *) {
+  addCluster(endpoint, Clusters::TemperatureMeasurement::Id,
+             {Clusters::TemperatureMeasurement::Attributes::MeasuredValue::Id},
+             esp_matter_nullable_int16(nullable<int16_t>()));
+  return addDeviceType(endpoint);
+}
+}  // namespace temperature_sensor
+FAKE_DEVICE_TYPE(temperature_sensor)
+
+namespace humidity_sensor {
+esp_err_t add(endpoint_t *endpoint, config_t *) {
+  addCluster(endpoint, Clusters::RelativeHumidityMeasurement::Id,
+             {Clusters::RelativeHumidityMeasurement::Attributes::MeasuredValue::Id},
+             esp_matter_nullable_uint16(nullable<uint16_t>()));
+  return addDeviceType(endpoint);
+}
+}  // namespace humidity_sensor
+FAKE_DEVICE_TYPE(humidity_sensor)
+
+namespace occupancy_sensor {
+esp_err_t add(endpoint_t *endpoint, config_t *) {
+  addCluster(endpoint, Clusters::OccupancySensing::Id, {Clusters::OccupancySensing::Attributes::Occupancy::Id},
+             esp_matter_bitmap8(0));
+  return addDeviceType(endpoint);
+}
+}  // namespace occupancy_sensor
+FAKE_DEVICE_TYPE(occupancy_sensor)
+
+#undef FAKE_DEVICE_TYPE
+
+}  // namespace endpoint
+
+}  // namespace esp_matter
+
+namespace fake_esp_matter {
+
+bool has(uint16_t endpointId, uint32_t clusterId, uint32_t attributeId) {
+  std::lock_guard<std::recursive_mutex> guard(storeMutex);
+  return findAttribute(endpointId, clusterId, attributeId) != nullptr;
+}
+
+esp_matter_attr_val_t read(uint16_t endpointId, uint32_t clusterId, uint32_t attributeId) {
+  std::lock_guard<std::recursive_mutex> guard(storeMutex);
+  attribute_t *attribute = findAttribute(endpointId, clusterId, attributeId);
+  return attribute == nullptr ? esp_matter_attr_val_t{} : attribute->val;
+}
+
+esp_err_t write(uint16_t endpointId, uint32_t clusterId, uint32_t attributeId, esp_matter_attr_val_t val) {
+  std::lock_guard<std::recursive_mutex> guard(storeMutex);
+  attribute_t *attribute = findAttribute(endpointId, clusterId, attributeId);
+  if (attribute == nullptr) return ESP_ERR_NOT_FOUND;
+  attribute->val = val;
+  return ESP_OK;
+}
+
+uint32_t reports(uint16_t endpointId, uint32_t clusterId, uint32_t attributeId) {
+  std::lock_guard<std::recursive_mutex> guard(storeMutex);
+  attribute_t *attribute = findAttribute(endpointId, clusterId, attributeId);
+  return attribute == nullptr ? 0 : attribute->reports;
+}
+
+uint32_t events(uint16_t endpointId) {
+  std::lock_guard<std::recursive_mutex> guard(storeMutex);
+  endpoint_t *endpoint = findEndpoint(endpointId);
+  return endpoint == nullptr ? 0 : endpoint->events;
+}
+
+void failReports(bool fail) {
+  std::lock_guard<std::recursive_mutex> guard(storeMutex);
+  reportsFail = fail;
+}
+
+uint32_t stackLocks() { return stackLockCount.load(); }
+
+}  // namespace fake_esp_matter
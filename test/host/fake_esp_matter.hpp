@@ -0,0 +1,61 @@
+// Inspection side of the in-memory esp_matter fake of the host tests.
+//
+// The fake keeps endpoints, clusters and attributes in intrusive lists, each object its own
+// heap allocation like in esp_matter, so allocation counts of device constructors include the
+// Matter objects they request. Tests write attributes as a controller would and count the
+// reports and events the device layer sends.
+
+#ifndef FAKE_ESP_MATTER_HPP
+#define FAKE_ESP_MATTER_HPP
+
+#include <esp_err.h>
+#include <esp_matter.h>
+
+#include <cstdint>
+
+namespace fake_esp_matter {
+
+/**
+ * @brief Check whether an attribute exists.
+ *
+ * @return bool true if the endpoint has the attribute.
+ */
+bool has(uint16_t endpointId, uint32_t clusterId, uint32_t attributeId);
+
+/**
+ * @brief Read an attribute from the store.
+ *
+ * @return esp_matter_attr_val_t The value, ESP_MATTER_VAL_TYPE_INVALID if it does not exist.
+ */
+esp_matter_attr_val_t read(uint16_t endpointId, uint32_t clusterId, uint32_t attributeId);
+
+/**
+ * @brief Write an attribute as a controller would, without reporting it.
+ *
+ * @return esp_err_t ESP_ERR_NOT_FOUND if the attribute does not exist.
+ */
+esp_err_t write(uint16_t endpointId, uint32_t clusterId, uint32_t attributeId, esp_matter_attr_val_t val);
+
+/**
+ * @brief Get the number of esp_matter reports and change notifications of an attribute.
+ */
+uint32_t reports(uint16_t endpointId, uint32_t clusterId, uint32_t attributeId);
+
+/**
+ * @brief Get the number of switch events sent by an endpoint.
+ */
+uint32_t events(uint16_t endpointId);
+
+/**
+ * @brief Make attribute::report() fail with ESP_FAIL, as a busy stack would.
+ */
+void failReports(bool fail);
+
+/**
+ * @brief Get the number of times the stack lock was taken, nested calls not counted.
+ */
+uint32_t stackLocks();
+
+}  // namespace fake_esp_matter
+
+#endif  // FAKE_ESP_MATTER_HPP
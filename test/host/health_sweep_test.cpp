@@ -0,0 +1,116 @@
+// HealthSweep reachability hysteresis.
+//
+// A device turns unreachable only after failThreshold consecutive failed probes and reachable
+// again after recoverThreshold consecutive good ones; a contradicting probe restarts the count.
+// Only the flips are reported on Reachable, once per flip, and a device without probe is never
+// probed. The sweep is driven with tick() on the test thread.
+
+#include <fake_accessories.hpp>
+#include <fake_esp_matter.hpp>
+
+#include <HealthProbeInterface.hpp>
+#include <HealthSweep.hpp>
+#include <LightDevice.hpp>
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+
+namespace Info = chip::app::Clusters::BridgedDeviceBasicInformation;
+
+constexpr uint8_t kFailThreshold = 3;
+constexpr uint8_t kRecoverThreshold = 2;
+
+bool expect(bool condition, const char *what) {
+  if (!condition) printf("FAILED: %s\n", what);
+  return condition;
+}
+
+class FakeProbe : public HealthProbeInterface {
+ public:
+  bool isResponsive() override { return responsive; }
+
+  bool responsive = true;
+};
+
+struct Observed {
+  uint16_t endpointId;
+  uint32_t reports;
+};
+
+uint32_t reachableReports(uint16_t endpointId) {
+  return fake_esp_matter::reports(endpointId, Info::Id, Info::Attributes::Reachable::Id);
+}
+
+bool reachable(uint16_t endpointId) {
+  return fake_esp_matter::read(endpointId, Info::Id, Info::Attributes::Reachable::Id).val.b;
+}
+
+// Tick the sweep and check the reachability and the number of Reachable reports made so far
+bool tickAndExpect(const LightDevice &device, Observed &observed, bool isReachable, uint32_t newReports,
+                   const char *what) {
+  HealthSweep::instance().tick();
+  uint32_t reports = reachableReports(observed.endpointId);
+  bool ok = expect(device.isReachable() == isReachable && reachable(observed.endpointId) == isReachable, what);
+  ok = expect(reports - observed.reports == newReports, what) && ok;
+  observed.reports = reports;
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  esp_matter::endpoint::bridged_node::config_t config;
+  esp_matter::endpoint_t *aggregator =
+      esp_matter::endpoint::bridged_node::create(esp_matter::node::get(), &config, 0, nullptr);
+  HealthSweep &sweep = HealthSweep::instance();
+  sweep.setHysteresis(kFailThreshold, kRecoverThreshold);
+
+  FakeLight light;
+  FakeProbe probe;
+  LightDevice device("light", &light, aggregator);
+  device.setHealthProbe(&probe);
+  FakeLight otherLight;
+  LightDevice unprobed("unprobed", &otherLight, aggregator);
+
+  Observed observed = {0, 0};
+  device.getEndpointIds(&observed.endpointId, 1);
+  observed.reports = reachableReports(observed.endpointId);
+  uint16_t unprobedId = 0;
+  unprobed.getEndpointIds(&unprobedId, 1);
+  uint32_t unprobedReports = reachableReports(unprobedId);
+  bool ok = true;
+
+  ok = tickAndExpect(device, observed, true, 0, "responsive device stays reachable") && ok;
+
+  // Two failures, then a good probe restarts the count
+  probe.responsive = false;
+  ok = tickAndExpect(device, observed, true, 0, "first failure absorbed") && ok;
+  ok = tickAndExpect(device, observed, true, 0, "second failure absorbed") && ok;
+  probe.responsive = true;
+  ok = tickAndExpect(device, observed, true, 0, "good probe restarts the failure count") && ok;
+  probe.responsive = false;
+  ok = tickAndExpect(device, observed, true, 0, "failure count restarted") && ok;
+  ok = tickAndExpect(device, observed, true, 0, "second failure after the restart absorbed") && ok;
+  ok = tickAndExpect(device, observed, false, 1, "third failure reported unreachable once") && ok;
+  ok = tickAndExpect(device, observed, false, 0, "staying unreachable is not reported again") && ok;
+  ok = expect(device.updateAccessory() == ESP_ERR_INVALID_STATE, "unreachable device rejects updates") && ok;
+
+  // Recovery needs kRecoverThreshold good probes
+  probe.responsive = true;
+  ok = tickAndExpect(device, observed, false, 0, "first good probe absorbed") && ok;
+  ok = tickAndExpect(device, observed, true, 1, "second good probe reported reachable once") && ok;
+
+  HealthSweep::Stats stats = sweep.getStats();
+  ok = expect(stats.transitions == 2, "both flips counted") && ok;
+  ok = expect(stats.ticks == 10 && stats.probes == 20, "every tick visited both devices") && ok;
+  ok = expect(unprobed.isReachable() && reachableReports(unprobedId) == unprobedReports,
+              "unprobed device untouched") &&
+       ok;
+  ok = expect(sweep.start(1000, HealthSweep::kMaxDevicesPerTick + 1) == ESP_ERR_INVALID_ARG,
+              "oversized tick rejected") &&
+       ok;
+
+  printf("%s\n", ok ? "health sweep tests passed" : "health sweep tests failed");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+// MultiChannelDevice mask diffing.
+//
+// Matter writes of several channels reach the relay board in one hardware write carrying only
+// the changed channels, and accessory changes are reported for the changed channels only, all
+// of them under a single stack lock. A device without accessory refuses to report or identify.
+
+#include <fake_accessories.hpp>
+#include <fake_esp_matter.hpp>
+
+#include <MultiChannelDevice.hpp>
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+
+namespace OnOff = chip::app::Clusters::OnOff;
+
+constexpr uint8_t kChannels = 4;
+
+bool expect(bool condition, const char *what) {
+  if (!condition) printf("FAILED: %s\n", what);
+  return condition;
+}
+
+uint32_t reports(const MultiChannelDevice &device, uint8_t channel) {
+  return fake_esp_matter::reports(device.getChannelEndpointId(channel), OnOff::Id, OnOff::Attributes::OnOff::Id);
+}
+
+bool power(const MultiChannelDevice &device, uint8_t channel) {
+  return fake_esp_matter::read(device.getChannelEndpointId(channel), OnOff::Id, OnOff::Attributes::OnOff::Id).val.b;
+}
+
+void write(const MultiChannelDevice &device, uint8_t channel, bool on) {
+  fake_esp_matter::write(device.getChannelEndpointId(channel), OnOff::Id, OnOff::Attributes::OnOff::Id,
+                         esp_matter_bool(on));
+}
+
+bool testMatterWrites(esp_matter::endpoint_t *aggregator) {
+  FakeRelayBoard board(kChannels);
+  board.mask = 0x5;
+  MultiChannelDevice device("relays", &board, aggregator);
+  bool ok = true;
+
+  // The stored state, all off, is brought to the board in one write
+  ok = expect(device.getChannelCount() == kChannels, "one endpoint per channel") && ok;
+  ok = expect(board.writes == 1 && board.mask == 0, "stored state written once") && ok;
+
+  write(device, 1, true);
+  write(device, 3, true);
+  ok = expect(device.updateAccessory() == ESP_OK, "update accepted") && ok;
+  ok = expect(board.writes == 2, "two channels written in one hardware write") && ok;
+  ok = expect(board.lastChanged == 0xA && board.mask == 0xA, "only the changed channels written") && ok;
+  ok = expect(device.getState().powerMask == 0xA, "shadow holds the written mask") && ok;
+
+  device.updateAccessory();
+  ok = expect(board.writes == 2, "unchanged endpoints not written again") && ok;
+  return ok;
+}
+
+bool testAccessoryReports(esp_matter::endpoint_t *aggregator) {
+  FakeRelayBoard board(kChannels);
+  MultiChannelDevice device("relays", &board, aggregator);
+  bool ok = true;
+
+  write(device, 0, true);
+  device.updateAccessory();
+  uint32_t before[kChannels];
+  for (uint8_t channel = 0; channel < kChannels; channel++) {
+    before[channel] = reports(device, channel);
+  }
+  uint32_t locks = fake_esp_matter::stackLocks();
+
+  // Channel 0 stays on, channels 1 and 2 switch on
+  board.mask = 0x7;
+  board.report();
+  ok = expect(fake_esp_matter::stackLocks() == locks + 1, "changed channels reported under one stack lock") && ok;
+  ok = expect(reports(device, 0) == before[0] && reports(device, 3) == before[3], "unchanged channels not reported") &&
+       ok;
+  ok = expect(reports(device, 1) == before[1] + 1 && reports(device, 2) == before[2] + 1,
+              "changed channels reported") &&
+       ok;
+  ok = expect(power(device, 0) && power(device, 1) && power(device, 2) && !power(device, 3),
+              "store follows the board") &&
+       ok;
+  ok = expect(device.getState().powerMask == 0x7, "shadow follows the board") && ok;
+
+  // Nothing changed, nothing reported
+  locks = fake_esp_matter::stackLocks();
+  board.report();
+  ok = expect(fake_esp_matter::stackLocks() == locks && reports(device, 1) == before[1] + 1,
+              "unchanged mask not reported") &&
+       ok;
+  return ok;
+}
+
+bool testWithoutAccessory() {
+  MultiChannelDevice device("empty");
+  bool ok = true;
+  ok = expect(device.getChannelCount() == 0, "no channels without accessory") && ok;
+  ok = expect(device.reportEndpoint() == ESP_ERR_INVALID_STATE, "report refused without accessory") && ok;
+  ok = expect(device.identify() == ESP_ERR_INVALID_STATE, "identify refused without accessory") && ok;
+  ok = expect(device.updateAccessory() == ESP_OK, "update is a no-op without accessory") && ok;
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  esp_matter::endpoint::bridged_node::config_t config;
+  esp_matter::endpoint_t *aggregator =
+      esp_matter::endpoint::bridged_node::create(esp_matter::node::get(), &config, 0, nullptr);
+  bool ok = testMatterWrites(aggregator);
+  ok = testAccessoryReports(aggregator) && ok;
+  ok = testWithoutAccessory() && ok;
+  printf("%s\n", ok ? "multi channel device tests passed" : "multi channel device tests failed");
+  return ok ? 0 : 1;
+}
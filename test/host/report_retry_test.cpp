@@ -0,0 +1,72 @@
+// A retry must never bring back a value older than the latest fresh report of its path.
+//
+// The scheduler is not started, so every report is made synchronously and the run is
+// deterministic. The fake stack rejects reports on demand; fresh reports are numbered from 1
+// in this process, which gives the sequences the retry queue hands back to the scheduler.
+
+#include <fake_esp_matter.hpp>
+
+#include <HostTickSource.hpp>
+#include <ReportRetryQueue.hpp>
+#include <ReportScheduler.hpp>
+#include <TimerWheel.hpp>
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+
+namespace Info = chip::app::Clusters::BridgedDeviceBasicInformation;
+
+bool expect(bool condition, const char *what) {
+  if (!condition) printf("FAILED: %s\n", what);
+  return condition;
+}
+
+bool reachable(uint16_t endpointId) {
+  return fake_esp_matter::read(endpointId, Info::Id, Info::Attributes::Reachable::Id).val.b;
+}
+
+}  // namespace
+
+int main() {
+  HostTickSource ticks;
+  ticks.start();
+  ReportScheduler &scheduler = ReportScheduler::instance();
+  ReportRetryQueue &retries = ReportRetryQueue::instance();
+
+  esp_matter::endpoint::bridged_node::config_t config;
+  esp_matter::endpoint_t *endpoint =
+      esp_matter::endpoint::bridged_node::create(esp_matter::node::get(), &config, 0, nullptr);
+  uint16_t endpointId = esp_matter::endpoint::get_id(endpoint);
+  esp_matter_attr_val_t off = esp_matter_bool(false);
+  esp_matter_attr_val_t on = esp_matter_bool(true);
+  bool ok = true;
+
+  // Fresh report 1 is rejected and retried once the backoff expired
+  fake_esp_matter::failReports(true);
+  scheduler.reportAttribute(ReportLane::State, endpointId, Info::Id, Info::Attributes::Reachable::Id, &off);
+  fake_esp_matter::failReports(false);
+  ok = expect(retries.getStats().depth == 1, "rejected report queued") && ok;
+  ticks.advanceMs(ReportRetryQueue::backoffMs(0));
+  ok = expect(retries.getStats().retried == 1 && !reachable(endpointId), "retry delivered") && ok;
+
+  // Fresh report 2 is rejected, fresh report 3 is sent while its retry is on the way
+  fake_esp_matter::failReports(true);
+  scheduler.reportAttribute(ReportLane::State, endpointId, Info::Id, Info::Attributes::Reachable::Id, &on);
+  fake_esp_matter::failReports(false);
+  scheduler.reportAttribute(ReportLane::State, endpointId, Info::Id, Info::Attributes::Reachable::Id, &off);
+  ok = expect(retries.getStats().depth == 0, "fresh report cancels the pending retry") && ok;
+
+  // The retry of report 2 was already taken from the queue and arrives late
+  scheduler.reportAttribute(ReportLane::State, endpointId, Info::Id, Info::Attributes::Reachable::Id, &on, 1, 2);
+  ok = expect(!reachable(endpointId), "late retry does not overwrite the fresh value") && ok;
+  ok = expect(scheduler.getStats(ReportLane::State).superseded == 1, "late retry counted as superseded") && ok;
+
+  // A retry of the latest fresh report still goes through
+  scheduler.reportAttribute(ReportLane::State, endpointId, Info::Id, Info::Attributes::Reachable::Id, &on, 1, 3);
+  ok = expect(reachable(endpointId), "retry of the latest report delivered") && ok;
+
+  ticks.stop();
+  printf("%s\n", ok ? "report retries keep the latest value" : "report retries lost the latest value");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+// Stress test of SeqLock: concurrent writers and readers on one value.
+//
+// Every written value keeps an invariant across all of its words, so a torn read is
+// detected. Writers modify the value in place; the final count proves that no modify() was
+// lost. The readers outnumber the cores so writers get preempted while holding the lock,
+// which exercises the fallback of read() on the writer mutex.
+
+#include <SeqLock.hpp>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int kWriters = 4;
+constexpr int kModifiesPerWriter = 50000;
+
+struct Value {
+  uint64_t count;    /**< Number of modify() calls applied. */
+  uint32_t pattern;  /**< Last pattern written. */
+  uint32_t inverse;  /**< Always ~pattern. */
+  uint32_t words[4]; /**< Always pattern. */
+};
+
+bool consistent(const Value &value) {
+  if (value.inverse != ~value.pattern) return false;
+  for (uint32_t word : value.words) {
+    if (word != value.pattern) return false;
+  }
+  return true;
+}
+
+void setPattern(Value &value, uint32_t pattern) {
+  value.pattern = pattern;
+  value.inverse = ~pattern;
+  for (uint32_t &word : value.words) word = pattern;
+}
+
+}  // namespace
+
+int main() {
+  Value initial = {};
+  setPattern(initial, 0);
+  SeqLock<Value> lock(initial);
+
+  std::atomic<bool> done(false);
+  std::atomic<uint64_t> reads(0);
+  std::atomic<uint64_t> torn(0);
+  std::atomic<uint64_t> backwards(0);
+
+  int readers = static_cast<int>(std::thread::hardware_concurrency()) + 2;
+  std::vector<std::thread> threads;
+  for (int r = 0; r < readers; r++) {
+    threads.emplace_back([&]() {
+      uint64_t lastCount = 0;
+      while (!done.load()) {
+        Value value = lock.read();
+        if (!consistent(value)) torn++;
+        // Counts only grow, a reader must never see an older value after a newer one
+        if (value.count < lastCount) backwards++;
+        lastCount = value.count;
+        reads++;
+      }
+    });
+  }
+
+  std::vector<std::thread> writers;
+  for (int w = 0; w < kWriters; w++) {
+    writers.emplace_back([&lock, w]() {
+      for (int i = 0; i < kModifiesPerWriter; i++) {
+        uint32_t pattern = static_cast<uint32_t>(w * kModifiesPerWriter + i) * 2654435761u;
+        lock.modify([pattern](Value &value) {
+          value.count++;
+          setPattern(value, pattern);
+        });
+      }
+    });
+  }
+  for (std::thread &writer : writers) writer.join();
+  done.store(true);
+  for (std::thread &thread : threads) thread.join();
+
+  Value final = lock.read();
+  uint64_t expected = static_cast<uint64_t>(kWriters) * kModifiesPerWriter;
+  printf("%llu reads by %d readers, %llu torn, %llu backwards, count %llu of %llu\n",
+         static_cast<unsigned long long>(reads.load()), readers, static_cast<unsigned long long>(torn.load()),
+         static_cast<unsigned long long>(backwards.load()), static_cast<unsigned long long>(final.count),
+         static_cast<unsigned long long>(expected));
+
+  // write() must replace the value as a whole
+  Value replaced = {};
+  setPattern(replaced, 0x5a5a5a5a);
+  replaced.count = 7;
+  lock.write(replaced);
+  Value readBack = lock.read();
+  bool writeOk = consistent(readBack) && readBack.count == 7 && readBack.pattern == 0x5a5a5a5a;
+
+  bool ok = torn.load() == 0 && backwards.load() == 0 && final.count == expected && consistent(final);
+  return ok && writeOk ? 0 : 1;
+}
@@ -0,0 +1,159 @@
+#include "simulated_blind_accessory.hpp"
+
+#include <BlindAccessoryInterface.hpp>
+#include <TimerWheel.hpp>
+#include <cstdint>
+
+namespace {
+
+// Positions are tracked in 1/100 % so slow blinds still move every tick
+constexpr uint32_t kFullTravel = 10000;
+
+uint16_t toPercent(uint32_t position) { return static_cast<uint16_t>((position + 50) / 100); }
+
+}  // namespace
+
+SimulatedBlindAccessory::SimulatedBlindAccessory(uint32_t openMs, uint32_t closeMs, uint32_t startLatencyMs,
+                                                 uint32_t stopLatencyMs, TimerWheel &wheel)
+    : openMs(openMs),
+      closeMs(closeMs),
+      startLatencyMs(startLatencyMs),
+      stopLatencyMs(stopLatencyMs),
+      wheel(wheel),
+      tickTimer(),
+      callback(nullptr),
+      callbackContext(nullptr),
+      phase(Phase::Idle),
+      closing(false),
+      reportDue(false),
+      phaseTicks(0),
+      position(0),
+      travelRemainder(0),
+      target(0),
+      moves(0),
+      runTicks(0) {}
+
+SimulatedBlindAccessory::~SimulatedBlindAccessory() { wheel.cancelAndWait(tickTimer); }
+
+void SimulatedBlindAccessory::moveBlindTo(uint16_t position) {
+  target = position > 100 ? 100 : position;
+  uint32_t targetPosition = target * 100u;
+  reportDue = true;
+
+  switch (phase) {
+    case Phase::Idle:
+    case Phase::Starting:
+      // Like a real blind, a target within the reported percent does not start the motor
+      if (target == toPercent(this->position)) {
+        phase = Phase::Idle;
+        break;
+      }
+      closing = targetPosition > this->position;
+      if (phase == Phase::Idle) {
+        moves++;
+        travelRemainder = 0;
+        phaseTicks = startLatencyMs / TimerWheel::kTickMs;
+        phase = phaseTicks > 0 ? Phase::Starting : Phase::Moving;
+      }
+      break;
+    case Phase::Coasting:
+      // A target further ahead keeps the motor running, anything else only ends the coasting
+      if (closing ? targetPosition > this->position : targetPosition < this->position) {
+        phase = Phase::Moving;
+      }
+      break;
+    case Phase::Moving:
+      // The motor does not reverse mid-travel, a target behind it stops it after coasting
+      break;
+  }
+
+  if (!tickTimer.isPending()) {
+    wheel.schedule(tickTimer, 0, onTick, this, 1);
+  }
+}
+
+uint16_t SimulatedBlindAccessory::getCurrentPosition() { return toPercent(position); }
+
+uint16_t SimulatedBlindAccessory::getTargetPosition() { return target; }
+
+void SimulatedBlindAccessory::identifyYourSelf() {}
+
+void SimulatedBlindAccessory::setReportAppCallback(void (*callback)(void *), void *context) {
+  this->callback = callback;
+  callbackContext = context;
+}
+
+void SimulatedBlindAccessory::setPosition(uint16_t position) {
+  target = position > 100 ? 100 : position;
+  this->position = target * 100u;
+  phase = Phase::Idle;
+}
+
+uint32_t SimulatedBlindAccessory::moveCount() const { return moves; }
+
+uint32_t SimulatedBlindAccessory::motorRunMs() const { return runTicks * TimerWheel::kTickMs; }
+
+void SimulatedBlindAccessory::onTick(void *self) {
+  SimulatedBlindAccessory *blind = static_cast<SimulatedBlindAccessory *>(self);
+  uint16_t previousPercent = toPercent(blind->position);
+
+  switch (blind->phase) {
+    case Phase::Starting:
+      if (--blind->phaseTicks == 0) {
+        blind->phase = Phase::Moving;
+      }
+      break;
+    case Phase::Moving: {
+      blind->runTicks++;
+      blind->step();
+      uint32_t targetPosition = blind->target * 100u;
+      if (blind->closing ? blind->position >= targetPosition : blind->position <= targetPosition) {
+        blind->phaseTicks = blind->stopLatencyMs / TimerWheel::kTickMs;
+        blind->phase = blind->phaseTicks > 0 ? Phase::Coasting : Phase::Idle;
+      }
+      break;
+    }
+    case Phase::Coasting:
+      blind->runTicks++;
+      blind->step();
+      if (--blind->phaseTicks == 0) {
+        blind->phase = Phase::Idle;
+      }
+      break;
+    case Phase::Idle:
+      break;
+  }
+
+  if (blind->phase == Phase::Idle || toPercent(blind->position) != previousPercent) {
+    blind->reportDue = true;
+  }
+  if (blind->reportDue) {
+    blind->reportDue = false;
+    blind->report();
+  }
+  // The report may have started another move
+  if (blind->phase == Phase::Idle && !blind->reportDue) {
+    blind->wheel.cancel(blind->tickTimer);
+  }
+}
+
+void SimulatedBlindAccessory::step() {
+  uint32_t travelMs = closing ? closeMs : openMs;
+  uint32_t units = kFullTravel;
+  if (travelMs > 0) {
+    uint32_t distance = travelRemainder + kFullTravel * TimerWheel::kTickMs;
+    units = distance / travelMs;
+    travelRemainder = distance % travelMs;
+  }
+  if (closing) {
+    position = position + units > kFullTravel ? kFullTravel : position + units;
+  } else {
+    position = units > position ? 0 : position - units;
+  }
+}
+
+void SimulatedBlindAccessory::report() {
+  if (callback != nullptr) {
+    callback(callbackContext);
+  }
+}
@@ -0,0 +1,101 @@
+#ifndef SIMULATED_BLIND_ACCESSORY_HPP
+#define SIMULATED_BLIND_ACCESSORY_HPP
+
+#include <BlindAccessoryInterface.hpp>
+#include <TimerWheel.hpp>
+#include <cstdint>
+
+/**
+ * @class SimulatedBlindAccessory
+ * @brief Deterministic host-side blind motor for WindowDevice calibration and positioning.
+ *
+ * The motor starts after a start latency, travels at the configured speed per direction and
+ * keeps coasting for the stop latency after it reaches its target, like a real blind motor
+ * that overshoots. It runs on a TimerWheel, so a HostTickSource makes every move
+ * reproducible. The accessory reports when a move is accepted, on every whole percent
+ * travelled, and when the motor stops. It is not thread-safe: move it from the task that
+ * advances the wheel.
+ */
+class SimulatedBlindAccessory : public BlindAccessoryInterface {
+ public:
+  /**
+   * @brief Constructor for SimulatedBlindAccessory.
+   *
+   * @param openMs Travel time from fully closed to fully open in milliseconds. Default is 30 s.
+   * @param closeMs Travel time from fully open to fully closed in milliseconds. Default is 30 s.
+   * @param startLatencyMs Delay before the motor moves in milliseconds. Default is 0.
+   * @param stopLatencyMs Coasting time after the target is reached in milliseconds. Default is 0.
+   * @param wheel Wheel the motor runs on. Default is the device wheel.
+   */
+  explicit SimulatedBlindAccessory(uint32_t openMs = 30000, uint32_t closeMs = 30000, uint32_t startLatencyMs = 0,
+                                   uint32_t stopLatencyMs = 0, TimerWheel &wheel = TimerWheel::device());
+
+  /**
+   * @brief Destructor for SimulatedBlindAccessory, stops the motor timer.
+   */
+  ~SimulatedBlindAccessory();
+
+  void moveBlindTo(uint16_t position) override;
+  uint16_t getCurrentPosition() override;
+  uint16_t getTargetPosition() override;
+  void identifyYourSelf() override;
+  void setReportAppCallback(void (*callback)(void *), void *context) override;
+
+  /**
+   * @brief Place the blind without moving the motor.
+   *
+   * @param position Position in percent, 0 is fully open.
+   */
+  void setPosition(uint16_t position);
+
+  /**
+   * @brief Get the number of moves the motor started.
+   *
+   * @return uint32_t Number of motor starts.
+   */
+  uint32_t moveCount() const;
+
+  /**
+   * @brief Get the time the motor ran, coasting included.
+   *
+   * @return uint32_t Motor run time in milliseconds.
+   */
+  uint32_t motorRunMs() const;
+
+ private:
+  enum class Phase : uint8_t {
+    Idle,     /**< Motor stopped. */
+    Starting, /**< Move accepted, waiting for the start latency. */
+    Moving,   /**< Travelling towards the target. */
+    Coasting, /**< Target reached, still moving for the stop latency. */
+  };
+
+  static void onTick(void *self);
+
+  /**
+   * @brief Move by one tick of travel in the current direction, clamped to the end stops.
+   */
+  void step();
+
+  void report();
+
+  uint32_t openMs;             /**< Full travel time when opening. */
+  uint32_t closeMs;            /**< Full travel time when closing. */
+  uint32_t startLatencyMs;     /**< Delay before the motor moves. */
+  uint32_t stopLatencyMs;      /**< Coasting time after the target. */
+  TimerWheel &wheel;           /**< Wheel the motor runs on. */
+  TimerWheel::Timer tickTimer; /**< Periodic motor timer, pending while a move or report is due. */
+  void (*callback)(void *);    /**< Report callback. */
+  void *callbackContext;       /**< Report callback context. */
+  Phase phase;                 /**< Motor phase. */
+  bool closing;                /**< Direction of the move. */
+  bool reportDue;              /**< Whether a report is due on the next tick. */
+  uint32_t phaseTicks;         /**< Remaining ticks of the start latency or the coasting. */
+  uint32_t position;           /**< Position in 1/100 %. */
+  uint32_t travelRemainder;    /**< Sub-unit travel carried between ticks. */
+  uint16_t target;             /**< Target position in percent. */
+  uint32_t moves;              /**< Number of motor starts. */
+  uint32_t runTicks;           /**< Ticks the motor ran. */
+};
+
+#endif  // SIMULATED_BLIND_ACCESSORY_HPP
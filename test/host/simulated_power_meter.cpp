@@ -0,0 +1,36 @@
+#include "simulated_power_meter.hpp"
+
+#include <PowerMeterInterface.hpp>
+#include <cstdint>
+
+SimulatedPowerMeter::SimulatedPowerMeter(int32_t voltage, int32_t activePower)
+    : voltage(voltage), activePower(activePower), rippleAmplitude(0), ripplePeriod(0), online(true), samples(0) {}
+
+bool SimulatedPowerMeter::readSample(uint32_t nowMs, PowerSample &sample) {
+  if (!online) {
+    return false;
+  }
+
+  int32_t power = activePower;
+  if (ripplePeriod > 0) {
+    power += (samples % ripplePeriod) < (ripplePeriod / 2) ? rippleAmplitude : -rippleAmplitude;
+  }
+  samples++;
+
+  sample.timestampMs = nowMs;
+  sample.voltage = voltage;
+  sample.activePower = power;
+  sample.current = voltage == 0 ? 0 : static_cast<int32_t>(static_cast<int64_t>(power) * 1000 / voltage);
+  return true;
+}
+
+void SimulatedPowerMeter::setActivePower(int32_t activePower) { this->activePower = activePower; }
+
+void SimulatedPowerMeter::setRipple(int32_t amplitude, uint32_t periodSamples) {
+  rippleAmplitude = amplitude;
+  ripplePeriod = periodSamples;
+}
+
+void SimulatedPowerMeter::setOnline(bool online) { this->online = online; }
+
+uint32_t SimulatedPowerMeter::sampleCount() const { return samples; }
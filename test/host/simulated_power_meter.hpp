@@ -0,0 +1,77 @@
+#ifndef SIMULATED_POWER_METER_HPP
+#define SIMULATED_POWER_METER_HPP
+
+#include <PowerMeterInterface.hpp>
+#include <cstdint>
+
+/**
+ * @class SimulatedPowerMeter
+ * @brief Deterministic host-side sampling source for PlugInDevice metering.
+ *
+ * Produces a constant voltage and a load that follows the configured power, optionally
+ * with a square ripple, so aggregation and reporting thresholds can be exercised without
+ * a metering chip.
+ */
+class SimulatedPowerMeter : public PowerMeterInterface {
+ public:
+  /**
+   * @brief Constructor for SimulatedPowerMeter.
+   *
+   * @param voltage RMS voltage in mV. Default is 230 V.
+   * @param activePower Active power in mW. Default is 0.
+   */
+  explicit SimulatedPowerMeter(int32_t voltage = 230000, int32_t activePower = 0);
+
+  /**
+   * @brief Default destructor for SimulatedPowerMeter.
+   */
+  ~SimulatedPowerMeter() = default;
+
+  /**
+   * @brief Produce one sample.
+   *
+   * @param nowMs Current time in milliseconds.
+   * @param sample Sample to fill.
+   * @return bool false while the meter is set offline.
+   */
+  bool readSample(uint32_t nowMs, PowerSample &sample) override;
+
+  /**
+   * @brief Set the simulated load.
+   *
+   * @param activePower Active power in mW.
+   */
+  void setActivePower(int32_t activePower);
+
+  /**
+   * @brief Add a square ripple on top of the load.
+   *
+   * @param amplitude Ripple amplitude in mW.
+   * @param periodSamples Number of samples per ripple period.
+   */
+  void setRipple(int32_t amplitude, uint32_t periodSamples);
+
+  /**
+   * @brief Make readSample() fail, to simulate a dead metering chip.
+   *
+   * @param online false to fail every read.
+   */
+  void setOnline(bool online);
+
+  /**
+   * @brief Get the number of samples produced so far.
+   *
+   * @return uint32_t Number of samples.
+   */
+  uint32_t sampleCount() const;
+
+ private:
+  int32_t voltage;         /**< RMS voltage in mV. */
+  int32_t activePower;     /**< Load in mW. */
+  int32_t rippleAmplitude; /**< Ripple amplitude in mW. */
+  uint32_t ripplePeriod;   /**< Ripple period in samples. */
+  bool online;             /**< Whether reads succeed. */
+  uint32_t samples;        /**< Number of samples produced. */
+};
+
+#endif  // SIMULATED_POWER_METER_HPP
@@ -0,0 +1,17 @@
+// Host stand-in for the accessory interface of the accessory component
+#ifndef HOST_BLIND_ACCESSORY_INTERFACE_HPP
+#define HOST_BLIND_ACCESSORY_INTERFACE_HPP
+
+#include <cstdint>
+
+class BlindAccessoryInterface {
+ public:
+  virtual ~BlindAccessoryInterface() = default;
+  virtual void moveBlindTo(uint16_t position) = 0;
+  virtual uint16_t getCurrentPosition() = 0;
+  virtual uint16_t getTargetPosition() = 0;
+  virtual void identifyYourSelf() = 0;
+  virtual void setReportAppCallback(void (*callback)(void *), void *context) = 0;
+};
+
+#endif  // HOST_BLIND_ACCESSORY_INTERFACE_HPP
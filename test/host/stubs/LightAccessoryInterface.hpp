@@ -0,0 +1,14 @@
+// Host stand-in for the accessory interface of the accessory component
+#ifndef HOST_LIGHT_ACCESSORY_INTERFACE_HPP
+#define HOST_LIGHT_ACCESSORY_INTERFACE_HPP
+
+class LightAccessoryInterface {
+ public:
+  virtual ~LightAccessoryInterface() = default;
+  virtual void setPower(bool power) = 0;
+  virtual bool getPower() = 0;
+  virtual void identifyYourSelf() = 0;
+  virtual void setReportAppCallback(void (*callback)(void *), void *context) = 0;
+};
+
+#endif  // HOST_LIGHT_ACCESSORY_INTERFACE_HPP
@@ -0,0 +1,14 @@
+// Host stand-in for the accessory interface of the accessory component
+#ifndef HOST_STATELESS_BUTTON_ACCESSORY_INTERFACE_HPP
+#define HOST_STATELESS_BUTTON_ACCESSORY_INTERFACE_HPP
+
+class StatelessButtonAccessoryInterface {
+ public:
+  enum class PressType { SinglePress, DoublePress, LongPress };
+  virtual ~StatelessButtonAccessoryInterface() = default;
+  virtual PressType getLastPressType() = 0;
+  virtual void identifyYourSelf() = 0;
+  virtual void setReportAppCallback(void (*callback)(void *), void *context) = 0;
+};
+
+#endif  // HOST_STATELESS_BUTTON_ACCESSORY_INTERFACE_HPP
@@ -0,0 +1,54 @@
+// Host stand-in for the Electrical Energy Measurement server, implemented by fake_esp_matter.cpp
+#ifndef HOST_ELECTRICAL_ENERGY_MEASUREMENT_SERVER_H
+#define HOST_ELECTRICAL_ENERGY_MEASUREMENT_SERVER_H
+
+#include <esp_matter.h>
+
+#include <cstdint>
+
+namespace chip {
+
+struct NullOptionalType {};
+constexpr NullOptionalType NullOptional{};
+
+template <typename T>
+class Optional {
+ public:
+  Optional() : value(), present(false) {}
+  Optional(NullOptionalType) : value(), present(false) {}
+  explicit Optional(const T &value) : value(value), present(true) {}
+  bool HasValue() const { return present; }
+  const T &Value() const { return value; }
+
+ private:
+  T value;
+  bool present;
+};
+
+template <typename T>
+Optional<T> MakeOptional(const T &value) {
+  return Optional<T>(value);
+}
+
+namespace app {
+namespace Clusters {
+namespace ElectricalEnergyMeasurement {
+
+namespace Structs {
+namespace EnergyMeasurementStruct {
+struct Type {
+  int64_t energy = 0;
+};
+}  // namespace EnergyMeasurementStruct
+}  // namespace Structs
+
+bool NotifyCumulativeEnergyMeasured(uint16_t endpointId,
+                                    const Optional<Structs::EnergyMeasurementStruct::Type> &energyImported,
+                                    const Optional<Structs::EnergyMeasurementStruct::Type> &energyExported);
+
+}  // namespace ElectricalEnergyMeasurement
+}  // namespace Clusters
+}  // namespace app
+}  // namespace chip
+
+#endif  // HOST_ELECTRICAL_ENERGY_MEASUREMENT_SERVER_H
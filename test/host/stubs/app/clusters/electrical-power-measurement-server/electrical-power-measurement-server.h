@@ -0,0 +1,113 @@
+// Host stand-in for the Electrical Power Measurement server, only the delegate interface
+#ifndef HOST_ELECTRICAL_POWER_MEASUREMENT_SERVER_H
+#define HOST_ELECTRICAL_POWER_MEASUREMENT_SERVER_H
+
+#include <esp_matter.h>
+
+#include <cstdint>
+
+namespace chip {
+
+struct ChipError {
+  int code;
+  bool operator==(const ChipError &other) const { return code == other.code; }
+  bool operator!=(const ChipError &other) const { return code != other.code; }
+};
+
+typedef uint16_t EndpointId;
+
+namespace app {
+namespace DataModel {
+
+template <typename T>
+class Nullable {
+ public:
+  Nullable() : value(), null(true) {}
+  Nullable(T value) : value(value), null(false) {}
+  bool IsNull() const { return null; }
+  const T &Value() const { return value; }
+
+ private:
+  T value;
+  bool null;
+};
+
+}  // namespace DataModel
+
+namespace Clusters {
+namespace ElectricalPowerMeasurement {
+
+enum class PowerModeEnum : uint8_t { kUnknown = 0, kDc = 1, kAc = 2 };
+
+namespace Structs {
+namespace MeasurementAccuracyStruct {
+struct Type {};
+}  // namespace MeasurementAccuracyStruct
+namespace MeasurementRangeStruct {
+struct Type {};
+}  // namespace MeasurementRangeStruct
+namespace HarmonicMeasurementStruct {
+struct Type {};
+}  // namespace HarmonicMeasurementStruct
+}  // namespace Structs
+
+}  // namespace ElectricalPowerMeasurement
+}  // namespace Clusters
+}  // namespace app
+}  // namespace chip
+
+typedef chip::ChipError CHIP_ERROR;
+#define CHIP_NO_ERROR (chip::ChipError{0})
+#define CHIP_ERROR_PROVIDER_LIST_EXHAUSTED (chip::ChipError{0x5c})
+
+namespace chip {
+namespace app {
+namespace Clusters {
+namespace ElectricalPowerMeasurement {
+
+class Delegate {
+ public:
+  virtual ~Delegate() = default;
+
+  void SetEndpointId(EndpointId endpointId) { mEndpointId = endpointId; }
+
+  virtual PowerModeEnum GetPowerMode() = 0;
+  virtual uint8_t GetNumberOfMeasurementTypes() = 0;
+  virtual CHIP_ERROR StartAccuracyRead() = 0;
+  virtual CHIP_ERROR GetAccuracyByIndex(uint8_t index, Structs::MeasurementAccuracyStruct::Type &accuracy) = 0;
+  virtual CHIP_ERROR EndAccuracyRead() = 0;
+  virtual CHIP_ERROR StartRangesRead() = 0;
+  virtual CHIP_ERROR GetRangeByIndex(uint8_t index, Structs::MeasurementRangeStruct::Type &range) = 0;
+  virtual CHIP_ERROR EndRangesRead() = 0;
+  virtual CHIP_ERROR StartHarmonicCurrentsRead() = 0;
+  virtual CHIP_ERROR GetHarmonicCurrentsByIndex(uint8_t index,
+                                                Structs::HarmonicMeasurementStruct::Type &harmonic) = 0;
+  virtual CHIP_ERROR EndHarmonicCurrentsRead() = 0;
+  virtual CHIP_ERROR StartHarmonicPhasesRead() = 0;
+  virtual CHIP_ERROR GetHarmonicPhasesByIndex(uint8_t index, Structs::HarmonicMeasurementStruct::Type &harmonic) = 0;
+  virtual CHIP_ERROR EndHarmonicPhasesRead() = 0;
+
+  virtual DataModel::Nullable<int64_t> GetVoltage() = 0;
+  virtual DataModel::Nullable<int64_t> GetActiveCurrent() = 0;
+  virtual DataModel::Nullable<int64_t> GetReactiveCurrent() = 0;
+  virtual DataModel::Nullable<int64_t> GetApparentCurrent() = 0;
+  virtual DataModel::Nullable<int64_t> GetActivePower() = 0;
+  virtual DataModel::Nullable<int64_t> GetReactivePower() = 0;
+  virtual DataModel::Nullable<int64_t> GetApparentPower() = 0;
+  virtual DataModel::Nullable<int64_t> GetRMSVoltage() = 0;
+  virtual DataModel::Nullable<int64_t> GetRMSCurrent() = 0;
+  virtual DataModel::Nullable<int64_t> GetRMSPower() = 0;
+  virtual DataModel::Nullable<int64_t> GetFrequency() = 0;
+  virtual DataModel::Nullable<int64_t> GetPowerFactor() = 0;
+  virtual DataModel::Nullable<int64_t> GetNeutralCurrent() = 0;
+
+ protected:
+  EndpointId mEndpointId = 0;
+};
+
+}  // namespace ElectricalPowerMeasurement
+}  // namespace Clusters
+}  // namespace app
+}  // namespace chip
+
+#endif  // HOST_ELECTRICAL_POWER_MEASUREMENT_SERVER_H
@@ -0,0 +1,9 @@
+// Host stand-in for the attribute change notification, implemented by fake_esp_matter.cpp
+#ifndef HOST_REPORTING_H
+#define HOST_REPORTING_H
+
+#include <cstdint>
+
+void MatterReportingAttributeChangeCallback(uint16_t endpoint, uint32_t clusterId, uint32_t attributeId);
+
+#endif  // HOST_REPORTING_H
@@ -0,0 +1,16 @@
+// Host stand-in for the ESP-IDF log macros, warnings and errors go to stderr
+#ifndef HOST_ESP_LOG_H
+#define HOST_ESP_LOG_H
+
+#include <cstdio>
+
+#ifndef __FILENAME__
+#define __FILENAME__ __FILE__
+#endif
+
+#define ESP_LOGE(tag, format, ...) fprintf(stderr, "E %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) fprintf(stderr, "W %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ((void)(tag))
+#define ESP_LOGD(tag, format, ...) ((void)(tag))
+
+#endif  // HOST_ESP_LOG_H
@@ -0,0 +1,265 @@
+// Host stand-in for the part of esp_matter used by the device layer. The functions are
+// implemented by fake_esp_matter.cpp on an in-memory attribute store.
+#ifndef HOST_ESP_MATTER_H
+#define HOST_ESP_MATTER_H
+
+#include <esp_err.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifndef portMAX_DELAY
+#define portMAX_DELAY 0xffffffffu
+#endif
+
+template <typename T>
+struct nullable {
+  nullable() : value(), null(true) {}
+  nullable(T value) : value(value), null(false) {}
+  T value;
+  bool null;
+};
+
+typedef enum {
+  ESP_MATTER_VAL_TYPE_INVALID = 0,
+  ESP_MATTER_VAL_TYPE_BOOLEAN,
+  ESP_MATTER_VAL_TYPE_INTEGER,
+  ESP_MATTER_VAL_TYPE_CHAR_STRING,
+  ESP_MATTER_VAL_TYPE_LONG_CHAR_STRING,
+  ESP_MATTER_VAL_TYPE_OCTET_STRING,
+  ESP_MATTER_VAL_TYPE_LONG_OCTET_STRING,
+  ESP_MATTER_VAL_TYPE_ARRAY,
+  ESP_MATTER_VAL_TYPE_UINT8,
+  ESP_MATTER_VAL_TYPE_INT16,
+  ESP_MATTER_VAL_TYPE_UINT16,
+  ESP_MATTER_VAL_TYPE_INT64,
+  ESP_MATTER_VAL_TYPE_ENUM8,
+  ESP_MATTER_VAL_TYPE_BITMAP8,
+  ESP_MATTER_VAL_TYPE_NULLABLE_UINT8,
+  ESP_MATTER_VAL_TYPE_NULLABLE_INT16,
+  ESP_MATTER_VAL_TYPE_NULLABLE_UINT16,
+  ESP_MATTER_VAL_TYPE_NULLABLE_INT64,
+} esp_matter_val_type_t;
+
+typedef union {
+  bool b;
+  uint8_t u8;
+  int16_t i16;
+  uint16_t u16;
+  int64_t i64;
+  struct {
+    uint8_t *b;
+    uint16_t s;
+  } a;
+} esp_matter_val_t;
+
+typedef struct {
+  esp_matter_val_type_t type;
+  esp_matter_val_t val;
+} esp_matter_attr_val_t;
+
+#define HOST_ESP_MATTER_VAL(name, ctype, member, tag)     \
+  inline esp_matter_attr_val_t name(ctype value) {         \
+    esp_matter_attr_val_t attr_val = {};                   \
+    attr_val.type = tag;                                   \
+    attr_val.val.member = value;                           \
+    return attr_val;                                       \
+  }
+#define HOST_ESP_MATTER_NULLABLE(name, ctype, member, tag) \
+  inline esp_matter_attr_val_t name(nullable<ctype> value) { \
+    esp_matter_attr_val_t attr_val = {};                   \
+    attr_val.type = tag;                                   \
+    attr_val.val.member = value.value;                     \
+    return attr_val;                                       \
+  }
+HOST_ESP_MATTER_VAL(esp_matter_bool, bool, b, ESP_MATTER_VAL_TYPE_BOOLEAN)
+HOST_ESP_MATTER_VAL(esp_matter_uint8, uint8_t, u8, ESP_MATTER_VAL_TYPE_UINT8)
+HOST_ESP_MATTER_VAL(esp_matter_enum8, uint8_t, u8, ESP_MATTER_VAL_TYPE_ENUM8)
+HOST_ESP_MATTER_VAL(esp_matter_bitmap8, uint8_t, u8, ESP_MATTER_VAL_TYPE_BITMAP8)
+HOST_ESP_MATTER_VAL(esp_matter_uint16, uint16_t, u16, ESP_MATTER_VAL_TYPE_UINT16)
+HOST_ESP_MATTER_VAL(esp_matter_int16, int16_t, i16, ESP_MATTER_VAL_TYPE_INT16)
+HOST_ESP_MATTER_NULLABLE(esp_matter_nullable_uint8, uint8_t, u8, ESP_MATTER_VAL_TYPE_NULLABLE_UINT8)
+HOST_ESP_MATTER_NULLABLE(esp_matter_nullable_int16, int16_t, i16, ESP_MATTER_VAL_TYPE_NULLABLE_INT16)
+HOST_ESP_MATTER_NULLABLE(esp_matter_nullable_uint16, uint16_t, u16, ESP_MATTER_VAL_TYPE_NULLABLE_UINT16)
+HOST_ESP_MATTER_NULLABLE(esp_matter_nullable_int64, int64_t, i64, ESP_MATTER_VAL_TYPE_NULLABLE_INT64)
+#undef HOST_ESP_MATTER_VAL
+#undef HOST_ESP_MATTER_NULLABLE
+
+// Cluster and attribute ids of the Matter specification
+#define HOST_CLUSTER(name, id, ...)              \
+  namespace name {                               \
+  static constexpr uint32_t Id = id;             \
+  namespace Attributes {                         \
+  __VA_ARGS__                                    \
+  }                                              \
+  }
+#define HOST_ATTRIBUTE(name, id) \
+  namespace name {               \
+  static constexpr uint32_t Id = id; \
+  }
+namespace chip {
+namespace app {
+namespace Clusters {
+HOST_CLUSTER(Identify, 0x0003, HOST_ATTRIBUTE(IdentifyTime, 0x0000))
+HOST_CLUSTER(OnOff, 0x0006, HOST_ATTRIBUTE(OnOff, 0x0000))
+HOST_CLUSTER(LevelControl, 0x0008, HOST_ATTRIBUTE(CurrentLevel, 0x0000) HOST_ATTRIBUTE(RemainingTime, 0x0001)
+                                       HOST_ATTRIBUTE(OnOffTransitionTime, 0x0010))
+HOST_CLUSTER(BridgedDeviceBasicInformation, 0x0039, HOST_ATTRIBUTE(NodeLabel, 0x0005) HOST_ATTRIBUTE(Reachable, 0x0011))
+HOST_CLUSTER(Switch, 0x003B, HOST_ATTRIBUTE(CurrentPosition, 0x0001))
+HOST_CLUSTER(ElectricalPowerMeasurement, 0x0090, HOST_ATTRIBUTE(Voltage, 0x0004) HOST_ATTRIBUTE(ActiveCurrent, 0x0005)
+                                                     HOST_ATTRIBUTE(ActivePower, 0x0008))
+HOST_CLUSTER(ElectricalEnergyMeasurement, 0x0091, HOST_ATTRIBUTE(CumulativeEnergyImported, 0x0001))
+HOST_CLUSTER(PowerTopology, 0x009C, HOST_ATTRIBUTE(AvailableEndpoints, 0x0000))
+HOST_CLUSTER(WindowCovering, 0x0102, HOST_ATTRIBUTE(OperationalStatus, 0x000A)
+                                         HOST_ATTRIBUTE(TargetPositionLiftPercent100ths, 0x000B)
+                                             HOST_ATTRIBUTE(CurrentPositionLiftPercent100ths, 0x000E))
+HOST_CLUSTER(FanControl, 0x0202, HOST_ATTRIBUTE(FanMode, 0x0000) HOST_ATTRIBUTE(PercentSetting, 0x0002)
+                                     HOST_ATTRIBUTE(PercentCurrent, 0x0003))
+HOST_CLUSTER(TemperatureMeasurement, 0x0402, HOST_ATTRIBUTE(MeasuredValue, 0x0000))
+HOST_CLUSTER(RelativeHumidityMeasurement, 0x0405, HOST_ATTRIBUTE(MeasuredValue, 0x0000))
+HOST_CLUSTER(OccupancySensing, 0x0406, HOST_ATTRIBUTE(Occupancy, 0x0000))
+}  // namespace Clusters
+}  // namespace app
+}  // namespace chip
+#undef HOST_CLUSTER
+#undef HOST_ATTRIBUTE
+
+namespace esp_matter {
+
+struct node_t;
+struct endpoint_t;
+struct cluster_t;
+struct attribute_t;
+
+namespace endpoint_flags {
+enum { ENDPOINT_FLAG_NONE = 0x00, ENDPOINT_FLAG_DESTROYABLE = 0x01, ENDPOINT_FLAG_BRIDGE = 0x02 };
+}
+namespace cluster_flags {
+enum { CLUSTER_FLAG_NONE = 0x00, CLUSTER_FLAG_SERVER = 0x02 };
+}
+
+namespace node {
+node_t *get();
+}
+
+namespace lock {
+typedef enum { FAILED, ALREADY_TAKEN, SUCCESS } status_t;
+status_t chip_stack_lock(uint32_t ticks_to_wait);
+esp_err_t chip_stack_unlock();
+}  // namespace lock
+
+namespace attribute {
+attribute_t *get(cluster_t *cluster, uint32_t attribute_id);
+attribute_t *get(uint16_t endpoint_id, uint32_t cluster_id, uint32_t attribute_id);
+esp_err_t get_val(attribute_t *attribute, esp_matter_attr_val_t *val);
+esp_err_t set_val(attribute_t *attribute, esp_matter_attr_val_t *val);
+esp_err_t report(uint16_t endpoint_id, uint32_t cluster_id, uint32_t attribute_id, esp_matter_attr_val_t *val);
+}  // namespace attribute
+
+namespace cluster {
+cluster_t *get(endpoint_t *endpoint, uint32_t cluster_id);
+
+#define HOST_FEATURE(name)                  \
+  namespace name {                          \
+  esp_err_t add(cluster_t *cluster);        \
+  }
+#define HOST_FEATURE_CONFIG(name, ...)                    \
+  namespace name {                                        \
+  struct config_t {                                       \
+    __VA_ARGS__                                           \
+  };                                                      \
+  esp_err_t add(cluster_t *cluster, config_t *config);    \
+  }
+#define HOST_CLUSTER_CONFIG(name, ...)                                              \
+  struct config_t {                                                                 \
+    __VA_ARGS__                                                                     \
+  };                                                                                \
+  cluster_t *create(endpoint_t *endpoint, config_t *config, uint8_t flags);
+
+namespace bridged_device_basic_information {
+namespace attribute {
+attribute_t *create_node_label(cluster_t *cluster, const char *value, uint16_t length);
+}
+}  // namespace bridged_device_basic_information
+
+namespace window_covering {
+namespace feature {
+HOST_FEATURE_CONFIG(lift, uint16_t number_of_actuations_lift = 0;)
+HOST_FEATURE_CONFIG(position_aware_lift, nullable<uint8_t> current_position_lift_percentage;
+                    nullable<uint16_t> target_position_lift_percent_100ths;
+                    nullable<uint16_t> current_position_lift_percent_100ths;)
+HOST_FEATURE_CONFIG(absolute_position, uint16_t physical_closed_limit_lift = 0;)
+}  // namespace feature
+}  // namespace window_covering
+
+namespace switch_cluster {
+namespace feature {
+HOST_FEATURE(momentary_switch)
+HOST_FEATURE(momentary_switch_release)
+HOST_FEATURE(momentary_switch_long_press)
+HOST_FEATURE_CONFIG(momentary_switch_multi_press, uint8_t multi_press_max = 2;)
+}  // namespace feature
+namespace event {
+esp_err_t send_initial_press(uint16_t endpoint_id, uint8_t new_position);
+esp_err_t send_long_press(uint16_t endpoint_id, uint8_t new_position);
+esp_err_t send_multi_press_complete(uint16_t endpoint_id, uint8_t previous_position, uint8_t count);
+}  // namespace event
+}  // namespace switch_cluster
+
+namespace electrical_power_measurement {
+HOST_CLUSTER_CONFIG(electrical_power_measurement, void *delegate = nullptr;)
+namespace feature {
+HOST_FEATURE(alternating_current)
+}
+}  // namespace electrical_power_measurement
+
+namespace electrical_energy_measurement {
+HOST_CLUSTER_CONFIG(electrical_energy_measurement, void *delegate = nullptr;)
+namespace feature {
+HOST_FEATURE(imported_energy)
+HOST_FEATURE(cumulative_energy)
+}  // namespace feature
+}  // namespace electrical_energy_measurement
+
+namespace power_topology {
+HOST_CLUSTER_CONFIG(power_topology, void *delegate = nullptr;)
+namespace feature {
+HOST_FEATURE(node_topology)
+}
+}  // namespace power_topology
+
+#undef HOST_FEATURE
+#undef HOST_FEATURE_CONFIG
+#undef HOST_CLUSTER_CONFIG
+}  // namespace cluster
+
+namespace endpoint {
+endpoint_t *create(node_t *node, uint8_t flags, void *priv_data);
+uint16_t get_id(endpoint_t *endpoint);
+esp_err_t set_parent_endpoint(endpoint_t *endpoint, endpoint_t *parent_endpoint);
+
+#define HOST_DEVICE_TYPE(name)                                                              \
+  namespace name {                                                                          \
+  struct config_t {                                                                         \
+    uint8_t unused = 0;                                                                     \
+  };                                                                                        \
+  endpoint_t *create(node_t *node, config_t *config, uint8_t flags, void *priv_data);       \
+  esp_err_t add(endpoint_t *endpoint, config_t *config);                                    \
+  }
+HOST_DEVICE_TYPE(bridged_node)
+HOST_DEVICE_TYPE(on_off_light)
+HOST_DEVICE_TYPE(dimmable_light)
+HOST_DEVICE_TYPE(fan)
+HOST_DEVICE_TYPE(window_covering_device)
+HOST_DEVICE_TYPE(generic_switch)
+HOST_DEVICE_TYPE(on_off_plugin_unit)
+HOST_DEVICE_TYPE(temperature_sensor)
+HOST_DEVICE_TYPE(humidity_sensor)
+HOST_DEVICE_TYPE(occupancy_sensor)
+#undef HOST_DEVICE_TYPE
+}  // namespace endpoint
+
+}  // namespace esp_matter
+
+#endif  // HOST_ESP_MATTER_H
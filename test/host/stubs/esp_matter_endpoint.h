@@ -0,0 +1,2 @@
+// Host stand-in, the device types are declared by esp_matter.h
+#include <esp_matter.h>
@@ -0,0 +1,44 @@
+// Host stand-in for the partition API, the host has no partitions so nothing is ever found
+#ifndef HOST_ESP_PARTITION_H
+#define HOST_ESP_PARTITION_H
+
+#include <esp_err.h>
+
+#include <cstddef>
+#include <cstdint>
+
+typedef uint32_t esp_partition_mmap_handle_t;
+
+typedef enum {
+  ESP_PARTITION_TYPE_APP = 0x00,
+  ESP_PARTITION_TYPE_DATA = 0x01,
+} esp_partition_type_t;
+
+typedef enum {
+  ESP_PARTITION_SUBTYPE_ANY = 0xff,
+} esp_partition_subtype_t;
+
+typedef enum {
+  ESP_PARTITION_MMAP_DATA,
+  ESP_PARTITION_MMAP_INST,
+} esp_partition_mmap_memory_t;
+
+typedef struct {
+  esp_partition_type_t type;
+  uint32_t address;
+  uint32_t size;
+  char label[17];
+} esp_partition_t;
+
+inline const esp_partition_t *esp_partition_find_first(esp_partition_type_t, esp_partition_subtype_t, const char *) {
+  return nullptr;
+}
+
+inline esp_err_t esp_partition_mmap(const esp_partition_t *, size_t, size_t, esp_partition_mmap_memory_t,
+                                    const void **, esp_partition_mmap_handle_t *) {
+  return ESP_ERR_NOT_FOUND;
+}
+
+inline void esp_partition_munmap(esp_partition_mmap_handle_t) {}
+
+#endif  // HOST_ESP_PARTITION_H
@@ -0,0 +1,4 @@
+// Host stand-in, the device layer does not use GPIOs directly
+#ifndef HOST_HAL_GPIO_TYPES_H
+#define HOST_HAL_GPIO_TYPES_H
+#endif  // HOST_HAL_GPIO_TYPES_H
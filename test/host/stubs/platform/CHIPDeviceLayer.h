@@ -0,0 +1,30 @@
+// Host stand-in for the CHIP platform manager, scheduled work runs inline
+#ifndef HOST_CHIP_DEVICE_LAYER_H
+#define HOST_CHIP_DEVICE_LAYER_H
+
+#include <app/clusters/electrical-power-measurement-server/electrical-power-measurement-server.h>
+
+#include <cstdint>
+
+namespace chip {
+namespace DeviceLayer {
+
+typedef void (*AsyncWorkFunct)(intptr_t arg);
+
+class PlatformManager {
+ public:
+  CHIP_ERROR ScheduleWork(AsyncWorkFunct function, intptr_t arg = 0) {
+    function(arg);
+    return CHIP_NO_ERROR;
+  }
+};
+
+inline PlatformManager &PlatformMgr() {
+  static PlatformManager manager;
+  return manager;
+}
+
+}  // namespace DeviceLayer
+}  // namespace chip
+
+#endif  // HOST_CHIP_DEVICE_LAYER_H
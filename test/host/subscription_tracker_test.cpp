@@ -0,0 +1,126 @@
+// SubscriptionTracker interest counting and deferred reports.
+//
+// Before a source is attached every path is watched. Once attached, a change of an unwatched
+// path only updates the store and marks the device deferred; the subscription that makes the
+// path watched flushes the device from the wheel. Paths count subscribers, wildcards match any
+// endpoint, and a full interest table makes every path watched until the overflow is gone.
+
+#include <fake_accessories.hpp>
+#include <fake_esp_matter.hpp>
+
+#include <HostTickSource.hpp>
+#include <LightDevice.hpp>
+#include <SubscriptionTracker.hpp>
+#include <TimerWheel.hpp>
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+
+namespace OnOff = chip::app::Clusters::OnOff;
+
+constexpr uint16_t kOtherEndpoint = 0x7F00;
+
+bool expect(bool condition, const char *what) {
+  if (!condition) printf("FAILED: %s\n", what);
+  return condition;
+}
+
+// Source the test drives by hand
+class MockEventSource : public SubscriptionEventSource {
+ public:
+  esp_err_t setListener(Listener listener, void *context) override {
+    this->listener = listener;
+    this->context = context;
+    return ESP_OK;
+  }
+
+  void emit(uint16_t endpointId, uint32_t clusterId, bool subscribed) {
+    listener(context, endpointId, clusterId, subscribed);
+  }
+
+ private:
+  Listener listener = nullptr;
+  void *context = nullptr;
+};
+
+}  // namespace
+
+int main() {
+  HostTickSource ticks;
+  ticks.start();
+  SubscriptionTracker &tracker = SubscriptionTracker::instance();
+  MockEventSource source;
+  bool ok = true;
+
+  ok = expect(tracker.hasInterest(kOtherEndpoint, OnOff::Id), "every path watched before attach") && ok;
+  ok = expect(tracker.attach(source) == ESP_OK, "source attached") && ok;
+  ok = expect(!tracker.hasInterest(kOtherEndpoint, OnOff::Id), "no interest once attached") && ok;
+
+  esp_matter::endpoint::bridged_node::config_t config;
+  esp_matter::endpoint_t *aggregator =
+      esp_matter::endpoint::bridged_node::create(esp_matter::node::get(), &config, 0, nullptr);
+  FakeLight light;
+  LightDevice device("light", &light, aggregator);
+  uint16_t endpointId = 0;
+  device.getEndpointIds(&endpointId, 1);
+  uint32_t reports = fake_esp_matter::reports(endpointId, OnOff::Id, OnOff::Attributes::OnOff::Id);
+
+  // An unwatched change updates the store only
+  light.power = true;
+  light.report();
+  ok = expect(fake_esp_matter::read(endpointId, OnOff::Id, OnOff::Attributes::OnOff::Id).val.b,
+              "unwatched change stored") &&
+       ok;
+  ok = expect(fake_esp_matter::reports(endpointId, OnOff::Id, OnOff::Attributes::OnOff::Id) == reports,
+              "unwatched change not reported") &&
+       ok;
+  ok = expect(device.isReportDeferred() && tracker.deferredReports() == 1, "deferred report counted") && ok;
+
+  // The subscription flushes the device from the wheel, not from the event
+  source.emit(endpointId, OnOff::Id, true);
+  ok = expect(device.isReportDeferred(), "flush waits for the wheel") && ok;
+  ticks.advanceTicks(1);
+  ok = expect(!device.isReportDeferred(), "deferred flag cleared by the flush") && ok;
+  ok = expect(fake_esp_matter::reports(endpointId, OnOff::Id, OnOff::Attributes::OnOff::Id) == reports + 1,
+              "flush reported the endpoint") &&
+       ok;
+
+  // A watched change goes through the reporting engine
+  light.power = false;
+  light.report();
+  ok = expect(fake_esp_matter::reports(endpointId, OnOff::Id, OnOff::Attributes::OnOff::Id) == reports + 2,
+              "watched change reported") &&
+       ok;
+  ok = expect(!device.isReportDeferred() && tracker.deferredReports() == 1, "watched change not deferred") && ok;
+
+  // Subscribers are counted per path
+  source.emit(endpointId, OnOff::Id, true);
+  source.emit(endpointId, OnOff::Id, false);
+  ok = expect(tracker.hasInterest(endpointId, OnOff::Id), "interest kept while a subscriber remains") && ok;
+  source.emit(endpointId, OnOff::Id, false);
+  ok = expect(!tracker.hasInterest(endpointId, OnOff::Id), "interest dropped with the last subscriber") && ok;
+
+  // Wildcard endpoint
+  source.emit(SubscriptionTracker::kAnyEndpoint, OnOff::Id, true);
+  ok = expect(tracker.hasInterest(kOtherEndpoint, OnOff::Id), "wildcard endpoint matches any endpoint") && ok;
+  ok = expect(!tracker.hasInterest(kOtherEndpoint, OnOff::Id + 1), "wildcard endpoint keeps the cluster") && ok;
+  source.emit(SubscriptionTracker::kAnyEndpoint, OnOff::Id, false);
+
+  // One more path than the table holds makes every path watched until it goes away
+  for (uint16_t i = 0; i <= SubscriptionTracker::kMaxInterests; i++) {
+    source.emit(i, OnOff::Id + 1, true);
+  }
+  ok = expect(tracker.hasInterest(kOtherEndpoint, OnOff::Id), "overflow watches every path") && ok;
+  source.emit(SubscriptionTracker::kMaxInterests, OnOff::Id + 1, false);
+  ok = expect(!tracker.hasInterest(kOtherEndpoint, OnOff::Id), "overflow cleared by the unsubscribe") && ok;
+  ok = expect(tracker.hasInterest(0, OnOff::Id + 1), "table entries kept after the overflow") && ok;
+  for (uint16_t i = 0; i < SubscriptionTracker::kMaxInterests; i++) {
+    source.emit(i, OnOff::Id + 1, false);
+  }
+  ticks.advanceTicks(1);
+
+  ticks.stop();
+  printf("%s\n", ok ? "subscription tracker tests passed" : "subscription tracker tests failed");
+  return ok ? 0 : 1;
+}
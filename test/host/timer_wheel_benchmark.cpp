@@ -0,0 +1,248 @@
+// Compares the shared TimerWheel with one software timer object per device.
+//
+// The per-object baseline models a FreeRTOS/esp_timer style timer service: every timer is a
+// separate heap object kept in a list sorted by expiry, so arming is O(n) and every timer
+// costs an allocation. Both run the same deterministic workload: arm every timer, disarm a
+// quarter of them, then tick until all remaining timers fired. The run fails if a timer fires
+// twice, fires late, or never fires; the timings are printed for comparison. cancelAndWait()
+// must also hold back an owner until a callback running on the tick thread returned.
+
+#include <HostTickSource.hpp>
+#include <TimerWheel.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kTimers = 2000;
+constexpr uint32_t kMaxDelayTicks = 6000;
+
+// Deterministic delays, the same for both implementations
+uint32_t delayOf(uint32_t index) { return 1 + (index * 2654435761u >> 7) % kMaxDelayTicks; }
+
+bool cancelled(uint32_t index) { return index % 4 == 3; }
+
+struct Expectation {
+  uint64_t dueTick; /**< Tick the timer must fire on. */
+  uint32_t fired;   /**< Number of times it fired. */
+  bool late;        /**< Whether it fired on another tick. */
+};
+
+struct ObjectTimer {
+  ObjectTimer *next;
+  ObjectTimer *prev;
+  uint64_t expiry;
+  void (*callback)(void *);
+  void *context;
+};
+
+// Sorted doubly linked list of heap timers, one allocation per timer
+class ObjectTimerService {
+ public:
+  ObjectTimerService() : head(nullptr), tick(0) {}
+
+  ObjectTimer *create(void (*callback)(void *), void *context) {
+    return new ObjectTimer{nullptr, nullptr, 0, callback, context};
+  }
+
+  void destroy(ObjectTimer *timer) {
+    stop(timer);
+    delete timer;
+  }
+
+  void start(ObjectTimer *timer, uint32_t delayTicks) {
+    timer->expiry = tick + delayTicks;
+    ObjectTimer **link = &head;
+    ObjectTimer *prev = nullptr;
+    while (*link != nullptr && (*link)->expiry <= timer->expiry) {
+      prev = *link;
+      link = &(*link)->next;
+    }
+    timer->next = *link;
+    timer->prev = prev;
+    if (*link != nullptr) (*link)->prev = timer;
+    *link = timer;
+  }
+
+  void stop(ObjectTimer *timer) {
+    if (timer->prev == nullptr && head != timer) return;
+    if (timer->prev != nullptr) timer->prev->next = timer->next;
+    else head = timer->next;
+    if (timer->next != nullptr) timer->next->prev = timer->prev;
+    timer->next = timer->prev = nullptr;
+  }
+
+  void advance() {
+    tick++;
+    while (head != nullptr && head->expiry <= tick) {
+      ObjectTimer *timer = head;
+      stop(timer);
+      timer->callback(timer->context);
+    }
+  }
+
+  uint64_t now() const { return tick; }
+
+ private:
+  ObjectTimer *head;
+  uint64_t tick;
+};
+
+struct Context {
+  Expectation *expectation;
+  uint64_t (*now)(void *clock);
+  void *clock;
+};
+
+void onFire(void *context) {
+  Context *ctx = static_cast<Context *>(context);
+  ctx->expectation->fired++;
+  if (ctx->now(ctx->clock) != ctx->expectation->dueTick) ctx->expectation->late = true;
+}
+
+bool verify(const char *name, const std::vector<Expectation> &expectations) {
+  for (uint32_t i = 0; i < kTimers; i++) {
+    uint32_t want = cancelled(i) ? 0 : 1;
+    if (expectations[i].fired != want || expectations[i].late) {
+      printf("%s: timer %u fired %u times%s\n", name, static_cast<unsigned>(i),
+             static_cast<unsigned>(expectations[i].fired), expectations[i].late ? ", late" : "");
+      return false;
+    }
+  }
+  return true;
+}
+
+double elapsedUs(std::chrono::steady_clock::time_point since) {
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - since).count();
+}
+
+bool runWheel() {
+  TimerWheel wheel;
+  HostTickSource ticks(wheel);
+  ticks.start();
+  std::vector<Expectation> expectations(kTimers);
+  std::vector<Context> contexts(kTimers);
+  std::vector<TimerWheel::Timer> timers(kTimers);
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < kTimers; i++) {
+    expectations[i] = {delayOf(i), 0, false};
+    contexts[i] = {&expectations[i], [](void *clock) { return static_cast<TimerWheel *>(clock)->now(); }, &wheel};
+    wheel.schedule(timers[i], delayOf(i), onFire, &contexts[i]);
+  }
+  double armUs = elapsedUs(start);
+  start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < kTimers; i++) {
+    if (cancelled(i)) wheel.cancel(timers[i]);
+  }
+  double cancelUs = elapsedUs(start);
+  start = std::chrono::steady_clock::now();
+  for (uint32_t tick = 0; tick < kMaxDelayTicks; tick++) {
+    ticks.advanceTicks(1);
+  }
+  double runUs = elapsedUs(start);
+
+  printf("wheel:  arm %8.1f us, cancel %8.1f us, run %8.1f us, %3u bytes per timer, no allocation\n", armUs,
+         cancelUs, runUs, static_cast<unsigned>(sizeof(TimerWheel::Timer)));
+  return verify("wheel", expectations) && wheel.pending() == 0;
+}
+
+bool runObjects() {
+  ObjectTimerService service;
+  std::vector<Expectation> expectations(kTimers);
+  std::vector<Context> contexts(kTimers);
+  std::vector<ObjectTimer *> timers(kTimers);
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < kTimers; i++) {
+    expectations[i] = {delayOf(i), 0, false};
+    contexts[i] = {&expectations[i],
+                   [](void *clock) { return static_cast<ObjectTimerService *>(clock)->now(); }, &service};
+    timers[i] = service.create(onFire, &contexts[i]);
+    service.start(timers[i], delayOf(i));
+  }
+  double armUs = elapsedUs(start);
+  start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < kTimers; i++) {
+    if (cancelled(i)) service.stop(timers[i]);
+  }
+  double cancelUs = elapsedUs(start);
+  start = std::chrono::steady_clock::now();
+  for (uint32_t tick = 0; tick < kMaxDelayTicks; tick++) {
+    service.advance();
+  }
+  double runUs = elapsedUs(start);
+  for (ObjectTimer *timer : timers) {
+    service.destroy(timer);
+  }
+
+  printf("object: arm %8.1f us, cancel %8.1f us, run %8.1f us, %3u bytes per timer, one allocation each\n",
+         armUs, cancelUs, runUs, static_cast<unsigned>(sizeof(ObjectTimer)));
+  return verify("object", expectations);
+}
+
+struct BusyContext {
+  TimerWheel *wheel;
+  TimerWheel::Timer *timer;
+  std::atomic<bool> entered;
+  std::atomic<bool> release;
+  std::atomic<bool> returned;
+};
+
+bool runCancelAndWait() {
+  TimerWheel wheel;
+  HostTickSource ticks(wheel);
+  ticks.start();
+  TimerWheel::Timer timer;
+  BusyContext context{&wheel, &timer, {false}, {false}, {false}};
+
+  // The callback cancels its own timer, which must not wait, then blocks until released
+  wheel.schedule(
+      timer, 1,
+      [](void *self) {
+        BusyContext *busy = static_cast<BusyContext *>(self);
+        busy->wheel->cancelAndWait(*busy->timer);
+        busy->entered.store(true);
+        while (!busy->release.load()) {
+          std::this_thread::yield();
+        }
+        busy->returned.store(true);
+      },
+      &context, 1);
+  std::thread tickThread([&ticks]() { ticks.advanceTicks(1); });
+  while (!context.entered.load()) {
+    std::this_thread::yield();
+  }
+
+  std::atomic<bool> cancelled(false);
+  std::atomic<bool> returnedFirst(false);
+  std::thread owner([&]() {
+    wheel.cancelAndWait(timer);
+    returnedFirst.store(context.returned.load());
+    cancelled.store(true);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  bool waited = !cancelled.load();
+  context.release.store(true);
+  owner.join();
+  tickThread.join();
+
+  bool ok = waited && returnedFirst.load() && wheel.pending() == 0;
+  printf("cancelAndWait: %s\n", ok ? "waited for the running callback" : "returned under the running callback");
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  printf("%u timers, delays up to %u ticks, a quarter cancelled\n", static_cast<unsigned>(kTimers),
+         static_cast<unsigned>(kMaxDelayTicks));
+  bool ok = runWheel();
+  ok = runObjects() && ok;
+  ok = runCancelAndWait() && ok;
+  return ok ? 0 : 1;
+}
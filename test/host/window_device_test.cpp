@@ -0,0 +1,222 @@
+// WindowDevice driven by SimulatedBlindAccessory on a HostTickSource.
+//
+// Covers the reports of a Matter write: while the blind travels to the written target only the
+// current position is reported, and a move started by the accessory itself reports its target.
+// Calibration must learn the simulated motor timing despite its start delay, store it under a key
+// unique to the window and not move for a target closer than the coasting of the blind, which
+// keeps reporting where the blind really is.
+
+#include <fake_esp_matter.hpp>
+#include <simulated_blind_accessory.hpp>
+
+#include <HostTickSource.hpp>
+#include <WindowDevice.hpp>
+#include <WindowProfileStorageInterface.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+namespace Covering = chip::app::Clusters::WindowCovering;
+
+constexpr uint32_t kTravelMs = 10000;
+constexpr uint32_t kOpenMs = 8000;
+constexpr uint32_t kCloseMs = 12000;
+constexpr uint32_t kStartLatencyMs = 300;
+constexpr uint32_t kStopLatencyMs = 480;
+constexpr uint32_t kCalibrationLimitMs = 120000;
+
+// Profile storage in memory, recording every key it was asked for
+class MemoryProfileStorage : public WindowProfileStorageInterface {
+ public:
+  esp_err_t load(const char *key, WindowTravelProfile &profile) override {
+    loadedKeys.push_back(key);
+    for (const Entry &entry : entries) {
+      if (entry.key == key) {
+        profile = entry.profile;
+        return ESP_OK;
+      }
+    }
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  esp_err_t save(const char *key, const WindowTravelProfile &profile) override {
+    savedKeys.push_back(key);
+    for (Entry &entry : entries) {
+      if (entry.key == key) {
+        entry.profile = profile;
+        return ESP_OK;
+      }
+    }
+    entries.push_back(Entry{key, profile});
+    return ESP_OK;
+  }
+
+  std::vector<std::string> loadedKeys;
+  std::vector<std::string> savedKeys;
+
+ private:
+  struct Entry {
+    std::string key;
+    WindowTravelProfile profile;
+  };
+
+  std::vector<Entry> entries;
+};
+
+bool expect(bool condition, const char *what) {
+  if (!condition) printf("FAILED: %s\n", what);
+  return condition;
+}
+
+uint16_t attribute(uint16_t endpointId, uint32_t attributeId) {
+  return fake_esp_matter::read(endpointId, Covering::Id, attributeId).val.u16;
+}
+
+uint32_t reports(uint16_t endpointId, uint32_t attributeId) {
+  return fake_esp_matter::reports(endpointId, Covering::Id, attributeId);
+}
+
+// Write the target as a controller would and let the device follow it
+void writeTarget(WindowDevice &window, uint16_t endpointId, uint16_t percent) {
+  fake_esp_matter::write(endpointId, Covering::Id, Covering::Attributes::TargetPositionLiftPercent100ths::Id,
+                         esp_matter_nullable_uint16(static_cast<uint16_t>(percent * 100)));
+  window.updateAccessory();
+}
+
+bool near(uint32_t value, uint32_t expected, uint32_t tolerance) {
+  return value + tolerance >= expected && value <= expected + tolerance;
+}
+
+bool calibrate(WindowDevice &window, HostTickSource &ticks) {
+  if (window.calibrate() != ESP_OK) return false;
+  for (uint32_t ms = 0; ms < kCalibrationLimitMs && window.isCalibrating(); ms += 100) {
+    ticks.advanceMs(100);
+  }
+  return !window.isCalibrating();
+}
+
+bool testWriteEcho(HostTickSource &ticks) {
+  SimulatedBlindAccessory blind(kTravelMs, kTravelMs);
+  WindowDevice window("window", &blind);
+  uint16_t endpointId = 0;
+  window.getEndpointIds(&endpointId, 1);
+  const uint32_t target = Covering::Attributes::TargetPositionLiftPercent100ths::Id;
+  const uint32_t current = Covering::Attributes::CurrentPositionLiftPercent100ths::Id;
+  bool ok = true;
+
+  uint32_t targetReports = reports(endpointId, target);
+  uint32_t currentReports = reports(endpointId, current);
+  writeTarget(window, endpointId, 50);
+  ticks.advanceMs(kTravelMs);
+  ok = expect(reports(endpointId, target) == targetReports, "written target re-reported during the travel") && ok;
+  ok = expect(reports(endpointId, current) - currentReports >= 49, "travel reported every percent") && ok;
+  ok = expect(attribute(endpointId, current) == 5000 && attribute(endpointId, target) == 5000,
+              "blind arrived at the written target") && ok;
+
+  // A local move after the arrival is news for the stack
+  blind.moveBlindTo(20);
+  ticks.advanceMs(kTravelMs);
+  ok = expect(reports(endpointId, target) > targetReports, "local move reported its target") && ok;
+  ok = expect(attribute(endpointId, target) == 2000 && attribute(endpointId, current) == 2000,
+              "local move reached its target") && ok;
+  return ok;
+}
+
+bool testProfileKeys(esp_matter::endpoint_t *aggregator) {
+  SimulatedBlindAccessory blind;
+  MemoryProfileStorage storage;
+  bool ok = true;
+
+  // The names only differ after the 15 characters an NVS key holds
+  {
+    WindowDevice left("living room window left", &blind, aggregator, &storage);
+    WindowDevice right("living room window right", &blind, aggregator, &storage);
+    WindowDevice first(nullptr, &blind, nullptr, &storage);
+    WindowDevice second(nullptr, &blind, nullptr, &storage);
+  }
+  WindowDevice again("living room window left", &blind, aggregator, &storage);
+  ok = expect(storage.loadedKeys.size() == 5, "every window loaded its profile") && ok;
+  if (!ok) return false;
+  for (size_t i = 0; i < 4; i++) {
+    ok = expect(storage.loadedKeys[i].size() < 16, "key fits in NVS") && ok;
+    for (size_t j = i + 1; j < 4; j++) {
+      ok = expect(storage.loadedKeys[i] != storage.loadedKeys[j], "windows share a profile key") && ok;
+    }
+  }
+  ok = expect(storage.loadedKeys[4] == storage.loadedKeys[0], "a named window keeps its key on a new endpoint") && ok;
+  return ok;
+}
+
+bool testCalibration(HostTickSource &ticks, esp_matter::endpoint_t *aggregator) {
+  SimulatedBlindAccessory blind(kOpenMs, kCloseMs, kStartLatencyMs, kStopLatencyMs);
+  MemoryProfileStorage storage;
+  WindowDevice window("bedroom window", &blind, aggregator, &storage);
+  uint16_t endpointId = 0;
+  window.getEndpointIds(&endpointId, 1);
+  const uint32_t target = Covering::Attributes::TargetPositionLiftPercent100ths::Id;
+  const uint32_t current = Covering::Attributes::CurrentPositionLiftPercent100ths::Id;
+  bool ok = true;
+
+  ok = expect(calibrate(window, ticks), "calibration finished") && ok;
+  WindowTravelProfile profile = window.getTravelProfile();
+  printf("calibrated: open %u ms, close %u ms, stop %u ms\n", static_cast<unsigned>(profile.openMs),
+         static_cast<unsigned>(profile.closeMs), static_cast<unsigned>(profile.stopLatencyMs));
+  ok = expect(near(profile.openMs, kOpenMs, kOpenMs / 50), "open time learned") && ok;
+  ok = expect(near(profile.closeMs, kCloseMs, kCloseMs / 50), "close time learned") && ok;
+  ok = expect(near(profile.stopLatencyMs, kStopLatencyMs, kCloseMs / 100), "stop latency learned") && ok;
+  ok = expect(storage.savedKeys.size() == 1 && storage.savedKeys[0] == storage.loadedKeys[0],
+              "profile saved under the key it is loaded from") && ok;
+
+  // The learned profile is loaded by a window of the same name
+  {
+    SimulatedBlindAccessory otherBlind;
+    WindowDevice reloaded("bedroom window", &otherBlind, aggregator, &storage);
+    WindowTravelProfile loaded = reloaded.getTravelProfile();
+    ok = expect(loaded.openMs == profile.openMs && loaded.stopLatencyMs == profile.stopLatencyMs,
+                "stored profile loaded") && ok;
+  }
+
+  writeTarget(window, endpointId, 50);
+  ticks.advanceMs(kCloseMs);
+  uint16_t position = blind.getCurrentPosition();
+  ok = expect(attribute(endpointId, current) == position * 100, "compensated move reported its stop") && ok;
+
+  // One percent further is less than the blind coasts, the blind stays where it is
+  uint32_t moves = blind.moveCount();
+  uint16_t closer = static_cast<uint16_t>(position + 1);
+  writeTarget(window, endpointId, closer);
+  ticks.advanceMs(kCloseMs);
+  ok = expect(blind.moveCount() == moves, "blind not moved for a target within its coasting") && ok;
+  ok = expect(attribute(endpointId, current) == position * 100 && attribute(endpointId, target) == closer * 100,
+              "target within the coasting keeps the real position and the requested target") && ok;
+  ok = expect(window.getState().currentPosition == position && window.getState().targetPosition == closer,
+              "shadow keeps the real position and the requested target") && ok;
+
+  // A local move afterwards is reported as it is
+  blind.moveBlindTo(20);
+  ticks.advanceMs(kOpenMs);
+  ok = expect(attribute(endpointId, current) == blind.getCurrentPosition() * 100 &&
+                  attribute(endpointId, target) == 2000,
+              "local move after a settled target reported") && ok;
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  esp_matter::endpoint::bridged_node::config_t config;
+  esp_matter::endpoint_t *aggregator =
+      esp_matter::endpoint::bridged_node::create(esp_matter::node::get(), &config, 0, nullptr);
+  HostTickSource ticks;
+  ticks.start();
+  bool ok = testWriteEcho(ticks);
+  ok = testProfileKeys(aggregator) && ok;
+  ok = testCalibration(ticks, aggregator) && ok;
+  ticks.stop();
+  printf("%s\n", ok ? "window device tests passed" : "window device tests failed");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Decode a state stream (see include/StateStream.hpp) captured from the device.
+
+The input is the raw sequence of 16 byte records as read from the StateStreamRing, e.g. a
+UART dump. Every decoded change is printed as one line. Deltas received before the first
+absolute value of their key, after attaching late or losing records, are skipped until the
+encoder sends the key absolute again.
+
+    decode_state_stream.py capture.bin
+"""
+
+import argparse
+import sys
+
+RECORD_SIZE = 16
+ABSOLUTE_FLAG = 0x80
+
+KINDS = {
+    1: "power",
+    2: "fan_percent",
+    3: "window_current_position",
+    4: "window_target_position",
+    5: "button_press",
+    6: "level",
+    7: "sensor_value",
+}
+
+
+def read_varint(record, offset, end):
+    value = 0
+    for shift in range(0, 35, 7):
+        if offset >= end:
+            raise ValueError("truncated varint")
+        byte = record[offset]
+        offset += 1
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return value & 0xFFFFFFFF, offset
+    raise ValueError("varint too long")
+
+
+def zigzag_decode(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def to_int32(value):
+    value &= 0xFFFFFFFF
+    return value - (1 << 32) if value & 0x80000000 else value
+
+
+class Decoder:
+    def __init__(self):
+        self.sequence = 0
+        self.last_value = {}
+
+    def decode(self, record):
+        """Return (sequence, missed, endpoint_id, kind, value), or None for a delta without a base."""
+        end = record[0] + 1
+        if end < 2 or end > RECORD_SIZE:
+            raise ValueError("bad record length")
+        absolute = bool(record[1] & ABSOLUTE_FLAG)
+        kind = record[1] & ~ABSOLUTE_FLAG
+        sequence_delta, offset = read_varint(record, 2, end)
+        endpoint_id, offset = read_varint(record, offset, end)
+        encoded, offset = read_varint(record, offset, end)
+        if sequence_delta == 0 or endpoint_id > 0xFFFF:
+            raise ValueError("bad record")
+
+        self.sequence = (self.sequence + sequence_delta) & 0xFFFFFFFF
+        key = (endpoint_id, kind)
+        value = zigzag_decode(encoded)
+        if not absolute:
+            if key not in self.last_value:
+                return None
+            value = to_int32(self.last_value[key] + value)
+        self.last_value[key] = value
+        return self.sequence, sequence_delta - 1, endpoint_id, kind, value
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="captured records, - for stdin")
+    args = parser.parse_args()
+
+    stream = sys.stdin.buffer if args.input == "-" else open(args.input, "rb")
+    decoder = Decoder()
+    with stream:
+        while True:
+            record = stream.read(RECORD_SIZE)
+            if len(record) < RECORD_SIZE:
+                break
+            try:
+                decoded = decoder.decode(record)
+            except ValueError as error:
+                print("malformed record: %s" % error, file=sys.stderr)
+                continue
+            if decoded is None:
+                continue
+            sequence, missed, endpoint_id, kind, value = decoded
+            if missed:
+                print("# %d records dropped" % missed)
+            print("%d endpoint=%d %s=%d" % (sequence, endpoint_id, KINDS.get(kind, "kind_%d" % kind), value))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""Build a binary device manifest (see include/DeviceManifest.hpp) from a JSON description.
+
+Example input:
+
+    {
+      "devices": [
+        {"type": "light", "name": "Kitchen", "accessory": 0, "bridged": true},
+        {"type": "multi_channel", "name": "Relays", "accessory": 1, "bridged": true,
+         "channel_type": "light"}
+      ]
+    }
+
+Write the output to a data partition, e.g.:
+
+    parttool.py write_partition --partition-name=devices --input devices.bin
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = 0x4D44484D
+VERSION = 1
+NO_NAME = 0xFFFFFFFF
+FLAG_BRIDGED = 0x01
+
+HEADER = struct.Struct("<IHHIIII")
+ENTRY = struct.Struct("<BBHII")
+
+# Values of DeviceType in include/DeviceSnapshot.hpp
+DEVICE_TYPES = {
+    "light": 1,
+    "plug_in": 2,
+    "fan": 3,
+    "window": 4,
+    "button": 5,
+    "dimmable_light": 6,
+    "multi_channel": 7,
+    "temperature_sensor": 8,
+    "humidity_sensor": 9,
+    "occupancy_sensor": 10,
+}
+
+# Values of MultiChannelDevice::ChannelType
+CHANNEL_TYPES = {"plug_in": 0, "light": 1}
+
+
+def build(description):
+    devices = description.get("devices", [])
+    if len(devices) > 0xFFFF:
+        raise ValueError("too many devices")
+
+    strings = bytearray()
+    offsets = {}
+    entries = bytearray()
+    for index, device in enumerate(devices):
+        kind = device.get("type")
+        if kind not in DEVICE_TYPES:
+            raise ValueError("device %d: unknown type %r" % (index, kind))
+
+        name = device.get("name")
+        name_offset = NO_NAME
+        if name:
+            encoded = name.encode("utf-8")
+            if len(encoded) >= 64 or b"\0" in encoded:
+                raise ValueError("device %d: name must be shorter than 64 bytes" % index)
+            # Identical names share one copy
+            if encoded not in offsets:
+                offsets[encoded] = len(strings)
+                strings += encoded + b"\0"
+            name_offset = offsets[encoded]
+
+        accessory = int(device.get("accessory", index))
+        if not 0 <= accessory <= 0xFFFF:
+            raise ValueError("device %d: accessory id out of range" % index)
+
+        flags = FLAG_BRIDGED if device.get("bridged", True) else 0
+        option = 0
+        if kind == "multi_channel":
+            option = CHANNEL_TYPES[device.get("channel_type", "plug_in")]
+
+        entries += ENTRY.pack(DEVICE_TYPES[kind], flags, accessory, name_offset, option)
+
+    entries_offset = HEADER.size
+    strings_offset = entries_offset + len(entries)
+    total_size = strings_offset + len(strings)
+    header = HEADER.pack(MAGIC, VERSION, len(devices), entries_offset, strings_offset, len(strings), total_size)
+    return header + entries + strings
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="JSON device description")
+    parser.add_argument("output", help="binary manifest to write")
+    args = parser.parse_args()
+
+    with open(args.input, "r", encoding="utf-8") as source:
+        description = json.load(source)
+    try:
+        blob = build(description)
+    except (ValueError, KeyError) as error:
+        sys.exit("make_device_manifest: %s" % error)
+
+    with open(args.output, "wb") as target:
+        target.write(blob)
+    print("%s: %d devices, %d bytes" % (args.output, len(description.get("devices", [])), len(blob)))
+
+
+if __name__ == "__main__":
+    main()